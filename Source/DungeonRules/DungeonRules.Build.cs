@@ -16,5 +16,9 @@ public class DungeonRules : ModuleRules
 		
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "ProceduralDungeon" });
 		PrivateDependencyModuleNames.AddRange(new string[] { "CoreUObject", "Engine" });
+
+		// The dispatch benchmark creates a Blueprint condition in editor.
+		if (Target.bBuildEditor)
+			PrivateDependencyModuleNames.AddRange(new string[] { "UnrealEd", "BlueprintGraph" });
 	}
 }
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonAliasTable.h"
+#include "Math/RandomStream.h"
+
+void FDungeonAliasTable::Build(TArrayView<const int32> Weights)
+{
+	Reset();
+
+	int64 TotalWeight = 0;
+	for (const int32 Weight : Weights)
+	{
+		TotalWeight += FMath::Max(Weight, 0);
+	}
+
+	if (TotalWeight <= 0)
+		return;
+
+	const int32 Count = Weights.Num();
+	Probabilities.SetNumUninitialized(Count);
+	Aliases.SetNumUninitialized(Count);
+
+	// Weights scaled so that their average is 1.
+	TArray<double> Scaled;
+	TArray<int32> Small;
+	TArray<int32> Large;
+	Scaled.SetNumUninitialized(Count);
+	Small.Reserve(Count);
+	Large.Reserve(Count);
+
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		Scaled[Index] = static_cast<double>(FMath::Max(Weights[Index], 0)) * Count / TotalWeight;
+		(Scaled[Index] < 1.0 ? Small : Large).Add(Index);
+	}
+
+	// Each small column is filled up with a part of a large one.
+	while (Small.Num() > 0 && Large.Num() > 0)
+	{
+		const int32 Less = Small.Pop(/*bAllowShrinking = */false);
+		const int32 More = Large.Pop(/*bAllowShrinking = */false);
+
+		Probabilities[Less] = static_cast<float>(Scaled[Less]);
+		Aliases[Less] = More;
+
+		Scaled[More] = (Scaled[More] + Scaled[Less]) - 1.0;
+		(Scaled[More] < 1.0 ? Small : Large).Add(More);
+	}
+
+	// Remaining columns are full (the small ones are only due to rounding errors).
+	for (const int32 Index : Large)
+	{
+		Probabilities[Index] = 1.0f;
+		Aliases[Index] = Index;
+	}
+
+	for (const int32 Index : Small)
+	{
+		Probabilities[Index] = 1.0f;
+		Aliases[Index] = Index;
+	}
+}
+
+void FDungeonAliasTable::Reset()
+{
+	Probabilities.Reset();
+	Aliases.Reset();
+}
+
+int32 FDungeonAliasTable::Sample(const FRandomStream& Random) const
+{
+	if (IsEmpty())
+		return INDEX_NONE;
+
+	const int32 Column = Random.RandHelper(Probabilities.Num());
+	return (Random.GetFraction() < Probabilities[Column]) ? Column : Aliases[Column];
+}
@@ -0,0 +1,198 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonConditionBytecode.h"
+#include "DungeonConditionExpression.h"
+#include "DungeonRoomHistogram.h"
+#include "RuleTransitionCondition.h"
+#include "DungeonRulesSerialization.h"
+#include "DungeonRulesEvaluationContext.h"
+
+void FDungeonConditionBytecode::Reset()
+{
+	Instructions.Reset();
+	Calls.Reset();
+}
+
+void FDungeonConditionBytecode::Serialize(FArchive& Ar)
+{
+	Ar << Instructions;
+	DungeonRulesSerialization::SerializeObjects(Ar, Calls);
+}
+
+FDungeonConditionBytecode::FRange FDungeonConditionBytecode::Compile(const URuleTransitionCondition* Condition, const FDungeonRulesProgram& Program, bool bSimplify)
+{
+	FDungeonConditionExpression Expression;
+	int32 Root = Expression.AddCondition(Condition, Program);
+	if (bSimplify)
+		Root = Expression.Simplify(Root);
+
+	return Compile(Expression, Root);
+}
+
+FDungeonConditionBytecode::FRange FDungeonConditionBytecode::Compile(const FDungeonConditionExpression& Expression, int32 Root)
+{
+	FRange Range;
+	Range.First = Instructions.Num();
+	EmitNode(Expression, Root);
+	Range.Num = Instructions.Num() - Range.First;
+	return Range;
+}
+
+void FDungeonConditionBytecode::EmitNode(const FDungeonConditionExpression& Expression, int32 NodeIndex)
+{
+	const FDungeonConditionExpression::FNode& Node = Expression.GetNode(NodeIndex);
+	switch (Node.Type)
+	{
+	case EDungeonConditionNodeType::Constant:
+		Emit(EDungeonConditionOpCode::Constant, Node.Value);
+		break;
+	case EDungeonConditionNodeType::Call:
+		EmitCall(Node.Object);
+		break;
+	case EDungeonConditionNodeType::CountTotal:
+		Emit(EDungeonConditionOpCode::CountTotal, 0, Node.Value, Node.Comparison);
+		break;
+	case EDungeonConditionNodeType::CountBucket:
+		Emit(EDungeonConditionOpCode::CountBucket, Node.Operand, Node.Value, Node.Comparison);
+		break;
+	case EDungeonConditionNodeType::Not:
+		EmitNode(Expression, Node.Children[0]);
+		Emit(EDungeonConditionOpCode::Not);
+		break;
+	case EDungeonConditionNodeType::And:
+	case EDungeonConditionNodeType::Or:
+	{
+		// Same as UDRT_LogicalOperator: passes when there is no child.
+		if (Node.Children.Num() <= 0)
+		{
+			Emit(EDungeonConditionOpCode::Constant, 1);
+			break;
+		}
+
+		// Each child but the last one exits early when its result decides the group's one.
+		const EDungeonConditionOpCode ExitJump = (Node.Type == EDungeonConditionNodeType::And) ? EDungeonConditionOpCode::JumpIfFalse : EDungeonConditionOpCode::JumpIfTrue;
+		TArray<int32, TInlineAllocator<8>> Jumps;
+		for (int32 i = 0; i < Node.Children.Num(); ++i)
+		{
+			EmitNode(Expression, Node.Children[i]);
+			if (i < Node.Children.Num() - 1)
+				Jumps.Add(Emit(ExitJump));
+		}
+
+		for (const int32 Jump : Jumps)
+		{
+			PatchJump(Jump);
+		}
+		break;
+	}
+	default:
+		checkNoEntry();
+	}
+}
+
+int32 FDungeonConditionBytecode::Emit(EDungeonConditionOpCode OpCode, int32 Operand, int32 Value, EComparisonOp Comparison)
+{
+	FDungeonConditionInstruction& Instruction = Instructions.AddDefaulted_GetRef();
+	Instruction.OpCode = OpCode;
+	Instruction.Comparison = Comparison;
+	Instruction.Operand = Operand;
+	Instruction.Value = Value;
+	return Instructions.Num() - 1;
+}
+
+int32 FDungeonConditionBytecode::EmitCall(const URuleTransitionCondition* Condition)
+{
+	check(Condition);
+	return Emit(EDungeonConditionOpCode::Call, Calls.AddUnique(Condition));
+}
+
+void FDungeonConditionBytecode::PatchJump(int32 JumpIndex)
+{
+	FDungeonConditionInstruction& Jump = Instructions[JumpIndex];
+	check(Jump.OpCode == EDungeonConditionOpCode::JumpIfFalse || Jump.OpCode == EDungeonConditionOpCode::JumpIfTrue);
+	Jump.Operand = Instructions.Num();
+}
+
+bool FDungeonConditionBytecode::Evaluate(const FRange& Range, const FDungeonRulesEvaluationContext& Context) const
+{
+	check(Context.Histogram);
+	const FDungeonRoomHistogram& Histogram = *Context.Histogram;
+
+	bool Result = false;
+	int32 Index = Range.First;
+	const int32 End = Range.First + Range.Num;
+	while (Index < End)
+	{
+		const FDungeonConditionInstruction& Instruction = Instructions[Index++];
+		switch (Instruction.OpCode)
+		{
+		case EDungeonConditionOpCode::Constant:
+			Result = (Instruction.Operand != 0);
+			break;
+		case EDungeonConditionOpCode::Call:
+			Result = Calls[Instruction.Operand]->DispatchCheck(Context);
+			break;
+		case EDungeonConditionOpCode::CountTotal:
+			Result = FComparisonHelper::Check(Histogram.GetTotal(), Instruction.Value, Instruction.Comparison);
+			break;
+		case EDungeonConditionOpCode::CountBucket:
+			Result = FComparisonHelper::Check(Histogram.GetBucketCount(Instruction.Operand), Instruction.Value, Instruction.Comparison);
+			break;
+		case EDungeonConditionOpCode::Not:
+			Result = !Result;
+			break;
+		case EDungeonConditionOpCode::JumpIfFalse:
+			if (!Result)
+				Index = Instruction.Operand;
+			break;
+		case EDungeonConditionOpCode::JumpIfTrue:
+			if (Result)
+				Index = Instruction.Operand;
+			break;
+		default:
+			checkNoEntry();
+		}
+	}
+	return Result;
+}
+
+FString FDungeonConditionBytecode::ToString(const FRange& Range) const
+{
+	FString Result;
+	for (int32 Index = Range.First; Index < Range.First + Range.Num; ++Index)
+	{
+		const FDungeonConditionInstruction& Instruction = Instructions[Index];
+		FString Line;
+		switch (Instruction.OpCode)
+		{
+		case EDungeonConditionOpCode::Constant:
+			Line = (Instruction.Operand != 0) ? TEXT("CONST true") : TEXT("CONST false");
+			break;
+		case EDungeonConditionOpCode::Call:
+			Line = FString::Printf(TEXT("CALL %s"), *GetNameSafe(Calls[Instruction.Operand]));
+			break;
+		case EDungeonConditionOpCode::CountTotal:
+			Line = FString::Printf(TEXT("COUNT total %s"), *FComparisonHelper::GetComparisonText(Instruction.Comparison, Instruction.Value).ToString());
+			break;
+		case EDungeonConditionOpCode::CountBucket:
+			Line = FString::Printf(TEXT("COUNT bucket #%d %s"), Instruction.Operand, *FComparisonHelper::GetComparisonText(Instruction.Comparison, Instruction.Value).ToString());
+			break;
+		case EDungeonConditionOpCode::Not:
+			Line = TEXT("NOT");
+			break;
+		case EDungeonConditionOpCode::JumpIfFalse:
+			Line = FString::Printf(TEXT("JUMP_IF_FALSE %d"), Instruction.Operand);
+			break;
+		case EDungeonConditionOpCode::JumpIfTrue:
+			Line = FString::Printf(TEXT("JUMP_IF_TRUE %d"), Instruction.Operand);
+			break;
+		default:
+			checkNoEntry();
+		}
+		Result += FString::Printf(TEXT("%4d: %s\n"), Index, *Line);
+	}
+	return Result;
+}
@@ -0,0 +1,200 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonConditionExpression.h"
+#include "RuleTransitionCondition.h"
+
+void FDungeonConditionExpression::Reset()
+{
+	Nodes.Reset();
+}
+
+int32 FDungeonConditionExpression::AddCondition(const URuleTransitionCondition* Condition, const FDungeonRulesProgram& Program)
+{
+	if (!Condition)
+		return AddConstant(false);
+
+	// The native implementation of a condition overridden in Blueprint is not used.
+	if (Condition->HasBlueprintCheck())
+		return AddCall(Condition);
+
+	return Condition->BuildExpression(*this, Program);
+}
+
+int32 FDungeonConditionExpression::AddConstant(bool bValue)
+{
+	const int32 Index = AddNode(EDungeonConditionNodeType::Constant);
+	Nodes[Index].Value = bValue ? 1 : 0;
+	return Index;
+}
+
+int32 FDungeonConditionExpression::AddCall(const URuleTransitionCondition* Condition)
+{
+	check(Condition);
+	const int32 Index = AddNode(EDungeonConditionNodeType::Call);
+	Nodes[Index].Object = Condition;
+	return Index;
+}
+
+int32 FDungeonConditionExpression::AddCount(int32 Bucket, int32 Value, EComparisonOp Comparison)
+{
+	const int32 Index = AddNode((Bucket == INDEX_NONE) ? EDungeonConditionNodeType::CountTotal : EDungeonConditionNodeType::CountBucket);
+	FNode& Node = Nodes[Index];
+	Node.Operand = Bucket;
+	Node.Value = Value;
+	Node.Comparison = Comparison;
+	return Index;
+}
+
+int32 FDungeonConditionExpression::AddNot(int32 Child)
+{
+	const int32 Index = AddNode(EDungeonConditionNodeType::Not);
+	Nodes[Index].Children.Add(Child);
+	return Index;
+}
+
+int32 FDungeonConditionExpression::AddGroup(EDungeonConditionNodeType Type, TArray<int32>&& Children)
+{
+	check(Type == EDungeonConditionNodeType::And || Type == EDungeonConditionNodeType::Or);
+	const int32 Index = AddNode(Type);
+	Nodes[Index].Children = MoveTemp(Children);
+	return Index;
+}
+
+int32 FDungeonConditionExpression::Simplify(int32 Root)
+{
+	switch (Nodes[Root].Type)
+	{
+	case EDungeonConditionNodeType::Not:
+	{
+		const int32 Child = Simplify(Nodes[Root].Children[0]);
+		const FNode& ChildNode = Nodes[Child];
+
+		// NOT(constant)
+		if (ChildNode.Type == EDungeonConditionNodeType::Constant)
+			return AddConstant(ChildNode.Value == 0);
+
+		// NOT(NOT(X)) == X
+		if (ChildNode.Type == EDungeonConditionNodeType::Not)
+			return ChildNode.Children[0];
+
+		Nodes[Root].Children[0] = Child;
+		return Root;
+	}
+	case EDungeonConditionNodeType::And:
+	case EDungeonConditionNodeType::Or:
+		return SimplifyGroup(Root);
+	default:
+		return Root;
+	}
+}
+
+int32 FDungeonConditionExpression::AddNode(EDungeonConditionNodeType Type)
+{
+	FNode& Node = Nodes.AddDefaulted_GetRef();
+	Node.Type = Type;
+	return Nodes.Num() - 1;
+}
+
+int32 FDungeonConditionExpression::SimplifyGroup(int32 Index)
+{
+	const EDungeonConditionNodeType Type = Nodes[Index].Type;
+	const bool bIsAnd = (Type == EDungeonConditionNodeType::And);
+
+	// An empty group passes, whatever its type.
+	if (Nodes[Index].Children.Num() <= 0)
+		return AddConstant(true);
+
+	// The value deciding the group result alone (false for AND, true for OR).
+	// The other value has no effect on the group result.
+	const bool bAbsorbing = !bIsAnd;
+
+	TArray<int32> Children;
+	const TArray<int32> OldChildren = Nodes[Index].Children;
+	for (const int32 OldChild : OldChildren)
+	{
+		const int32 Child = Simplify(OldChild);
+
+		// The children after an absorbing constant are never checked,
+		// but the calls before it are, so the group is a constant only when there is none.
+		if (IsConstant(Child, bAbsorbing))
+		{
+			if (!Children.ContainsByPredicate([this](int32 Previous) { return HasCall(Previous); }))
+				return AddConstant(bAbsorbing);
+
+			Children.Add(Child);
+			break;
+		}
+
+		if (IsConstant(Child, !bAbsorbing))
+			continue;
+
+		// (A AND B) AND C == A AND B AND C
+		// Simplified children of the same type are never empty (they would be a constant).
+		if (Nodes[Child].Type == Type)
+		{
+			Children.Append(Nodes[Child].Children);
+			continue;
+		}
+
+		Children.Add(Child);
+	}
+
+	// Room counts are checked in order and have no side effects, so only the first occurrence has an effect.
+	for (int32 i = Children.Num() - 1; i > 0; --i)
+	{
+		for (int32 j = 0; j < i; ++j)
+		{
+			if (IsSameLeaf(Children[i], Children[j]))
+			{
+				Children.RemoveAt(i);
+				break;
+			}
+		}
+	}
+
+	// All the children were neutral constants.
+	// This is not the same as an empty group (e.g. an OR of false conditions is false).
+	if (Children.Num() <= 0)
+		return AddConstant(!bAbsorbing);
+
+	if (Children.Num() == 1)
+		return Children[0];
+
+	Nodes[Index].Children = MoveTemp(Children);
+	return Index;
+}
+
+bool FDungeonConditionExpression::IsConstant(int32 Index, bool bValue) const
+{
+	const FNode& Node = Nodes[Index];
+	return Node.Type == EDungeonConditionNodeType::Constant && (Node.Value != 0) == bValue;
+}
+
+bool FDungeonConditionExpression::IsSameLeaf(int32 A, int32 B) const
+{
+	const FNode& NodeA = Nodes[A];
+	const FNode& NodeB = Nodes[B];
+	if (NodeA.Type != NodeB.Type)
+		return false;
+
+	// A call is never the same leaf as another one: each call of a condition is checked.
+	switch (NodeA.Type)
+	{
+	case EDungeonConditionNodeType::CountTotal:
+	case EDungeonConditionNodeType::CountBucket:
+		return NodeA.Operand == NodeB.Operand && NodeA.Value == NodeB.Value && NodeA.Comparison == NodeB.Comparison;
+	default:
+		return false;
+	}
+}
+
+bool FDungeonConditionExpression::HasCall(int32 Index) const
+{
+	const FNode& Node = Nodes[Index];
+	if (Node.Type == EDungeonConditionNodeType::Call)
+		return true;
+	return Node.Children.ContainsByPredicate([this](int32 Child) { return HasCall(Child); });
+}
@@ -4,6 +4,71 @@
 // (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "DungeonEventReceiver.h"
+#include "DungeonRulesDispatch.h"
+#include "ProceduralDungeonTypes.h"
+
+#define FIND_BLUEPRINT_EVENT(EVENT_NAME) \
+	Blueprint##EVENT_NAME = FDungeonRulesDispatch::FindBlueprintEvent(GetClass(), GET_FUNCTION_NAME_CHECKED(UDungeonEventReceiver, EVENT_NAME));
+
+void UDungeonEventReceiver::PostInitProperties()
+{
+	Super::PostInitProperties();
+	FIND_BLUEPRINT_EVENT(OnPreGeneration);
+	FIND_BLUEPRINT_EVENT(OnPostGeneration);
+	FIND_BLUEPRINT_EVENT(OnGenerationInit);
+	FIND_BLUEPRINT_EVENT(OnGenerationFailed);
+	FIND_BLUEPRINT_EVENT(OnRoomAdded);
+	FIND_BLUEPRINT_EVENT(OnFailedToAddRoom);
+	FIND_BLUEPRINT_EVENT(OnRoomsAdded);
+}
+
+#undef FIND_BLUEPRINT_EVENT
+
+bool UDungeonEventReceiver::IsSubscribedTo(EDungeonEvent Event) const
+{
+	const FDungeonRulesEvent* BlueprintEvent = nullptr;
+	switch (Event)
+	{
+	case EDungeonEvent::OnPreGeneration:
+		BlueprintEvent = BlueprintOnPreGeneration.Get();
+		break;
+	case EDungeonEvent::OnPostGeneration:
+		BlueprintEvent = BlueprintOnPostGeneration.Get();
+		break;
+	case EDungeonEvent::OnGenerationInit:
+		BlueprintEvent = BlueprintOnGenerationInit.Get();
+		break;
+	case EDungeonEvent::OnGenerationFailed:
+		BlueprintEvent = BlueprintOnGenerationFailed.Get();
+		break;
+	case EDungeonEvent::OnRoomAdded:
+		if (bBatchRoomAdded)
+			return false;
+		BlueprintEvent = BlueprintOnRoomAdded.Get();
+		break;
+	case EDungeonEvent::OnFailedToAddRoom:
+		BlueprintEvent = BlueprintOnFailedToAddRoom.Get();
+		break;
+	case EDungeonEvent::OnRoomsAdded:
+		if (!bBatchRoomAdded)
+			return false;
+		BlueprintEvent = BlueprintOnRoomsAdded.Get();
+		break;
+	default:
+		checkNoEntry();
+	}
+
+	if (BlueprintEvent)
+		return true;
+
+	// The nearest C++ class tells which events it implements.
+	const UClass* NativeClass = GetClass();
+	while (NativeClass && !NativeClass->HasAnyClassFlags(CLASS_Native))
+	{
+		NativeClass = NativeClass->GetSuperClass();
+	}
+	return NativeClass != UDungeonEventReceiver::StaticClass() && HasNativeEvent(Event);
+}
 
 void UDungeonEventReceiver::OnPreGeneration_Implementation(ADungeonGenerator* Generator)
 {
@@ -28,3 +93,60 @@ void UDungeonEventReceiver::OnRoomAdded_Implementation(ADungeonGenerator* Genera
 void UDungeonEventReceiver::OnFailedToAddRoom_Implementation(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor)
 {
 }
+
+void UDungeonEventReceiver::OnRoomsAdded_Implementation(ADungeonGenerator* Generator, const TArray<TScriptInterface<IReadOnlyRoom>>& NewRooms)
+{
+}
+
+#define DISPATCH_DUNGEON_EVENT(EVENT_NAME, ...) \
+	if (!FDungeonRulesDispatch::IsNativeDispatchEnabled()) \
+	{ \
+		EVENT_NAME(__VA_ARGS__); \
+	} \
+	else if (!Blueprint##EVENT_NAME) \
+	{ \
+		EVENT_NAME##_Implementation(__VA_ARGS__); \
+	} \
+	else \
+	{ \
+		FDungeonRulesEventParams Params(*Blueprint##EVENT_NAME); \
+		Params.Set(__VA_ARGS__); \
+		Params.Call(this); \
+	}
+
+void UDungeonEventReceiver::DispatchOnPreGeneration(ADungeonGenerator* Generator)
+{
+	DISPATCH_DUNGEON_EVENT(OnPreGeneration, Generator);
+}
+
+void UDungeonEventReceiver::DispatchOnPostGeneration(ADungeonGenerator* Generator)
+{
+	DISPATCH_DUNGEON_EVENT(OnPostGeneration, Generator);
+}
+
+void UDungeonEventReceiver::DispatchOnGenerationInit(ADungeonGenerator* Generator)
+{
+	DISPATCH_DUNGEON_EVENT(OnGenerationInit, Generator);
+}
+
+void UDungeonEventReceiver::DispatchOnGenerationFailed(ADungeonGenerator* Generator)
+{
+	DISPATCH_DUNGEON_EVENT(OnGenerationFailed, Generator);
+}
+
+void UDungeonEventReceiver::DispatchOnRoomAdded(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom)
+{
+	DISPATCH_DUNGEON_EVENT(OnRoomAdded, Generator, NewRoom);
+}
+
+void UDungeonEventReceiver::DispatchOnFailedToAddRoom(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor)
+{
+	DISPATCH_DUNGEON_EVENT(OnFailedToAddRoom, Generator, FromRoom, FromDoor);
+}
+
+void UDungeonEventReceiver::DispatchOnRoomsAdded(ADungeonGenerator* Generator, const TArray<TScriptInterface<IReadOnlyRoom>>& NewRooms)
+{
+	DISPATCH_DUNGEON_EVENT(OnRoomsAdded, Generator, NewRooms);
+}
+
+#undef DISPATCH_DUNGEON_EVENT
@@ -5,7 +5,23 @@
 
 #include "DungeonGeneratorWithRules.h"
 #include "DungeonRules.h"
+#include "DungeonValidator.h"
 #include "DungeonRulesLog.h"
+#include "EngineUtils.h" // TActorIterator
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+
+namespace
+{
+	// Advances the stream as the room chooser or the conditions of a replayed choice did in the plan.
+	void SkipRandomDraws(const FRandomStream& Random, int32 NumDraws)
+	{
+		for (int32 i = 0; i < NumDraws; ++i)
+		{
+			Random.GetUnsignedInt();
+		}
+	}
+}
 
 #define CHECK_RULES(RETURN_VALUE) \
 if (!DungeonRules) \
@@ -18,13 +34,19 @@ URoomData* ADungeonGeneratorWithRules::ChooseFirstRoomData_Implementation()
 {
 	CHECK_RULES(nullptr);
 
-	if (!CurrentRule)
+	if (RulesState.CurrentRule == INDEX_NONE)
 	{
 		RulesLog_Error("Invalid Dungeon Rule in '%s'", *GetNameSafe(this));
 		return nullptr;
 	}
 
-	URoomData* FirstRoom = DungeonRules->GetFirstRoomData(this, CurrentRule);
+	URoomData* ReplayedRoom = nullptr;
+	int ReplayedDoor = INDEX_NONE;
+	if (ReplayChoice(nullptr, nullptr, ReplayedRoom, ReplayedDoor))
+		return ReplayedRoom;
+
+	const FDungeonRulesEvaluationContext Context = RulesState.MakeContext(this, nullptr, &GetRandomStream());
+	URoomData* FirstRoom = DungeonRules->GetFirstRoomData(Context, RulesState.CurrentRule);
 	return FirstRoom;
 }
 
@@ -32,14 +54,19 @@ URoomData* ADungeonGeneratorWithRules::ChooseNextRoomData_Implementation(const U
 {
 	CHECK_RULES(nullptr);
 
-	if (!CurrentRule)
+	if (RulesState.CurrentRule == INDEX_NONE)
 	{
 		RulesLog_Error("Invalid Dungeon Rule in '%s'", *GetNameSafe(this));
 		return nullptr;
 	}
 
 	DoorIndex = -1;
-	URoomData* NextRoom = DungeonRules->GetNextRoomData(this, CurrentRule, CurrentRoomInstance, DoorData, DoorIndex);
+	URoomData* ReplayedRoom = nullptr;
+	if (ReplayChoice(CurrentRoomInstance, &DoorData, ReplayedRoom, DoorIndex))
+		return ReplayedRoom;
+
+	const FDungeonRulesEvaluationContext Context = RulesState.MakeContext(this, CurrentRoomInstance, &GetRandomStream());
+	URoomData* NextRoom = DungeonRules->GetNextRoomData(Context, RulesState.CurrentRule, DoorData, DoorIndex);
 	return NextRoom;
 }
 
@@ -50,13 +77,15 @@ URoomData* ADungeonGeneratorWithRules::ChooseNextRoomData_Implementation(const U
 bool ADungeonGeneratorWithRules::IsValidDungeon_Implementation()
 {
 	CHECK_RULES(false);
-	return DungeonRules->IsDungeonValid(this);
+	if (RulesState.AbortingValidator)
+		return false;
+	return DungeonRules->IsDungeonValid(this, RulesState);
 }
 
 bool ADungeonGeneratorWithRules::ContinueToAddRoom_Implementation()
 {
 	CHECK_RULES(false);
-	return CurrentRule != nullptr;
+	return RulesState.CurrentRule != INDEX_NONE && !RulesState.AbortingValidator;
 }
 
 void ADungeonGeneratorWithRules::InitializeDungeon_Implementation(const UDungeonGraph* Rooms)
@@ -68,20 +97,45 @@ void ADungeonGeneratorWithRules::InitializeDungeon_Implementation(const UDungeon
 void ADungeonGeneratorWithRules::OnPreGeneration_Implementation()
 {
 	CHECK_RULES();
+	RulesState.Tracer.Configure();
 	DungeonRules->OnPreGeneration(this);
+	DungeonRules->MergeValidatorOrder(RulesState);
 }
 
 void ADungeonGeneratorWithRules::OnPostGeneration_Implementation()
 {
 	CHECK_RULES();
-	DungeonRules->OnPostGeneration(this);
+	if (RulesState.Tracer.IsEnabled())
+		RulesHeatmap.Add(RulesState.Tracer);
+	DungeonRules->OnPostGeneration(this, RulesState);
+	DungeonRules->MergeValidatorOrder(RulesState);
 }
 
 void ADungeonGeneratorWithRules::OnGenerationInit_Implementation()
 {
 	CHECK_RULES();
 	DungeonRules->OnGenerationInit(this);
-	CurrentRule = DungeonRules->GetFirstRule();
+	DungeonRules->ResetRuntimeState(RulesState);
+	ReplayedRooms.Reset();
+	PlanDivergence = INDEX_NONE;
+	NumReplayedChoices = 0;
+
+	// The planned layout is only used once: the rules are evaluated again if the dungeon is not valid.
+	NextReplayChoice = 0;
+	if (!bReplayPlanned)
+	{
+		ReplayChoices.Reset();
+		return;
+	}
+
+	// The seed has been resolved by the generator, the seed type can be restored for the next generations.
+	bReplayPlanned = false;
+	SeedType = PlannedSeedType;
+	if (static_cast<int32>(GetSeed()) != PlannedSeed)
+	{
+		RulesLog_Warning("'%s' does not use the seed of its plan, the rules are evaluated during the generation.", *GetNameSafe(this));
+		ReplayChoices.Reset();
+	}
 }
 
 void ADungeonGeneratorWithRules::OnGenerationFailed_Implementation()
@@ -93,14 +147,334 @@ void ADungeonGeneratorWithRules::OnGenerationFailed_Implementation()
 void ADungeonGeneratorWithRules::OnRoomAdded_Implementation(const URoomData* NewRoom, const TScriptInterface<IReadOnlyRoom>& RoomInstance)
 {
 	CHECK_RULES();
-	DungeonRules->OnRoomAdded(this, RoomInstance);
-	CurrentRule = DungeonRules->GetNextRule(this, CurrentRule, RoomInstance);
+	RulesState.Histogram.AddRoom(NewRoom);
+	DungeonRules->OnRoomAdded(this, RoomInstance, RulesState);
+
+	// The rooms are matched with the planned ones in the order they are added.
+	const FDungeonSimulatedChoice* ReplayedChoice = nullptr;
+	if (ReplayChoices.Num() > 0)
+	{
+		if (ReplayChoices.IsValidIndex(NextReplayChoice - 1) && ReplayChoices[NextReplayChoice - 1].bPlaced)
+		{
+			ReplayedChoice = &ReplayChoices[NextReplayChoice - 1];
+			ReplayedRooms.Add(RoomInstance.GetObject());
+		}
+		else
+		{
+			StopReplay(NextReplayChoice - 1);
+		}
+	}
+
+	// No need to continue a generation which will be rejected anyway.
+	if (const UDungeonValidator* Validator = DungeonRules->FindFailingValidator(this, RoomInstance))
+	{
+		RulesState.AbortingValidator = Validator;
+		++ValidatorAborts.FindOrAdd(Validator, 0);
+		RulesLog_Info("Generation of '%s' aborted after %d rooms by the validator '%s'.", *GetNameSafe(this), RulesState.Histogram.GetTotal(), *GetNameSafe(Validator));
+		return;
+	}
+
+	// Same state as in the plan, so the transitions would take the planned decision: they are not evaluated again.
+	if (ReplayedChoice && ReplayedChoice->NumRuleDraws >= 0)
+	{
+		SkipRandomDraws(GetRandomStream(), ReplayedChoice->NumRuleDraws);
+		RulesState.CurrentRule = ReplayedChoice->NextRule;
+		return;
+	}
+
+	RulesState.CurrentRule = DungeonRules->GetNextRule(RulesState, RulesState.MakeContext(this, RoomInstance, &GetRandomStream()));
 }
 
 void ADungeonGeneratorWithRules::OnFailedToAddRoom_Implementation(const URoomData* FromRoom, const FDoorDef& FromDoor)
 {
 	CHECK_RULES();
 	DungeonRules->OnFailedToAddRoom(this, FromRoom, FromDoor);
+
+	// The planned room has been placed in the plan, so the generation does not follow it anymore.
+	if (ReplayChoices.IsValidIndex(NextReplayChoice - 1) && ReplayChoices[NextReplayChoice - 1].bPlaced)
+		StopReplay(NextReplayChoice - 1);
+}
+
+void ADungeonGeneratorWithRules::PreloadRoomData(const FDungeonRoomDataLoadedDelegate& OnLoaded)
+{
+	CHECK_RULES();
+	DungeonRules->PreloadRoomData(FStreamableDelegate::CreateWeakLambda(this, [OnLoaded]() { OnLoaded.ExecuteIfBound(); }));
+}
+
+void ADungeonGeneratorWithRules::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopPlanning();
+
+	// The task reads the dungeon rules, so it must be finished before they are released.
+	if (SpeculationTask.IsValid())
+		SpeculationTask.Wait();
+	SpeculationTask = {};
+	SpeculationResult.Reset();
+	SpeculativeRules.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
+void ADungeonGeneratorWithRules::GenerateTimeSliced()
+{
+	CHECK_RULES();
+	if (IsPlanning())
+	{
+		RulesLog_Warning("'%s' is already planning a dungeon.", *GetNameSafe(this));
+		return;
+	}
+
+	DungeonRules->PrepareForGeneration();
+
+	const FDungeonRulesSimulator Simulator(DungeonRules->GetProgram());
+	if (!Simulator.IsThreadSafe())
+	{
+		RulesLog_Warning("The dungeon rules '%s' are not thread safe, '%s' generates its dungeon at once.", *GetNameSafe(DungeonRules), *GetNameSafe(this));
+		Generate();
+		return;
+	}
+
+	// The generation will be forced to use the seed of the plan.
+	PlannedSeed = GetNextGenerationSeed();
+	if (!Simulator.Begin(PlannedSeed, RulesState, PlanningLayout, PlanningCursor))
+	{
+		RulesLog_Error("The dungeon rules of '%s' could not choose a first room.", *GetNameSafe(this));
+		OnPlanningFinished.Broadcast(false);
+		return;
+	}
+
+	PlanningTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ADungeonGeneratorWithRules::TickPlanning));
+}
+
+float ADungeonGeneratorWithRules::GetPlanningProgress() const
+{
+	if (PlanningCursor.bFinished)
+		return PlanningLayout.Rooms.Num() > 0 ? 1.0f : 0.0f;
+
+	return static_cast<float>(PlanningCursor.RoomIndex) / FMath::Max(1, PlanningLayout.Rooms.Num());
+}
+
+bool ADungeonGeneratorWithRules::TickPlanning(float DeltaTime)
+{
+	if (!DungeonRules)
+	{
+		StopPlanning();
+		OnPlanningFinished.Broadcast(false);
+		return false;
+	}
+
+	const FDungeonRulesSimulator Simulator(DungeonRules->GetProgram());
+	const double Deadline = FPlatformTime::Seconds() + TimeSliceBudget / 1000.0;
+	const bool bFinished = Simulator.Step(TimeSliceMaxRooms, Deadline, RulesState, PlanningLayout, PlanningCursor);
+	OnPlanningProgress.Broadcast(PlanningLayout.Rooms.Num());
+	if (!bFinished)
+		return true;
+
+	StopPlanning();
+	ReplayChoices = PlanningLayout.Choices;
+	OnPlanningFinished.Broadcast(true);
+	GeneratePlanned(PlannedSeed);
+	return false;
+}
+
+void ADungeonGeneratorWithRules::GenerateSpeculative()
+{
+	CHECK_RULES();
+	if (IsPlanning())
+	{
+		RulesLog_Warning("'%s' is already planning a dungeon.", *GetNameSafe(this));
+		return;
+	}
+
+	DungeonRules->PrepareForGeneration();
+	if (SpeculativeCandidates <= 0 || !DungeonRules->SupportsLayoutValidation())
+	{
+		Generate();
+		return;
+	}
+
+	if (!DungeonRules->IsThreadSafe())
+	{
+		RulesLog_Warning("Speculative generation disabled in '%s': the dungeon rules '%s' are not thread safe.", *GetNameSafe(this), *GetNameSafe(DungeonRules));
+		Generate();
+		return;
+	}
+
+	// Candidates are derived from the seed the generation would have used, so the generation stays reproducible.
+	const int32 BaseSeed = GetNextGenerationSeed();
+	SpeculativeSeeds.Reset();
+	for (int32 i = 0; i < SpeculativeCandidates; ++i)
+	{
+		SpeculativeSeeds.Add(static_cast<int32>(HashCombine(static_cast<uint32>(BaseSeed), GetTypeHash(i))));
+	}
+
+	// The rules are kept alive by the generator, and wait for the task before compiling or updating their room choosers.
+	const UDungeonRules* Rules = DungeonRules;
+	SpeculativeRules.Reset(DungeonRules);
+	const int32 MaxRooms = SpeculativeMaxRooms;
+	TSharedPtr<FSpeculationResult> Result = MakeShared<FSpeculationResult>();
+	SpeculationResult = Result;
+	SpeculationTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Rules, Seeds = SpeculativeSeeds, MaxRooms, Result]()
+	{
+		const FDungeonRulesSimulator Simulator(Rules->GetProgram());
+		Result->Winner = Simulator.FindFirstValidSeed(Seeds, MaxRooms, [Rules](const FDungeonSimulatedLayout& Candidate) { return Rules->IsLayoutValid(Candidate); }, Result->Layout);
+	});
+	DungeonRules->AddAsyncReader(SpeculationTask);
+
+	PlanningTicker = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &ADungeonGeneratorWithRules::TickSpeculation));
+}
+
+bool ADungeonGeneratorWithRules::TickSpeculation(float DeltaTime)
+{
+	if (!SpeculationTask.IsCompleted())
+		return true;
+
+	StopPlanning();
+	const int32 Winner = SpeculationResult->Winner;
+	SpeculationTask = {};
+	SpeculativeRules.Reset();
+	if (Winner == INDEX_NONE)
+	{
+		RulesLog_Warning("None of the %d speculative candidates of '%s' is valid, the rules are evaluated during the generation.", SpeculativeSeeds.Num(), *GetNameSafe(this));
+		ReplayChoices.Reset();
+	}
+	else
+	{
+		ReplayChoices = MoveTemp(SpeculationResult->Layout.Choices);
+	}
+	SpeculationResult.Reset();
+
+	OnPlanningFinished.Broadcast(Winner != INDEX_NONE);
+	if (!DungeonRules)
+		return false;
+
+	// The winner is generated with its own seed, as Generate() would have generated it.
+	if (Winner != INDEX_NONE)
+		GeneratePlanned(SpeculativeSeeds[Winner]);
+	else
+		Generate();
+	return false;
+}
+
+int32 ADungeonGeneratorWithRules::GetNextGenerationSeed() const
+{
+	switch (SeedType)
+	{
+	case ESeedType::Fixed:
+		return static_cast<int32>(GetSeed());
+	case ESeedType::AutoIncrement:
+		return static_cast<int32>(static_cast<uint32>(GetSeed()) + SeedIncrement);
+	default:
+		return FMath::Rand();
+	}
+}
+
+void ADungeonGeneratorWithRules::GeneratePlanned(int32 Seed)
+{
+	// The generator resolves its seed when the generation starts, so it is fixed until OnGenerationInit.
+	PlannedSeed = Seed;
+	PlannedSeedType = SeedType;
+	SeedType = ESeedType::Fixed;
+	SetSeed(Seed);
+	NextReplayChoice = 0;
+	bReplayPlanned = true;
+	Generate();
+}
+
+void ADungeonGeneratorWithRules::StopPlanning()
+{
+	if (PlanningTicker.IsValid())
+		FTSTicker::GetCoreTicker().RemoveTicker(PlanningTicker);
+	PlanningTicker.Reset();
+}
+
+bool ADungeonGeneratorWithRules::ReplayChoice(const TScriptInterface<IReadOnlyRoom>& ParentRoom, const FDoorDef* ParentDoor, URoomData*& OutRoom, int& OutDoorIndex)
+{
+	if (ReplayChoices.Num() <= 0)
+		return false;
+
+	// The generation continues after the end of the plan.
+	if (!ReplayChoices.IsValidIndex(NextReplayChoice))
+	{
+		StopReplay(NextReplayChoice);
+		return false;
+	}
+
+	const FDungeonSimulatedChoice& Choice = ReplayChoices[NextReplayChoice];
+	if (!IsPlannedStep(Choice, ParentRoom, ParentDoor))
+	{
+		StopReplay(NextReplayChoice);
+		return false;
+	}
+
+	// The room chooser is not called, so the random stream is advanced as it would be by the room chooser.
+	++NextReplayChoice;
+	++NumReplayedChoices;
+	SkipRandomDraws(GetRandomStream(), Choice.NumChooserDraws);
+	OutRoom = Choice.RoomData;
+	OutDoorIndex = Choice.DoorIndex;
+	return true;
+}
+
+bool ADungeonGeneratorWithRules::IsPlannedStep(const FDungeonSimulatedChoice& Choice, const TScriptInterface<IReadOnlyRoom>& ParentRoom, const FDoorDef* ParentDoor)
+{
+	if (Choice.Rule != RulesState.CurrentRule
+		|| Choice.NumRooms != RulesState.Histogram.GetTotal()
+		|| Choice.NumChooserDraws < 0
+		|| Choice.RandomBefore != GetRandomStream().GetCurrentSeed())
+		return false;
+
+	if (!ParentDoor)
+		return Choice.ParentIndex == INDEX_NONE;
+
+	if (!ReplayedRooms.IsValidIndex(Choice.ParentIndex) || ReplayedRooms[Choice.ParentIndex] != ParentRoom.GetObject())
+		return false;
+
+	// The doors given by the generator may be transformed in the dungeon space, so only their type is compared.
+	return Choice.ParentRoom->Doors.IsValidIndex(Choice.ParentDoor) && Choice.ParentRoom->Doors[Choice.ParentDoor].Type == ParentDoor->Type;
+}
+
+void ADungeonGeneratorWithRules::StopReplay(int32 DivergentChoice)
+{
+	RulesLog_Warning("The generation of '%s' diverged from its plan after %d choices, the rules are evaluated for the remaining rooms.", *GetNameSafe(this), DivergentChoice);
+	PlanDivergence = DivergentChoice;
+	ReplayChoices.Reset();
+	ReplayedRooms.Reset();
+}
+
+void ADungeonGeneratorWithRules::DumpRulesTrace(const FString& FilePath) const
+{
+	if (!FilePath.IsEmpty())
+	{
+		if (!DungeonRules)
+		{
+			RulesLog_Error("Can't save the dungeon rules trace of '%s': it has no dungeon rules.", *GetNameSafe(this));
+			return;
+		}
+
+		if (RulesState.Tracer.SaveToFile(FilePath, DungeonRules->GetPathName(), DungeonRules->GetProgram()))
+			RulesLog_Info("Dungeon rules trace of '%s' saved in '%s'.", *GetNameSafe(this), *FilePath);
+		return;
+	}
+
+	RulesLog_Info("Dungeon rules trace of '%s':", *GetNameSafe(this));
+	RulesState.Tracer.Dump(*GLog, DungeonRules ? &DungeonRules->GetProgram() : nullptr);
 }
 
 #undef CHECK_RULES
+
+static FAutoConsoleCommandWithWorldAndArgs DumpDungeonRulesTraceCommand(
+	TEXT("DungeonRules.DumpTrace"),
+	TEXT("Writes the last rule decisions of each dungeon generator with rules in the log.\n")
+	TEXT("Usage: DungeonRules.DumpTrace [Directory] (saves one binary file per generator in the directory instead)"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World)
+			return;
+
+		for (TActorIterator<ADungeonGeneratorWithRules> It(World); It; ++It)
+		{
+			const FString FilePath = (Args.Num() > 0) ? FPaths::Combine(Args[0], It->GetName() + TEXT(".drtrace")) : FString();
+			It->DumpRulesTrace(FilePath);
+		}
+	})
+);
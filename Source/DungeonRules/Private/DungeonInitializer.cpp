@@ -4,7 +4,33 @@
 // (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "DungeonInitializer.h"
+#include "DungeonRulesDispatch.h"
+
+void UDungeonInitializer::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BlueprintInitializeDungeon = FDungeonRulesDispatch::FindBlueprintEvent(GetClass(), GET_FUNCTION_NAME_CHECKED(UDungeonInitializer, InitializeDungeon));
+}
 
 void UDungeonInitializer::InitializeDungeon_Implementation(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const
 {
 }
+
+void UDungeonInitializer::DispatchInitializeDungeon(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const
+{
+	if (!FDungeonRulesDispatch::IsNativeDispatchEnabled())
+	{
+		InitializeDungeon(Generator, Rooms);
+		return;
+	}
+
+	if (!BlueprintInitializeDungeon)
+	{
+		InitializeDungeon_Implementation(Generator, Rooms);
+		return;
+	}
+
+	FDungeonRulesEventParams Params(*BlueprintInitializeDungeon);
+	Params.Set(Generator, Rooms);
+	Params.Call(this);
+}
@@ -0,0 +1,135 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonInitializerSchedule.h"
+#include "DungeonInitializer.h"
+#include "DungeonRulesStats.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	bool bConcurrentInitializers = true;
+
+	FAutoConsoleVariableRef CVarDungeonRulesConcurrentInitializers(
+		TEXT("DungeonRules.ConcurrentInitializers"),
+		bConcurrentInitializers,
+		TEXT("Run the thread safe initializers accessing different data concurrently on worker threads.\n")
+		TEXT("0: run them one by one on the game thread"),
+		ECVF_Default);
+
+	struct FDataAccess
+	{
+		TArray<FName> Reads;
+		TArray<FName> Writes;
+
+		bool ConflictsWith(const FDataAccess& Other) const
+		{
+			for (const FName& Data : Writes)
+			{
+				if (Other.Reads.Contains(Data) || Other.Writes.Contains(Data))
+					return true;
+			}
+			for (const FName& Data : Reads)
+			{
+				if (Other.Writes.Contains(Data))
+					return true;
+			}
+			return false;
+		}
+	};
+}
+
+void FDungeonInitializerSchedule::Build(TConstArrayView<TObjectPtr<UDungeonInitializer>> InInitializers)
+{
+	Reset();
+
+	// Wave of each initializer of the array, INDEX_NONE for the empty entries.
+	TArray<int32> Waves;
+	TArray<FDataAccess> Accesses;
+	Waves.Init(INDEX_NONE, InInitializers.Num());
+	Accesses.SetNum(InInitializers.Num());
+
+	// Initializers before this one are all in previous waves.
+	int32 FirstWave = 0;
+	int32 NumWaves = 0;
+	for (int32 i = 0; i < InInitializers.Num(); ++i)
+	{
+		const UDungeonInitializer* Initializer = InInitializers[i];
+		if (!Initializer)
+			continue;
+
+		FDataAccess& Access = Accesses[i];
+		if (!Initializer->IsThreadSafe() || !Initializer->GetDataAccess(Access.Reads, Access.Writes))
+		{
+			Waves[i] = NumWaves;
+			FirstWave = NumWaves + 1;
+			NumWaves = FirstWave;
+			continue;
+		}
+
+		int32 Wave = FirstWave;
+		for (int32 j = 0; j < i; ++j)
+		{
+			if (Waves[j] >= FirstWave && Access.ConflictsWith(Accesses[j]))
+				Wave = FMath::Max(Wave, Waves[j] + 1);
+		}
+		Waves[i] = Wave;
+		NumWaves = FMath::Max(NumWaves, Wave + 1);
+	}
+
+	for (int32 Wave = 0; Wave < NumWaves; ++Wave)
+	{
+		WaveStarts.Add(Initializers.Num());
+		for (int32 i = 0; i < InInitializers.Num(); ++i)
+		{
+			if (Waves[i] == Wave)
+				Initializers.Add(InInitializers[i]);
+		}
+	}
+}
+
+void FDungeonInitializerSchedule::Reset()
+{
+	Initializers.Reset();
+	WaveStarts.Reset();
+}
+
+void FDungeonInitializerSchedule::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(Initializers);
+}
+
+TConstArrayView<const UDungeonInitializer*> FDungeonInitializerSchedule::GetWave(int32 Wave) const
+{
+	check(WaveStarts.IsValidIndex(Wave));
+	const int32 Start = WaveStarts[Wave];
+	const int32 End = WaveStarts.IsValidIndex(Wave + 1) ? WaveStarts[Wave + 1] : Initializers.Num();
+	return TConstArrayView<const UDungeonInitializer*>(Initializers.GetData() + Start, End - Start);
+}
+
+void FDungeonInitializerSchedule::Run(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const
+{
+	check(IsInGameThread());
+	for (int32 Wave = 0; Wave < GetNumWaves(); ++Wave)
+	{
+		const TConstArrayView<const UDungeonInitializer*> WaveInitializers = GetWave(Wave);
+
+		// A wave with a single initializer may be one which is not thread safe.
+		if (WaveInitializers.Num() == 1)
+		{
+			DUNGEONRULES_TRACE_SCOPE(WaveInitializers[0]->GetClass()->GetName());
+			WaveInitializers[0]->DispatchInitializeDungeon(Generator, Rooms);
+			continue;
+		}
+
+		const EParallelForFlags Flags = bConcurrentInitializers ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+		ParallelFor(WaveInitializers.Num(), [&WaveInitializers, Generator, Rooms](int32 Index)
+		{
+			DUNGEONRULES_TRACE_SCOPE(WaveInitializers[Index]->GetClass()->GetName());
+			WaveInitializers[Index]->DispatchInitializeDungeon(Generator, Rooms);
+		}, Flags);
+	}
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRoomCandidates.h"
+#include "RoomData.h"
+#include "DoorType.h"
+#include "Math/RandomStream.h"
+#include "UObject/UObjectGlobals.h"
+
+void FDungeonRoomCandidates::Build(const TArray<URoomData*>& RoomList, const TArray<int32>& RoomWeights)
+{
+	check(RoomWeights.Num() == 0 || RoomWeights.Num() == RoomList.Num());
+
+	Reset();
+	Rooms.Append(RoomList);
+	Weights = RoomWeights;
+
+	BuildSubset(AllRooms, [](const URoomData*) { return true; });
+
+	// Only the door types of the rooms in the list are cached.
+	// Other door types are rare enough to be filtered when needed.
+	for (const URoomData* Room : Rooms)
+	{
+		if (!Room)
+			continue;
+
+		for (const FDoorDef& Door : Room->Doors)
+		{
+			const UDoorType* DoorType = Door.Type;
+			if (Subsets.Contains(DoorType))
+				continue;
+
+			FSubset& Subset = Subsets.Add(DoorType);
+			BuildSubset(Subset, [DoorType](const URoomData* Other) { return IsCompatible(Other, DoorType); });
+		}
+	}
+}
+
+void FDungeonRoomCandidates::Reset()
+{
+	Rooms.Reset();
+	Weights.Reset();
+	AllRooms = FSubset();
+	Subsets.Reset();
+}
+
+void FDungeonRoomCandidates::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	Collector.AddReferencedObjects(Rooms);
+}
+
+URoomData* FDungeonRoomCandidates::Choose(const FRandomStream& Random) const
+{
+	const int32 Index = SampleSubset(AllRooms, Random);
+	return Rooms.IsValidIndex(Index) ? Rooms[Index] : nullptr;
+}
+
+URoomData* FDungeonRoomCandidates::Choose(const UDoorType* DoorType, const FRandomStream& Random) const
+{
+	const FSubset* Subset = FindSubset(DoorType);
+	const int32 Index = Subset ? SampleSubset(*Subset, Random) : SampleCompatible(DoorType, Random);
+
+	// No room can be connected to this door, so keep the previous behavior and let the generator fail the placement.
+	if (Index == INDEX_NONE)
+		return Choose(Random);
+
+	return Rooms[Index];
+}
+
+const FDungeonRoomCandidates::FSubset* FDungeonRoomCandidates::FindSubset(const UDoorType* DoorType) const
+{
+	return Subsets.Find(DoorType);
+}
+
+bool FDungeonRoomCandidates::IsCompatible(const URoomData* Room, const UDoorType* DoorType)
+{
+	if (!Room)
+		return false;
+
+	FDoorDef Door;
+	Door.Type = const_cast<UDoorType*>(DoorType);
+	return Room->HasCompatibleDoor(Door);
+}
+
+void FDungeonRoomCandidates::BuildSubset(FSubset& Subset, TFunctionRef<bool(const URoomData*)> Filter) const
+{
+	Subset.Rooms.Reset();
+	for (int32 Index = 0; Index < Rooms.Num(); ++Index)
+	{
+		if (Filter(Rooms[Index]) && (!IsWeighted() || Weights[Index] > 0))
+			Subset.Rooms.Add(Index);
+	}
+
+	if (!IsWeighted())
+		return;
+
+	TArray<int32> SubsetWeights;
+	SubsetWeights.Reserve(Subset.Rooms.Num());
+	for (const int32 Index : Subset.Rooms)
+	{
+		SubsetWeights.Add(Weights[Index]);
+	}
+	Subset.AliasTable.Build(SubsetWeights);
+}
+
+int32 FDungeonRoomCandidates::SampleSubset(const FSubset& Subset, const FRandomStream& Random) const
+{
+	if (Subset.Rooms.Num() <= 0)
+		return INDEX_NONE;
+
+	const int32 SubsetIndex = IsWeighted() ? Subset.AliasTable.Sample(Random) : Random.RandHelper(Subset.Rooms.Num());
+	return Subset.Rooms.IsValidIndex(SubsetIndex) ? Subset.Rooms[SubsetIndex] : INDEX_NONE;
+}
+
+int32 FDungeonRoomCandidates::SampleCompatible(const UDoorType* DoorType, const FRandomStream& Random) const
+{
+	// Total weight of the compatible rooms (each room weights 1 when not weighted).
+	int64 TotalWeight = 0;
+	for (int32 Index = 0; Index < Rooms.Num(); ++Index)
+	{
+		if (IsCompatible(Rooms[Index], DoorType))
+			TotalWeight += IsWeighted() ? FMath::Max(Weights[Index], 0) : 1;
+	}
+
+	if (TotalWeight <= 0)
+		return INDEX_NONE;
+
+	int64 Value = static_cast<int64>(Random.GetFraction() * TotalWeight);
+	for (int32 Index = 0; Index < Rooms.Num(); ++Index)
+	{
+		if (!IsCompatible(Rooms[Index], DoorType))
+			continue;
+
+		Value -= IsWeighted() ? FMath::Max(Weights[Index], 0) : 1;
+		if (Value < 0)
+			return Index;
+	}
+
+	return INDEX_NONE;
+}
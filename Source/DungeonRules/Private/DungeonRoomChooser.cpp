@@ -5,6 +5,15 @@
 
 #include "DungeonRoomChooser.h"
 #include "DungeonRulesLog.h"
+#include "DungeonRulesDispatch.h"
+#include "DungeonRulesEvaluationContext.h"
+
+void UDungeonRoomChooser::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BlueprintChooseFirstRoomData = FDungeonRulesDispatch::FindBlueprintEvent(GetClass(), GET_FUNCTION_NAME_CHECKED(UDungeonRoomChooser, ChooseFirstRoomData));
+	BlueprintChooseNextRoomData = FDungeonRulesDispatch::FindBlueprintEvent(GetClass(), GET_FUNCTION_NAME_CHECKED(UDungeonRoomChooser, ChooseNextRoomData));
+}
 
 URoomData* UDungeonRoomChooser::ChooseFirstRoomData_Implementation(ADungeonGenerator* Generator) const
 {
@@ -26,3 +35,70 @@ FText UDungeonRoomChooser::GetDescription_Implementation() const
 	return FText();
 #endif
 }
+
+URoomData* UDungeonRoomChooser::ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	return ChooseFirstRoomData_Implementation(Context.GetMutableGenerator());
+}
+
+URoomData* UDungeonRoomChooser::ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const
+{
+	return ChooseNextRoomData_Implementation(Context.GetMutableGenerator(), Context.PreviousRoom, DoorData, DoorIndex);
+}
+
+void UDungeonRoomChooser::GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const
+{
+}
+
+void UDungeonRoomChooser::OnRoomDataLoaded()
+{
+}
+
+void UDungeonRoomChooser::OnRoomDataReleased()
+{
+}
+
+URoomData* UDungeonRoomChooser::DispatchChooseFirstRoomData(ADungeonGenerator* Generator) const
+{
+	if (!FDungeonRulesDispatch::IsNativeDispatchEnabled())
+		return ChooseFirstRoomData(Generator);
+
+	if (!BlueprintChooseFirstRoomData)
+		return ChooseFirstRoomData_Implementation(Generator);
+
+	FDungeonRulesEventParams Params(*BlueprintChooseFirstRoomData);
+	Params.Set(Generator);
+	Params.Call(this);
+	return Params.GetReturnValue<URoomData*>();
+}
+
+URoomData* UDungeonRoomChooser::DispatchChooseNextRoomData(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const
+{
+	if (!FDungeonRulesDispatch::IsNativeDispatchEnabled())
+		return ChooseNextRoomData(Generator, PreviousRoom, DoorData, DoorIndex);
+
+	if (!BlueprintChooseNextRoomData)
+		return ChooseNextRoomData_Implementation(Generator, PreviousRoom, DoorData, DoorIndex);
+
+	FDungeonRulesEventParams Params(*BlueprintChooseNextRoomData);
+	Params.Set(Generator, PreviousRoom, DoorData, DoorIndex);
+	Params.Call(this);
+	DoorIndex = Params.Get<int>(3);
+	return Params.GetReturnValue<URoomData*>();
+}
+
+URoomData* UDungeonRoomChooser::DispatchChooseFirstRoomData(const FDungeonRulesEvaluationContext& Context) const
+{
+	if (BlueprintChooseFirstRoomData || !FDungeonRulesDispatch::IsNativeDispatchEnabled())
+		return DispatchChooseFirstRoomData(Context.GetMutableGenerator());
+
+	return ChooseFirstRoomDataWithContext(Context);
+}
+
+URoomData* UDungeonRoomChooser::DispatchChooseNextRoomData(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const
+{
+	if (BlueprintChooseNextRoomData || !FDungeonRulesDispatch::IsNativeDispatchEnabled())
+		return DispatchChooseNextRoomData(Context.GetMutableGenerator(), Context.PreviousRoom, DoorData, DoorIndex);
+
+	return ChooseNextRoomDataWithContext(Context, DoorData, DoorIndex);
+}
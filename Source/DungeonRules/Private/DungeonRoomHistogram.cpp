@@ -0,0 +1,189 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRoomHistogram.h"
+#include "DungeonGeneratorWithRules.h"
+#include "RoomData.h"
+#include "DungeonRulesSerialization.h"
+#include <atomic>
+
+namespace
+{
+	// Layouts may be reset on worker threads (e.g. programs compiled while loading assets asynchronously).
+	uint32 MakeLayoutSerial()
+	{
+		static std::atomic<uint32> NextSerial {0};
+		return ++NextSerial;
+	}
+}
+
+void FDungeonRoomCounterLayout::Reset()
+{
+	Buckets.Reset();
+	OwnerBuckets.Reset();
+	Serial = MakeLayoutSerial();
+}
+
+void FDungeonRoomCounterLayout::Serialize(FArchive& Ar)
+{
+	using namespace DungeonRulesSerialization;
+
+	int32 NumBuckets = Buckets.Num();
+	Ar << NumBuckets;
+	if (Ar.IsLoading())
+		Buckets.SetNum(NumBuckets);
+
+	for (FBucket& Bucket : Buckets)
+	{
+		SerializeObjects(Ar, Bucket.RoomData);
+		SerializeObjects(Ar, Bucket.RoomClasses);
+	}
+
+	int32 NumOwners = OwnerBuckets.Num();
+	Ar << NumOwners;
+	if (Ar.IsLoading())
+	{
+		OwnerBuckets.Reset();
+		for (int32 i = 0; i < NumOwners; ++i)
+		{
+			const UObject* Owner = nullptr;
+			int32 BucketIndex = INDEX_NONE;
+			SerializeObject(Ar, Owner);
+			Ar << BucketIndex;
+			if (Owner)
+				OwnerBuckets.Add(Owner, BucketIndex);
+		}
+
+		// The histograms must not consider it as the layout they were using.
+		Serial = MakeLayoutSerial();
+	}
+	else
+	{
+		for (auto& Pair : OwnerBuckets)
+		{
+			const UObject* Owner = Pair.Key;
+			SerializeObject(Ar, Owner);
+			Ar << Pair.Value;
+		}
+	}
+}
+
+int32 FDungeonRoomCounterLayout::AddRoomDataBucket(const UObject* Owner, const TArray<TObjectPtr<URoomData>>& RoomData)
+{
+	check(Owner);
+	const int32 ExistingBucket = FindBucket(Owner);
+	if (ExistingBucket != INDEX_NONE)
+		return ExistingBucket;
+
+	const int32 BucketIndex = Buckets.Num();
+	FBucket& Bucket = Buckets.AddDefaulted_GetRef();
+	for (const URoomData* Data : RoomData)
+	{
+		if (Data)
+			Bucket.RoomData.AddUnique(Data);
+	}
+
+	OwnerBuckets.Add(Owner, BucketIndex);
+	Serial = MakeLayoutSerial();
+	return BucketIndex;
+}
+
+int32 FDungeonRoomCounterLayout::AddRoomClassBucket(const UObject* Owner, const TArray<TSubclassOf<URoomData>>& RoomClasses)
+{
+	check(Owner);
+	const int32 ExistingBucket = FindBucket(Owner);
+	if (ExistingBucket != INDEX_NONE)
+		return ExistingBucket;
+
+	const int32 BucketIndex = Buckets.Num();
+	FBucket& Bucket = Buckets.AddDefaulted_GetRef();
+	for (const TSubclassOf<URoomData>& RoomClass : RoomClasses)
+	{
+		if (RoomClass)
+			Bucket.RoomClasses.AddUnique(RoomClass.Get());
+	}
+
+	OwnerBuckets.Add(Owner, BucketIndex);
+	Serial = MakeLayoutSerial();
+	return BucketIndex;
+}
+
+int32 FDungeonRoomCounterLayout::FindBucket(const UObject* Owner) const
+{
+	const int32* BucketIndex = OwnerBuckets.Find(Owner);
+	return BucketIndex ? *BucketIndex : INDEX_NONE;
+}
+
+void FDungeonRoomCounterLayout::GetBucketsOf(const URoomData* RoomData, TArray<int32>& OutBuckets) const
+{
+	OutBuckets.Reset();
+	if (!RoomData)
+		return;
+
+	const UClass* RoomClass = RoomData->GetClass();
+	for (int32 BucketIndex = 0; BucketIndex < Buckets.Num(); ++BucketIndex)
+	{
+		const FBucket& Bucket = Buckets[BucketIndex];
+		const bool bInBucket = Bucket.RoomData.Contains(RoomData)
+			|| Bucket.RoomClasses.ContainsByPredicate([RoomClass](const UClass* Class) { return RoomClass->IsChildOf(Class); });
+
+		if (bInBucket)
+			OutBuckets.Add(BucketIndex);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void FDungeonRoomHistogram::Reset(const FDungeonRoomCounterLayout& NewLayout)
+{
+	if (Layout != &NewLayout || LayoutSerial != NewLayout.GetSerial())
+	{
+		RoomDataBuckets.Reset();
+		Layout = &NewLayout;
+		LayoutSerial = NewLayout.GetSerial();
+	}
+
+	Counts.Init(0, NewLayout.NumBuckets());
+	Total = 0;
+}
+
+void FDungeonRoomHistogram::AddRoom(const URoomData* RoomData)
+{
+	++Total;
+	if (!Layout || Counts.Num() <= 0)
+		return;
+
+	const TArray<int32>* Buckets = RoomDataBuckets.Find(RoomData);
+	if (!Buckets)
+	{
+		TArray<int32>& NewBuckets = RoomDataBuckets.Add(RoomData);
+		Layout->GetBucketsOf(RoomData, NewBuckets);
+		Buckets = &NewBuckets;
+	}
+
+	for (const int32 BucketIndex : *Buckets)
+	{
+		++Counts[BucketIndex];
+	}
+}
+
+bool FDungeonRoomHistogram::GetCount(const UObject* Owner, int32& OutCount) const
+{
+	if (!Layout)
+		return false;
+
+	const int32 BucketIndex = Layout->FindBucket(Owner);
+	if (!Counts.IsValidIndex(BucketIndex))
+		return false;
+
+	OutCount = Counts[BucketIndex];
+	return true;
+}
+
+const FDungeonRoomHistogram* FDungeonRoomHistogram::Get(const ADungeonGenerator* Generator)
+{
+	const ADungeonGeneratorWithRules* GeneratorWithRules = Cast<ADungeonGeneratorWithRules>(Generator);
+	return GeneratorWithRules ? &GeneratorWithRules->GetRoomHistogram() : nullptr;
+}
@@ -0,0 +1,49 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRoomInitializer.h"
+#include "DungeonGraph.h"
+#include "Room.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+
+namespace
+{
+	bool bParallelRoomInitializers = true;
+
+	FAutoConsoleVariableRef CVarDungeonRulesParallelRoomInitializers(
+		TEXT("DungeonRules.ParallelRoomInitializers"),
+		bParallelRoomInitializers,
+		TEXT("Initialize the rooms of the thread safe room initializers on worker threads.\n")
+		TEXT("0: initialize them one by one on the game thread"),
+		ECVF_Default);
+
+	// Rooms are cheap to initialize individually, so the worker threads get them by batches.
+	constexpr int32 MinRoomsPerBatch = 16;
+}
+
+void UDungeonRoomInitializer::InitializeDungeon_Implementation(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const
+{
+	if (!Rooms)
+		return;
+
+	TArray<URoom*> AllRooms;
+	Rooms->GetAllRooms(AllRooms);
+	InitializeRooms(Generator, AllRooms);
+}
+
+void UDungeonRoomInitializer::InitializeRooms(const ADungeonGenerator* Generator, TConstArrayView<URoom*> Rooms) const
+{
+	check(IsInGameThread());
+	BeginRooms(Generator, Rooms.Num());
+
+	const EParallelForFlags Flags = (bParallelRoomInitializers && CanInitializeRoomsConcurrently()) ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	ParallelFor(TEXT("DungeonRoomInitializer"), Rooms.Num(), MinRoomsPerBatch, [this, Generator, &Rooms](int32 Index)
+	{
+		InitializeRoom(Generator, Rooms[Index], Index);
+	}, Flags);
+
+	EndRooms(Generator, Rooms);
+}
@@ -13,30 +13,26 @@
 #include "DungeonEventReceiver.h"
 #include "DungeonValidator.h"
 #include "DungeonInitializer.h"
+#include "DungeonRulesCustomVersion.h"
+#include "DungeonRulesRuntimeState.h"
+#include "DungeonRulesStats.h"
+#include "Engine/AssetManager.h"
 
-bool UDungeonRuleTransition::CheckCondition(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
+namespace
 {
-	UE_LOG(LogTemp, Log, TEXT("[%s] Transition Check Condition"), *GetNameSafe(PreviousRoom->GetRoomData()));
-	if (const IDungeonConditionProvider* ConditionProvider = Cast<IDungeonConditionProvider>(NextRule.GetObject()))
+	// Name of the scopes of a rule in the DungeonRules trace channel.
+	FString GetRuleTraceName(const FDungeonRulesProgram& Program, int32 RuleIndex)
 	{
-		UE_LOG(LogTemp, Log, TEXT("NextRule has condition"));
-		// If the next state has a condition and is not fulfilled, then we can't go into it.
-		if (!ConditionProvider->CheckCondition(Generator, PreviousRoom))
-		{
-			UE_LOG(LogTemp, Log, TEXT("Condition not valid"));
-			return false;
-		}
+		if (!Program.IsValidRule(RuleIndex))
+			return TEXT("Rule <none>");
+		const FDungeonRulesProgram::FRule& Rule = Program.Rules[RuleIndex];
+		return FString::Printf(TEXT("Rule '%s' (%s)"), Rule.Rule ? *Rule.Rule->RuleName : TEXT("?"), *GetNameSafe(Rule.RoomChooser ? Rule.RoomChooser->GetClass() : nullptr));
 	}
 
-	// If this transition has no condition, then it goes always to the next state.
-	if (!IsValid(Condition))
+	bool AreAllLoaded(const TArray<FSoftObjectPath>& RoomData)
 	{
-		UE_LOG(LogTemp, Log, TEXT("No condition"));
-		return true;
+		return !RoomData.ContainsByPredicate([](const FSoftObjectPath& Path) { return Path.ResolveObject() == nullptr; });
 	}
-
-	UE_LOG(LogTemp, Log, TEXT("Check Condition from transition"));
-	return Condition->Check(Generator, PreviousRoom);
 }
 
 FText UDungeonRuleTransition::GetNodeTooltip() const
@@ -47,39 +43,8 @@ FText UDungeonRuleTransition::GetNodeTooltip() const
 	return Condition->GetDescription();
 }
 
-TOptional<const UDungeonRule*> UDungeonRuleTransition::GetNextRuleFromTransitionList(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const TArray<TWeakObjectPtr<const UDungeonRuleTransition>>& Transitions, const UObject* Context /*= nullptr*/)
-{
-	TOptional<const UDungeonRule*> NextRule;
-	int32 CurrentPriority = INT32_MAX;
-	for (const auto& Transition : Transitions)
-	{
-		if (!Transition.IsValid())
-		{
-			RulesLog_Warning("Invalid transition found in %s.", *GetNameSafe(Context));
-			continue;
-		}
-
-		if (Transition->PriorityOrder >= CurrentPriority)
-			continue;
-
-		if (!Transition->CheckCondition(Generator, PreviousRoom))
-			continue;
-
-		const IDungeonRuleProvider* RuleProvider = Transition->NextRule.GetInterface();
-		NextRule = RuleProvider ? RuleProvider->GetRule(Generator, PreviousRoom) : nullptr;
-		CurrentPriority = Transition->PriorityOrder;
-	}
-
-	return NextRule;
-}
-
 //////////////////////////////////////////////////////////////////////
 
-TOptional<const UDungeonRule*> UDungeonRule::GetNextRule(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
-{
-	return UDungeonRuleTransition::GetNextRuleFromTransitionList(Generator, PreviousRoom, Transitions, this);
-}
-
 FText UDungeonRule::GetNodeTooltip() const
 {
 	if (!IsValid(RoomChooser))
@@ -103,24 +68,6 @@ void UDungeonRule::AddTransition(const UDungeonRuleTransition* Transition)
 
 ///////////////////////////////////////////////////////////////////
 
-const UDungeonRule* URuleConduit::GetRule(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
-{
-	auto NextRule = UDungeonRuleTransition::GetNextRuleFromTransitionList(Generator, PreviousRoom, Transitions, this);
-	return NextRule.IsSet() ? NextRule.GetValue() : nullptr;
-}
-
-bool URuleConduit::CheckCondition(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
-{
-	UE_LOG(LogTemp, Log, TEXT("[%s] Conduit Check Condition"), *GetNameSafe(PreviousRoom->GetRoomData()));
-	// Returns true if at least one output is valid.
-	for (const auto& Transition : Transitions)
-	{
-		if (Transition->CheckCondition(Generator, PreviousRoom))
-			return true;
-	}
-	return false;
-}
-
 #if WITH_EDITOR
 void URuleConduit::Clear()
 {
@@ -141,22 +88,125 @@ UDungeonRules::UDungeonRules()
 {
 }
 
-URoomData* UDungeonRules::GetFirstRoomData(ADungeonGenerator* Generator, const UDungeonRule* CurrentRule) const
+void UDungeonRules::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+	Ar.UsingCustomVersion(FDungeonRulesCustomVersion::GUID);
+
+	if (Ar.CustomVer(FDungeonRulesCustomVersion::GUID) < FDungeonRulesCustomVersion::CookedProgram)
+		return;
+
+	// Cooked assets store the compiled program, so it is not rebuilt when loaded.
+	// Assets saved in editor are always compiled when loaded, so the program is not stored.
+	bool bHasProgram = Ar.IsSaving() && Ar.IsCooking();
+	Ar << bHasProgram;
+	if (!bHasProgram)
+		return;
+
+	if (Ar.IsLoading())
+		Program.Reset();
+
+	Program.Serialize(Ar);
+	if (Ar.IsLoading())
+		bCookedProgram = true;
+}
+
+void UDungeonRules::PostLoad()
+{
+	Super::PostLoad();
+	if (!bCookedProgram)
+		Compile();
+	else
+	{
+		UpdateThreadSafety();
+		UpdateEventSubscribers();
+		InitializerSchedule.Build(Initializers);
+	}
+}
+
+void UDungeonRules::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	// The compiled data point to the subobjects of the asset without being UPROPERTYs.
+	UDungeonRules* This = CastChecked<UDungeonRules>(InThis);
+	This->Program.AddReferencedObjects(Collector);
+	This->InitializerSchedule.AddReferencedObjects(Collector);
+	for (TArray<UDungeonEventReceiver*>& Subscribers : This->EventSubscribers)
+	{
+		Collector.AddReferencedObjects(Subscribers, This);
+	}
+	Collector.AddReferencedObjects(This->NotThreadSafeObjects, This);
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+#if WITH_EDITOR
+void UDungeonRules::PostInitProperties()
 {
-	if (!IsValid(CurrentRule))
+	Super::PostInitProperties();
+	if (!HasAnyFlags(RF_ClassDefaultObject))
+	{
+		ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddUObject(this, &UDungeonRules::OnObjectPropertyChanged);
+		ObjectsReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddUObject(this, &UDungeonRules::OnObjectsReinstanced);
+	}
+}
+
+void UDungeonRules::BeginDestroy()
+{
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+	FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ObjectsReinstancedHandle);
+	Super::BeginDestroy();
+}
+
+void UDungeonRules::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	MarkProgramDirty();
+}
+
+void UDungeonRules::PostEditUndo()
+{
+	Super::PostEditUndo();
+	MarkProgramDirty();
+}
+
+void UDungeonRules::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// The room choosers, conditions, etc. are all outered to the asset.
+	if (Object && Object != this && Object->IsIn(this))
+		MarkProgramDirty();
+}
+
+void UDungeonRules::OnObjectsReinstanced(const TMap<UObject*, UObject*>& ReplacedObjects)
+{
+	// The program still points to the old instances, only the properties of the asset point to the new ones.
+	for (const TPair<UObject*, UObject*>& Pair : ReplacedObjects)
+	{
+		if (Pair.Value && Pair.Value->IsIn(this))
+		{
+			MarkProgramDirty();
+			return;
+		}
+	}
+}
+#endif
+
+URoomData* UDungeonRules::GetFirstRoomData(const FDungeonRulesEvaluationContext& Context, int32 CurrentRule) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_DungeonRules_GetFirstRoomData);
+	if (!Program.IsValidRule(CurrentRule))
 	{
 		RulesLog_Error("No current rule!");
 		return nullptr;
 	}
 
-	UDungeonRoomChooser* RoomChooser = CurrentRule->RoomChooser;
+	const UDungeonRoomChooser* RoomChooser = Program.Rules[CurrentRule].RoomChooser;
 	if (!IsValid(RoomChooser))
 	{
 		RulesLog_Error("No room chooser in current rule!");
 		return nullptr;
 	}
 
-	URoomData* Room = RoomChooser->ChooseFirstRoomData(Generator);
+	DUNGEONRULES_TRACE_SCOPE(GetRuleTraceName(Program, CurrentRule));
+	URoomData* Room = RoomChooser->DispatchChooseFirstRoomData(Context);
 	if (!IsValid(Room))
 	{
 		RulesLog_Error("Room chooser in current rule returned invalid room data!");
@@ -166,22 +216,24 @@ URoomData* UDungeonRules::GetFirstRoomData(ADungeonGenerator* Generator, const U
 	return Room;
 }
 
-URoomData* UDungeonRules::GetNextRoomData(ADungeonGenerator* Generator, const UDungeonRule* CurrentRule, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const
+URoomData* UDungeonRules::GetNextRoomData(const FDungeonRulesEvaluationContext& Context, int32 CurrentRule, const FDoorDef& DoorData, int& DoorIndex) const
 {
-	if (!IsValid(CurrentRule))
+	SCOPE_CYCLE_COUNTER(STAT_DungeonRules_GetNextRoomData);
+	if (!Program.IsValidRule(CurrentRule))
 	{
 		RulesLog_Error("No current rule!");
 		return nullptr;
 	}
 
-	UDungeonRoomChooser* RoomChooser = CurrentRule->RoomChooser;
+	const UDungeonRoomChooser* RoomChooser = Program.Rules[CurrentRule].RoomChooser;
 	if (!IsValid(RoomChooser))
 	{
 		RulesLog_Error("No room chooser in current rule!");
 		return nullptr;
 	}
 
-	URoomData* Room = RoomChooser->ChooseNextRoomData(Generator, PreviousRoom, DoorData, DoorIndex);
+	DUNGEONRULES_TRACE_SCOPE(GetRuleTraceName(Program, CurrentRule));
+	URoomData* Room = RoomChooser->DispatchChooseNextRoomData(Context, DoorData, DoorIndex);
 	if (!IsValid(Room))
 	{
 		RulesLog_Error("Room chooser in current rule returned invalid room data!");
@@ -191,80 +243,418 @@ URoomData* UDungeonRules::GetNextRoomData(ADungeonGenerator* Generator, const UD
 	return Room;
 }
 
-bool UDungeonRules::IsDungeonValid(const ADungeonGenerator* Generator)
+bool UDungeonRules::IsDungeonValid(const ADungeonGenerator* Generator, FDungeonRulesRuntimeState& State) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_DungeonRules_IsDungeonValid);
+	if (!bAdaptiveValidatorOrder)
+	{
+		for (const UDungeonValidator* Validator : Validators)
+		{
+			if (!Validator)
+				continue;
+			DUNGEONRULES_TRACE_SCOPE(GetNameSafe(Validator->GetClass()));
+			if (!Validator->IsDungeonValid(Generator))
+				return false;
+		}
+		return true;
+	}
+
+	// The order and stats are the ones of the generator, so the asset is not modified.
+	FDungeonValidatorOrder& Order = State.ValidatorOrder;
+	Order.Update(Validators);
+
+	bool bValid = true;
+	for (const UDungeonValidator* Validator : Order.Get())
+	{
+		DUNGEONRULES_TRACE_SCOPE(GetNameSafe(Validator->GetClass()));
+		const double StartTime = FPlatformTime::Seconds();
+		bValid = Validator->IsDungeonValid(Generator);
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		Order.Record(Validator, Seconds, bValid);
+		State.UnmergedValidatorStats.Record(Validator, Seconds, bValid);
+		if (!bValid)
+			break;
+	}
+
+	// The order is not modified while it is iterated.
+	Order.Sort();
+	return bValid;
+}
+
+void UDungeonRules::MergeValidatorOrder(FDungeonRulesRuntimeState& State)
+{
+	check(IsInGameThread());
+	if (!bAdaptiveValidatorOrder)
+		return;
+
+	ValidatorOrder.Merge(State.UnmergedValidatorStats);
+	ValidatorOrder.Update(Validators);
+	State.UnmergedValidatorStats.Reset();
+	State.ValidatorOrder = ValidatorOrder;
+}
+
+bool UDungeonRules::IsLayoutValid(const FDungeonSimulatedLayout& Layout) const
 {
 	for (const UDungeonValidator* Validator : Validators)
 	{
-		if (!Validator)
+		if (!Validator || !Validator->SupportsLayoutValidation())
 			continue;
-		if (!Validator->IsDungeonValid(Generator))
+		if (!Validator->IsLayoutValid(Layout))
 			return false;
 	}
 	return true;
 }
 
-void UDungeonRules::InitializeDungeon(ADungeonGenerator* Generator, const UDungeonGraph* Rooms)
+bool UDungeonRules::SupportsLayoutValidation() const
+{
+	return Validators.ContainsByPredicate([](const UDungeonValidator* Validator) { return Validator && Validator->SupportsLayoutValidation(); });
+}
+
+const UDungeonValidator* UDungeonRules::FindFailingValidator(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom) const
 {
-	for (const UDungeonInitializer* Initializer : Initializers)
+	SCOPE_CYCLE_COUNTER(STAT_DungeonRules_CanStillBeValid);
+	for (const UDungeonValidator* Validator : Validators)
 	{
-		if (!Initializer)
+		if (!Validator)
 			continue;
-		Initializer->InitializeDungeon(Generator, Rooms);
+		DUNGEONRULES_TRACE_SCOPE(GetNameSafe(Validator->GetClass()));
+		if (!Validator->DispatchCanStillBeValid(Generator, NewRoom))
+			return Validator;
 	}
+	return nullptr;
+}
+
+void UDungeonRules::InitializeDungeon(ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_DungeonRules_InitializeDungeon);
+	InitializerSchedule.Run(Generator, Rooms);
 }
 
 #define ROUTE_DUNGEON_EVENT(EVENT_NAME, ...) \
-for (UDungeonEventReceiver* EventReceiver : EventReceivers) \
-{ if (EventReceiver) EventReceiver->EVENT_NAME(__VA_ARGS__); }
+{ \
+	SCOPE_CYCLE_COUNTER(STAT_DungeonRules_##EVENT_NAME); \
+	for (UDungeonEventReceiver* EventReceiver : EventSubscribers[static_cast<uint8>(EDungeonEvent::EVENT_NAME)]) \
+	{ DUNGEONRULES_TRACE_SCOPE(EventReceiver->GetClass()->GetName()); EventReceiver->Dispatch##EVENT_NAME(__VA_ARGS__); } \
+}
 
 void UDungeonRules::OnPreGeneration(ADungeonGenerator* Generator)
 {
+	PrepareForGeneration();
 	ROUTE_DUNGEON_EVENT(OnPreGeneration, Generator);
 }
 
-void UDungeonRules::OnPostGeneration(ADungeonGenerator* Generator)
+void UDungeonRules::OnPostGeneration(ADungeonGenerator* Generator, const FDungeonRulesRuntimeState& State) const
 {
+	ROUTE_DUNGEON_EVENT(OnRoomsAdded, Generator, State.AddedRooms);
 	ROUTE_DUNGEON_EVENT(OnPostGeneration, Generator);
 }
 
-void UDungeonRules::OnGenerationInit(ADungeonGenerator* Generator)
+void UDungeonRules::OnGenerationInit(ADungeonGenerator* Generator) const
 {
 	ROUTE_DUNGEON_EVENT(OnGenerationInit, Generator);
 }
 
-void UDungeonRules::OnGenerationFailed(ADungeonGenerator* Generator)
+void UDungeonRules::OnGenerationFailed(ADungeonGenerator* Generator) const
 {
 	ROUTE_DUNGEON_EVENT(OnGenerationFailed, Generator);
 }
 
-void UDungeonRules::OnRoomAdded(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom)
+void UDungeonRules::OnRoomAdded(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom, FDungeonRulesRuntimeState& State) const
 {
+	if (HasBatchedRoomAdded())
+		State.AddedRooms.Add(NewRoom);
 	ROUTE_DUNGEON_EVENT(OnRoomAdded, Generator, NewRoom);
 }
 
-void UDungeonRules::OnFailedToAddRoom(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor)
+void UDungeonRules::OnFailedToAddRoom(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor) const
 {
 	ROUTE_DUNGEON_EVENT(OnFailedToAddRoom, Generator, FromRoom, FromDoor);
 }
 
-#undef ROUTE_DUNGEON_EVENT_TO_RECEIVER
+#undef ROUTE_DUNGEON_EVENT
+
+void UDungeonRules::PrepareForGeneration()
+{
+#if WITH_EDITOR
+	// Conditions and room choosers may have been edited since the last compilation.
+	if (bProgramDirty)
+		Compile();
+#endif
+	LoadRoomData();
+}
+
+void UDungeonRules::ResetRuntimeState(FDungeonRulesRuntimeState& State) const
+{
+	State.Reset(Program);
+}
+
+int32 UDungeonRules::GetNextRule(FDungeonRulesRuntimeState& State, const FDungeonRulesEvaluationContext& Context) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_DungeonRules_GetNextRule);
+	DUNGEONRULES_TRACE_SCOPE(GetRuleTraceName(Program, State.CurrentRule));
+	return Program.GetNextRule(State, Context);
+}
 
-const UDungeonRule* UDungeonRules::GetNextRule(ADungeonGenerator* Generator, const UDungeonRule* CurrentRule, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
+void UDungeonRules::Compile()
 {
-	if (!IsValid(CurrentRule))
+	WaitForAsyncReaders();
+#if WITH_EDITOR
+	bProgramDirty = false;
+#endif
+	Program.Reset();
+
+	// The new program may reach room choosers whose room data are not loaded.
+	bRoomDataLoaded = false;
+
+	TMap<const UObject*, int32> RuleIndices;
+	for (const UDungeonRule* Rule : Rules)
+	{
+		if (!Rule)
+			continue;
+
+		RuleIndices.Add(Rule, Program.Rules.Num());
+		FDungeonRulesProgram::FRule& CompiledRule = Program.Rules.AddDefaulted_GetRef();
+		CompiledRule.Rule = Rule;
+		CompiledRule.RoomChooser = Rule->RoomChooser;
+	}
+
+	TMap<const UObject*, int32> ConduitIndices;
+	for (const URuleConduit* Conduit : Conduits)
+	{
+		if (!Conduit)
+			continue;
+
+		ConduitIndices.Add(Conduit, Program.Conduits.Num());
+		Program.Conduits.AddDefaulted();
+	}
+
+	for (FDungeonRulesProgram::FRule& CompiledRule : Program.Rules)
+	{
+		CompiledRule.Transitions = CompileTransitions(CompiledRule.Rule->Transitions, RuleIndices, ConduitIndices, CompiledRule.Rule);
+	}
+
+	int32 ConduitIndex = 0;
+	for (const URuleConduit* Conduit : Conduits)
+	{
+		if (!Conduit)
+			continue;
+
+		Program.Conduits[ConduitIndex++].Transitions = CompileTransitions(Conduit->Transitions, RuleIndices, ConduitIndices, Conduit);
+	}
+
+	Program.GlobalTransitions = CompileTransitions(GlobalTransitions, RuleIndices, ConduitIndices, this);
+
+	if (const int32* FirstRuleIndex = RuleIndices.Find(FirstRule.Get()))
+		Program.FirstRule = *FirstRuleIndex;
+
+	// Copy the array since compiling a condition may add nested conditions to it.
+	const TArray<const URuleTransitionCondition*> TransitionConditions = Program.Conditions;
+	for (const URuleTransitionCondition* Condition : TransitionConditions)
+	{
+		Condition->OnCompile(Program);
+	}
+
+	Program.CompileConditions();
+	UpdateThreadSafety();
+	UpdateEventSubscribers();
+	InitializerSchedule.Build(Initializers);
+}
+
+void UDungeonRules::GetReachableRoomData(TArray<FSoftObjectPath>& OutRoomData) const
+{
+	const TBitArray<> ReachableRules = Program.GetReachableRules();
+	for (TConstSetBitIterator<> It(ReachableRules); It; ++It)
+	{
+		const UDungeonRoomChooser* RoomChooser = Program.Rules[It.GetIndex()].RoomChooser;
+		if (IsValid(RoomChooser))
+			RoomChooser->GetRoomDataToLoad(OutRoomData);
+	}
+}
+
+TSharedPtr<FStreamableHandle> UDungeonRules::PreloadRoomData(FStreamableDelegate OnLoaded)
+{
+	TArray<FSoftObjectPath> RoomData;
+	GetReachableRoomData(RoomData);
+
+	FStreamableDelegate OnRoomDataLoaded = FStreamableDelegate::CreateWeakLambda(this, [this, OnLoaded]()
+	{
+		NotifyRoomDataLoaded();
+		OnLoaded.ExecuteIfBound();
+	});
+
+	if (RoomData.Num() <= 0)
+	{
+		OnRoomDataLoaded.Execute();
 		return nullptr;
+	}
+
+	// The previous handle is released only after the new one is created, so the room data already loaded stay loaded.
+	RoomDataHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(RoomData, OnRoomDataLoaded);
+	return RoomDataHandle;
+}
+
+void UDungeonRules::LoadRoomData()
+{
+	// The room choosers keep their room data loaded, so there is nothing new to give them.
+	if (bRoomDataLoaded)
+		return;
+
+	TArray<FSoftObjectPath> RoomData;
+	GetReachableRoomData(RoomData);
+	if (!AreAllLoaded(RoomData))
+	{
+		RulesLog_Info("Loading room data of '%s' synchronously. Call PreloadRoomData before the generation to stream them.", *GetName());
+		RoomDataHandle = UAssetManager::GetStreamableManager().RequestSyncLoad(RoomData);
+	}
+
+	// Room data may have been loaded by something else since the room choosers were built.
+	NotifyRoomDataLoaded();
+}
+
+void UDungeonRules::ReleaseRoomData()
+{
+	WaitForAsyncReaders();
+	if (RoomDataHandle.IsValid())
+		RoomDataHandle->ReleaseHandle();
+	RoomDataHandle.Reset();
+	bRoomDataLoaded = false;
+
+	for (UDungeonRule* Rule : Rules)
+	{
+		if (Rule && IsValid(Rule->RoomChooser))
+			Rule->RoomChooser->OnRoomDataReleased();
+	}
+}
 
-	TOptional<const UDungeonRule*> NextRule = CurrentRule->GetNextRule(Generator, PreviousRoom);
-	if (NextRule.IsSet())
-		return NextRule.GetValue();
+void UDungeonRules::UpdateThreadSafety()
+{
+	NotThreadSafeObjects.Reset();
+	Program.GetNotThreadSafeObjects(NotThreadSafeObjects);
+	for (const UDungeonValidator* Validator : Validators)
+	{
+		if (Validator && !Validator->IsThreadSafe())
+			NotThreadSafeObjects.Add(Validator);
+	}
+}
+
+void UDungeonRules::UpdateEventSubscribers()
+{
+	for (int32 Event = 0; Event < static_cast<int32>(EDungeonEvent::Count); ++Event)
+	{
+		TArray<UDungeonEventReceiver*>& Subscribers = EventSubscribers[Event];
+		Subscribers.Reset();
+		for (UDungeonEventReceiver* EventReceiver : EventReceivers)
+		{
+			if (EventReceiver && EventReceiver->IsSubscribedTo(static_cast<EDungeonEvent>(Event)))
+				Subscribers.Add(EventReceiver);
+		}
+	}
+}
+
+void UDungeonRules::AddAsyncReader(const UE::Tasks::FTask& Task)
+{
+	check(IsInGameThread());
+	AsyncReaders.RemoveAll([](const UE::Tasks::FTask& Reader) { return Reader.IsCompleted(); });
+	AsyncReaders.Add(Task);
+}
+
+void UDungeonRules::WaitForAsyncReaders()
+{
+	if (AsyncReaders.Num() <= 0)
+		return;
+
+	UE::Tasks::Wait(AsyncReaders);
+	AsyncReaders.Reset();
+}
+
+void UDungeonRules::NotifyRoomDataLoaded()
+{
+	WaitForAsyncReaders();
+	for (UDungeonRule* Rule : Rules)
+	{
+		if (Rule && IsValid(Rule->RoomChooser))
+			Rule->RoomChooser->OnRoomDataLoaded();
+	}
+
+	// Some room data may have failed to load, the room choosers are then updated again before the next generation.
+	TArray<FSoftObjectPath> RoomData;
+	GetReachableRoomData(RoomData);
+	bRoomDataLoaded = AreAllLoaded(RoomData);
+}
+
+FDungeonRulesProgram::FTransitionRange UDungeonRules::CompileTransitions(const TArray<TWeakObjectPtr<const UDungeonRuleTransition>>& TransitionList, const TMap<const UObject*, int32>& RuleIndices, const TMap<const UObject*, int32>& ConduitIndices, const UObject* Context)
+{
+	FDungeonRulesProgram::FTransitionRange Range;
+	Range.First = Program.Transitions.Num();
 
-	NextRule = UDungeonRuleTransition::GetNextRuleFromTransitionList(Generator, PreviousRoom, GlobalTransitions, this);
-	return NextRule.IsSet() ? NextRule.GetValue() : CurrentRule;
+	for (const auto& Transition : TransitionList)
+	{
+		if (!Transition.IsValid())
+		{
+			RulesLog_Warning("Invalid transition found in %s.", *GetNameSafe(Context));
+			continue;
+		}
+
+		FDungeonRulesProgram::FTransition& CompiledTransition = Program.Transitions.AddDefaulted_GetRef();
+		CompiledTransition.Condition = Program.AddCondition(Transition->Condition);
+		CompiledTransition.PriorityOrder = Transition->PriorityOrder;
+#if WITH_EDITORONLY_DATA
+		CompiledTransition.Source = Transition.Get();
+#endif
+
+		const UObject* NextRule = Transition->NextRule.GetObject();
+		if (const int32* RuleIndex = RuleIndices.Find(NextRule))
+		{
+			CompiledTransition.TargetType = EDungeonRulesNodeType::Rule;
+			CompiledTransition.Target = *RuleIndex;
+		}
+		else if (const int32* ConduitIndex = ConduitIndices.Find(NextRule))
+		{
+			CompiledTransition.TargetType = EDungeonRulesNodeType::Conduit;
+			CompiledTransition.Target = *ConduitIndex;
+		}
+		else if (NextRule)
+		{
+			RulesLog_Warning("Transition %s in %s leads to %s which is not registered in %s.", *Transition->GetName(), *GetNameSafe(Context), *NextRule->GetName(), *GetName());
+		}
+	}
+
+	Range.Num = Program.Transitions.Num() - Range.First;
+	Program.SortTransitions(Range);
+	return Range;
 }
 
 #if WITH_EDITOR
+void UDungeonRules::FreezeValidatorOrder()
+{
+	WaitForAsyncReaders();
+	ValidatorOrder.Update(Validators);
+	const TArray<const UDungeonValidator*>& Order = ValidatorOrder.Get();
+
+	// The order contains all the validators of the array, the empty entries are kept at the end.
+	TArray<TObjectPtr<UDungeonValidator>> SortedValidators;
+	for (const UDungeonValidator* Validator : Order)
+	{
+		SortedValidators.Add(const_cast<UDungeonValidator*>(Validator));
+	}
+	SortedValidators.AddDefaulted(Validators.Num() - SortedValidators.Num());
+
+	Modify();
+	Validators = MoveTemp(SortedValidators);
+	bAdaptiveValidatorOrder = false;
+
+	for (const UDungeonValidator* Validator : Validators)
+	{
+		const FDungeonValidatorOrder::FStats* Stats = ValidatorOrder.FindStats(Validator);
+		if (Stats)
+			RulesLog_Info("Validator '%s': %d calls, %.1f%% failures, %.3f ms on average.", *GetNameSafe(Validator), Stats->NumCalls, 100.0 * Stats->NumFailures / FMath::Max(1, Stats->NumCalls), Stats->GetAverageCost() * 1000.0);
+	}
+}
+
 void UDungeonRules::Clear()
 {
+	// The graph is always cleared before being saved back into the asset.
+	MarkProgramDirty();
 	FirstRule.Reset();
 	GlobalTransitions.Empty();
 
@@ -0,0 +1,12 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesCustomVersion.h"
+#include "Serialization/CustomVersion.h"
+
+const FGuid FDungeonRulesCustomVersion::GUID(0x5D1A7C3E, 0x2B9F4E61, 0x8C0D47A2, 0x96E3F1B5);
+
+// Register the custom version with core
+FCustomVersionRegistration GRegisterDungeonRulesCustomVersion(FDungeonRulesCustomVersion::GUID, FDungeonRulesCustomVersion::LatestVersion, TEXT("DungeonRulesVer"));
@@ -0,0 +1,166 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesDispatch.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/Class.h"
+#include "UObject/ObjectKey.h"
+#include "UObject/UnrealType.h"
+#include "UObject/UObjectGlobals.h"
+
+namespace
+{
+	bool bNativeDispatch = true;
+
+	FAutoConsoleVariableRef CVarDungeonRulesNativeDispatch(
+		TEXT("DungeonRules.NativeDispatch"),
+		bNativeDispatch,
+		TEXT("Call the C++ implementation of conditions, room choosers and event receivers directly when not implemented in Blueprint.\n")
+		TEXT("0: always call them through the reflection system"),
+		ECVF_Default);
+
+	struct FCachedEvent
+	{
+		// Only used to know if the function is stale.
+		TWeakObjectPtr<UFunction> Function;
+		TSharedPtr<const FDungeonRulesEvent> Event;
+	};
+
+	FRWLock EventCacheLock;
+	TMap<TPair<TObjectKey<UClass>, FName>, FCachedEvent> EventCache;
+	FDelegateHandle ReinstancedHandle;
+}
+
+TSharedPtr<const FDungeonRulesEvent> FDungeonRulesDispatch::FindBlueprintEvent(const UClass* Class, FName EventName)
+{
+	if (!Class)
+		return nullptr;
+
+	const TPair<TObjectKey<UClass>, FName> Key(Class, EventName);
+	{
+		// A stale function has been replaced since it has been found, so it is searched again.
+		FReadScopeLock ReadLock(EventCacheLock);
+		const FCachedEvent* Cached = EventCache.Find(Key);
+		if (Cached && (Cached->Function.IsExplicitlyNull() || Cached->Function.IsValid()))
+			return Cached->Event;
+	}
+
+	// The most derived function is the Blueprint one if it is overridden in a Blueprint class.
+	// Otherwise, it is the native declaration of the event (calling the virtual _Implementation).
+	UFunction* Function = Class->FindFunctionByName(EventName);
+	if (Function && Function->HasAnyFunctionFlags(FUNC_Native))
+		Function = nullptr;
+
+	FCachedEvent Cached;
+	Cached.Function = Function;
+	if (Function)
+		Cached.Event = MakeShared<FDungeonRulesEvent>(Function);
+
+	FWriteScopeLock WriteLock(EventCacheLock);
+	EventCache.Add(Key, Cached);
+	return Cached.Event;
+}
+
+void FDungeonRulesDispatch::ClearCache()
+{
+	FWriteScopeLock WriteLock(EventCacheLock);
+	EventCache.Reset();
+}
+
+void FDungeonRulesDispatch::Startup()
+{
+	// Compiling a Blueprint reinstances its class, which may add or remove the overrides of the events.
+	ReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddLambda([](const FCoreUObjectDelegates::FReplacementObjectMap&) { ClearCache(); });
+}
+
+void FDungeonRulesDispatch::Shutdown()
+{
+	FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ReinstancedHandle);
+	ReinstancedHandle.Reset();
+	ClearCache();
+}
+
+bool FDungeonRulesDispatch::IsNativeDispatchEnabled()
+{
+	return bNativeDispatch;
+}
+
+void FDungeonRulesDispatch::SetNativeDispatchEnabled(bool bEnabled)
+{
+	bNativeDispatch = bEnabled;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+FDungeonRulesEvent::FDungeonRulesEvent(UFunction* InFunction)
+	: Function(InFunction)
+{
+	check(Function);
+	ParmsSize = Function->ParmsSize;
+	MinAlignment = Function->GetMinAlignment();
+	for (TFieldIterator<FProperty> It(Function); It && It->HasAnyPropertyFlags(CPF_Parm); ++It)
+	{
+		FParameter Parameter;
+		Parameter.Property = *It;
+		Parameter.Offset = It->GetOffset_ForUFunction();
+		Parameter.Size = It->GetSize();
+
+		if (It->HasAnyPropertyFlags(CPF_ReturnParm))
+			ReturnValue = Parameter;
+		else
+			Parameters.Add(Parameter);
+
+		if (!It->HasAnyPropertyFlags(CPF_ZeroConstructor))
+			PropertiesToInit.Add(*It);
+		if (!It->HasAnyPropertyFlags(CPF_IsPlainOldData | CPF_NoDestructor))
+			PropertiesToDestroy.Add(*It);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+
+FDungeonRulesEventParams::FDungeonRulesEventParams(const FDungeonRulesEvent& InEvent)
+	: Event(InEvent)
+{
+	if (Event.ParmsSize <= InlineSize && Event.MinAlignment <= InlineAlignment)
+		Memory = InlineMemory;
+	else
+		Memory = static_cast<uint8*>(FMemory::Malloc(Event.ParmsSize, Event.MinAlignment));
+
+	FMemory::Memzero(Memory, Event.ParmsSize);
+	for (const FProperty* Property : Event.PropertiesToInit)
+	{
+		Property->InitializeValue_InContainer(Memory);
+	}
+}
+
+FDungeonRulesEventParams::~FDungeonRulesEventParams()
+{
+	for (const FProperty* Property : Event.PropertiesToDestroy)
+	{
+		Property->DestroyValue_InContainer(Memory);
+	}
+
+	if (Memory != InlineMemory)
+		FMemory::Free(Memory);
+}
+
+void FDungeonRulesEventParams::Call(const UObject* Object)
+{
+	const_cast<UObject*>(Object)->ProcessEvent(Event.Function, Memory);
+}
+
+void* FDungeonRulesEventParams::GetParameterPtr(int32 Index, int32 Size) const
+{
+	checkf(Event.Parameters.IsValidIndex(Index) && Event.Parameters[Index].Size == Size, TEXT("Parameter %d does not match the declaration of '%s'."), Index, *Event.Function->GetName());
+	return Memory + Event.Parameters[Index].Offset;
+}
+
+void* FDungeonRulesEventParams::GetReturnValuePtr(int32 Size) const
+{
+	checkf(Event.ReturnValue.Property && Event.ReturnValue.Size == Size, TEXT("Return value does not match the declaration of '%s'."), *Event.Function->GetName());
+	return Memory + Event.ReturnValue.Offset;
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesHeatmap.h"
+#include "DungeonRulesTracer.h"
+
+namespace
+{
+	FDungeonRulesHeatmap::FEntry& FindOrAddEntry(TArray<FDungeonRulesHeatmap::FEntry>& Entries, int32 Index)
+	{
+		if (Index >= Entries.Num())
+			Entries.SetNum(Index + 1);
+		return Entries[Index];
+	}
+
+	void MergeEntries(TArray<FDungeonRulesHeatmap::FEntry>& Entries, const TArray<FDungeonRulesHeatmap::FEntry>& OtherEntries)
+	{
+		if (OtherEntries.Num() > Entries.Num())
+			Entries.SetNum(OtherEntries.Num());
+
+		for (int32 i = 0; i < OtherEntries.Num(); ++i)
+		{
+			Entries[i].Visits += OtherEntries[i].Visits;
+			Entries[i].Passes += OtherEntries[i].Passes;
+			Entries[i].Seconds += OtherEntries[i].Seconds;
+		}
+	}
+
+	FDungeonRulesHeatmap::FEntry GetMax(const TArray<FDungeonRulesHeatmap::FEntry>& Entries)
+	{
+		FDungeonRulesHeatmap::FEntry Max;
+		for (const FDungeonRulesHeatmap::FEntry& Entry : Entries)
+		{
+			Max.Visits = FMath::Max(Max.Visits, Entry.Visits);
+			Max.Passes = FMath::Max(Max.Passes, Entry.Passes);
+			Max.Seconds = FMath::Max(Max.Seconds, Entry.Seconds);
+		}
+		return Max;
+	}
+}
+
+void FDungeonRulesHeatmap::Reset()
+{
+	Rules.Reset();
+	Transitions.Reset();
+	NumRecords = 0;
+}
+
+void FDungeonRulesHeatmap::Add(const FDungeonRulesTraceRecord& Record)
+{
+	++NumRecords;
+	switch (Record.Result)
+	{
+	case EDungeonRulesTraceResult::Start:
+	case EDungeonRulesTraceResult::NextRule:
+		// Stopping the generation is also recorded as a next rule.
+		if (Record.Rule >= 0)
+			++FindOrAddEntry(Rules, Record.Rule).Visits;
+		break;
+	case EDungeonRulesTraceResult::Passed:
+	case EDungeonRulesTraceResult::Failed:
+	{
+		if (Record.Transition < 0)
+			break;
+		FEntry& Transition = FindOrAddEntry(Transitions, Record.Transition);
+		++Transition.Visits;
+		Transition.Passes += (Record.Result == EDungeonRulesTraceResult::Passed) ? 1 : 0;
+		Transition.Seconds += Record.Seconds;
+		if (Record.Rule >= 0)
+			FindOrAddEntry(Rules, Record.Rule).Seconds += Record.Seconds;
+		break;
+	}
+	default:
+		// Not recorded by a tracer (the trace files are validated when loaded).
+		break;
+	}
+}
+
+void FDungeonRulesHeatmap::Add(TConstArrayView<FDungeonRulesTraceRecord> Records)
+{
+	for (const FDungeonRulesTraceRecord& Record : Records)
+	{
+		Add(Record);
+	}
+}
+
+void FDungeonRulesHeatmap::Add(const FDungeonRulesTracer& Tracer)
+{
+	Tracer.ForEachRecord([this](const FDungeonRulesTraceRecord& Record) { Add(Record); });
+}
+
+void FDungeonRulesHeatmap::Merge(const FDungeonRulesHeatmap& Other)
+{
+	MergeEntries(Rules, Other.Rules);
+	MergeEntries(Transitions, Other.Transitions);
+	NumRecords += Other.NumRecords;
+}
+
+FDungeonRulesHeatmap::FEntry FDungeonRulesHeatmap::GetMaxRule() const
+{
+	return GetMax(Rules);
+}
+
+FDungeonRulesHeatmap::FEntry FDungeonRulesHeatmap::GetMaxTransition() const
+{
+	return GetMax(Transitions);
+}
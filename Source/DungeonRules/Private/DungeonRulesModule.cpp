@@ -5,17 +5,20 @@
 
 #include "DungeonRulesModule.h"
 #include "DungeonRulesLog.h"
+#include "DungeonRulesDispatch.h"
 
 #define LOCTEXT_NAMESPACE "FDungeonRulesModule"
 
 void FDungeonRulesModule::StartupModule()
 {
 	RulesLog_Info("DungeonRules Module Startup!");
+	FDungeonRulesDispatch::Startup();
 }
 
 void FDungeonRulesModule::ShutdownModule()
 {
 	RulesLog_Info("DungeonRules Module Shutdown!");
+	FDungeonRulesDispatch::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
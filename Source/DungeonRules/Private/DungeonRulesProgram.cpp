@@ -0,0 +1,322 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesProgram.h"
+#include "DungeonRulesTracer.h"
+#include "DungeonRulesRuntimeState.h"
+#include "RuleTransitionCondition.h"
+#include "DungeonRules.h"
+#include "DungeonRoomChooser.h"
+#include "DungeonRulesSerialization.h"
+#include "Algo/StableSort.h"
+#include "HAL/PlatformTime.h"
+
+void FDungeonRulesProgram::Reset()
+{
+	Rules.Reset();
+	Conduits.Reset();
+	Transitions.Reset();
+	Conditions.Reset();
+	Bytecode.Reset();
+	ConditionCode.Reset();
+	RoomCounters.Reset();
+	GlobalTransitions = FTransitionRange();
+	FirstRule = INDEX_NONE;
+}
+
+void FDungeonRulesProgram::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (FRule& Rule : Rules)
+	{
+		Collector.AddReferencedObject(Rule.Rule);
+		Collector.AddReferencedObject(Rule.RoomChooser);
+	}
+#if WITH_EDITORONLY_DATA
+	for (FTransition& Transition : Transitions)
+	{
+		Collector.AddReferencedObject(Transition.Source);
+	}
+#endif
+	Collector.AddReferencedObjects(Conditions);
+}
+
+void FDungeonRulesProgram::Serialize(FArchive& Ar)
+{
+	using namespace DungeonRulesSerialization;
+
+	int32 NumRules = Rules.Num();
+	Ar << NumRules;
+	if (Ar.IsLoading())
+		Rules.SetNum(NumRules);
+
+	for (FRule& Rule : Rules)
+	{
+		SerializeObject(Ar, Rule.Rule);
+		SerializeObject(Ar, Rule.RoomChooser);
+		Ar << Rule.Transitions;
+	}
+
+	Ar << Conduits;
+	Ar << Transitions;
+	SerializeObjects(Ar, Conditions);
+	Bytecode.Serialize(Ar);
+	Ar << ConditionCode;
+	RoomCounters.Serialize(Ar);
+	Ar << GlobalTransitions;
+	Ar << FirstRule;
+}
+
+uint32 FDungeonRulesProgram::GetLayoutHash() const
+{
+	uint32 Hash = GetTypeHash(FirstRule);
+	Hash = HashCombine(Hash, GetTypeHash(Conditions.Num()));
+	for (const FRule& Rule : Rules)
+	{
+		Hash = HashCombine(Hash, Rule.Rule ? GetTypeHash(Rule.Rule->RuleName) : 0);
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Rule.Transitions.First), GetTypeHash(Rule.Transitions.Num)));
+	}
+	for (const FConduit& Conduit : Conduits)
+	{
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Conduit.Transitions.First), GetTypeHash(Conduit.Transitions.Num)));
+	}
+	for (const FTransition& Transition : Transitions)
+	{
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Transition.Condition), GetTypeHash(Transition.Target)));
+		Hash = HashCombine(Hash, HashCombine(GetTypeHash(Transition.PriorityOrder), GetTypeHash(static_cast<uint8>(Transition.TargetType))));
+	}
+	return HashCombine(Hash, HashCombine(GetTypeHash(GlobalTransitions.First), GetTypeHash(GlobalTransitions.Num)));
+}
+
+int32 FDungeonRulesProgram::GetNextRule(FDungeonRulesRuntimeState& State, const FDungeonRulesEvaluationContext& Context) const
+{
+	const int32 CurrentRule = State.CurrentRule;
+	if (!IsValidRule(CurrentRule))
+		return INDEX_NONE;
+
+	FDungeonRulesTracer* Tracer = State.GetTracer();
+	State.Cache.BeginStep(*this);
+	if (Tracer)
+		Tracer->BeginStep(CurrentRule);
+
+	FDungeonRulesEvaluationContext RulesContext = Context;
+	if (RulesContext.Histogram && !RulesContext.Histogram->HasLayout(RoomCounters))
+		RulesContext.Histogram = nullptr;
+
+	FEvaluationContext StepContext {RulesContext, State.Cache, Tracer};
+	TOptional<int32> NextRule = EvaluateTransitions(Rules[CurrentRule].Transitions, StepContext);
+	if (!NextRule.IsSet())
+		NextRule = EvaluateTransitions(GlobalTransitions, StepContext);
+
+	const int32 Result = NextRule.Get(CurrentRule);
+	if (Tracer)
+		Tracer->EndStep(Result);
+
+	return Result;
+}
+
+TBitArray<> FDungeonRulesProgram::GetReachableRules() const
+{
+	TBitArray<> ReachableRules(false, Rules.Num());
+	if (!IsValidRule(FirstRule))
+		return ReachableRules;
+
+	TBitArray<> ReachableConduits(false, Conduits.Num());
+	TArray<FTransitionRange> PendingRanges;
+
+	// Global transitions can be taken from any rule, so they are reachable as soon as the first rule is.
+	ReachableRules[FirstRule] = true;
+	PendingRanges.Add(Rules[FirstRule].Transitions);
+	PendingRanges.Add(GlobalTransitions);
+
+	while (PendingRanges.Num() > 0)
+	{
+		const FTransitionRange Range = PendingRanges.Pop(/*bAllowShrinking = */false);
+		for (int32 Index = Range.First; Index < Range.First + Range.Num; ++Index)
+		{
+			const FTransition& Transition = Transitions[Index];
+			switch (Transition.TargetType)
+			{
+			case EDungeonRulesNodeType::Rule:
+				if (IsValidRule(Transition.Target) && !ReachableRules[Transition.Target])
+				{
+					ReachableRules[Transition.Target] = true;
+					PendingRanges.Add(Rules[Transition.Target].Transitions);
+				}
+				break;
+			case EDungeonRulesNodeType::Conduit:
+				if (Conduits.IsValidIndex(Transition.Target) && !ReachableConduits[Transition.Target])
+				{
+					ReachableConduits[Transition.Target] = true;
+					PendingRanges.Add(Conduits[Transition.Target].Transitions);
+				}
+				break;
+			default:
+				break;
+			}
+		}
+	}
+
+	return ReachableRules;
+}
+
+void FDungeonRulesProgram::GetNotThreadSafeObjects(TArray<const UObject*>& OutObjects) const
+{
+	for (const FRule& Rule : Rules)
+	{
+		if (Rule.RoomChooser && !Rule.RoomChooser->IsThreadSafe())
+			OutObjects.Add(Rule.RoomChooser);
+	}
+
+	// The conditions are responsible for the ones they contain.
+	for (const URuleTransitionCondition* Condition : Conditions)
+	{
+		if (!Condition->IsThreadSafe())
+			OutObjects.Add(Condition);
+	}
+}
+
+int32 FDungeonRulesProgram::AddCondition(const URuleTransitionCondition* Condition)
+{
+	if (!Condition)
+		return INDEX_NONE;
+
+	return Conditions.AddUnique(Condition);
+}
+
+void FDungeonRulesProgram::CompileConditions()
+{
+	Bytecode.Reset();
+	ConditionCode.Reset(Conditions.Num());
+	for (const URuleTransitionCondition* Condition : Conditions)
+	{
+		ConditionCode.Add(Bytecode.Compile(Condition, *this));
+	}
+}
+
+TOptional<int32> FDungeonRulesProgram::EvaluateTransitions(const FTransitionRange& Range, FEvaluationContext& Context) const
+{
+	// Transitions are sorted by priority, so the first one passing is the best one.
+	for (int32 Index = Range.First; Index < Range.First + Range.Num; ++Index)
+	{
+		if (!CheckTransition(Index, Context))
+			continue;
+
+		const FTransition& Transition = Transitions[Index];
+		switch (Transition.TargetType)
+		{
+		case EDungeonRulesNodeType::Rule:
+			return Transition.Target;
+		case EDungeonRulesNodeType::Conduit:
+			// Already evaluated (and cached) when checking the transition.
+			return EvaluateConduit(Transition.Target, Context).Get(INDEX_NONE);
+		default:
+			return INDEX_NONE;
+		}
+	}
+
+	return TOptional<int32>();
+}
+
+void FDungeonRulesProgram::SortTransitions(const FTransitionRange& Range)
+{
+	// Stable sort to keep the registration order between transitions of same priority.
+	TArrayView<FTransition> RangeView(Transitions.GetData() + Range.First, Range.Num);
+	Algo::StableSortBy(RangeView, &FTransition::PriorityOrder);
+}
+
+TOptional<int32> FDungeonRulesProgram::EvaluateConduit(int32 ConduitIndex, FEvaluationContext& Context) const
+{
+	TOptional<int32> NextRule;
+	if (Context.Cache.FindConduit(ConduitIndex, NextRule))
+		return NextRule;
+
+	// A conduit passes if at least one of its outputs is valid.
+	NextRule = EvaluateTransitions(Conduits[ConduitIndex].Transitions, Context);
+	Context.Cache.AddConduit(ConduitIndex, NextRule);
+	return NextRule;
+}
+
+bool FDungeonRulesProgram::CheckTransition(int32 TransitionIndex, FEvaluationContext& Context) const
+{
+	const FTransition& Transition = Transitions[TransitionIndex];
+	const double StartTime = Context.Tracer ? FPlatformTime::Seconds() : 0.0;
+
+	// If the next state has a condition and is not fulfilled, then we can't go into it.
+	// If this transition has no condition, then it goes always to the next state.
+	const bool bPassed = (Transition.TargetType != EDungeonRulesNodeType::Conduit || EvaluateConduit(Transition.Target, Context).IsSet())
+		&& (Transition.Condition == INDEX_NONE || CheckCondition(Transition.Condition, Context));
+
+	if (Context.Tracer)
+		Context.Tracer->RecordTransition(TransitionIndex, bPassed, static_cast<float>(FPlatformTime::Seconds() - StartTime));
+
+	return bPassed;
+}
+
+bool FDungeonRulesProgram::CheckCondition(int32 ConditionIndex, FEvaluationContext& Context) const
+{
+	bool bResult = false;
+	if (Context.Cache.FindCondition(ConditionIndex, bResult))
+		return bResult;
+
+	bResult = Context.Rules.Histogram
+		? Bytecode.Evaluate(ConditionCode[ConditionIndex], Context.Rules)
+		: Conditions[ConditionIndex]->DispatchCheck(Context.Rules);
+	Context.Cache.AddCondition(ConditionIndex, bResult);
+	return bResult;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void FDungeonRulesEvaluationCache::Reset(const FDungeonRulesProgram& Program)
+{
+	// Keeps the allocated memory when the sizes don't change.
+	ConditionEpochs.Init(0, Program.Conditions.Num());
+	ConditionResults.SetNumUninitialized(Program.Conditions.Num());
+	ConduitEpochs.Init(0, Program.Conduits.Num());
+	ConduitResults.SetNum(Program.Conduits.Num());
+	Epoch = 0;
+}
+
+void FDungeonRulesEvaluationCache::BeginStep(const FDungeonRulesProgram& Program)
+{
+	const bool bProgramChanged = ConditionEpochs.Num() != Program.Conditions.Num()
+		|| ConduitEpochs.Num() != Program.Conduits.Num();
+
+	// When the epoch wraps around, old epochs could be mistaken for the current one.
+	if (bProgramChanged || Epoch == MAX_uint32)
+		Reset(Program);
+
+	++Epoch;
+}
+
+bool FDungeonRulesEvaluationCache::FindCondition(int32 ConditionIndex, bool& OutResult) const
+{
+	if (ConditionEpochs[ConditionIndex] != Epoch)
+		return false;
+
+	OutResult = ConditionResults[ConditionIndex];
+	return true;
+}
+
+void FDungeonRulesEvaluationCache::AddCondition(int32 ConditionIndex, bool Result)
+{
+	ConditionEpochs[ConditionIndex] = Epoch;
+	ConditionResults[ConditionIndex] = Result;
+}
+
+bool FDungeonRulesEvaluationCache::FindConduit(int32 ConduitIndex, TOptional<int32>& OutResult) const
+{
+	if (ConduitEpochs[ConduitIndex] != Epoch)
+		return false;
+
+	OutResult = ConduitResults[ConduitIndex];
+	return true;
+}
+
+void FDungeonRulesEvaluationCache::AddConduit(int32 ConduitIndex, const TOptional<int32>& Result)
+{
+	ConduitEpochs[ConduitIndex] = Epoch;
+	ConduitResults[ConduitIndex] = Result;
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesRuntimeState.h"
+
+void FDungeonRulesRuntimeState::Reset(const FDungeonRulesProgram& Program)
+{
+	CurrentRule = Program.FirstRule;
+	AbortingValidator = nullptr;
+	AddedRooms.Reset();
+	Cache.Reset(Program);
+	Histogram.Reset(Program.RoomCounters);
+	if (Tracer.IsEnabled())
+		Tracer.BeginGeneration(CurrentRule);
+}
+
+FDungeonRulesEvaluationContext FDungeonRulesRuntimeState::MakeContext(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FRandomStream* Random) const
+{
+	FDungeonRulesEvaluationContext Context;
+	Context.Generator = Generator;
+	Context.PreviousRoom = PreviousRoom;
+	Context.Histogram = &Histogram;
+	Context.Random = Random;
+	return Context;
+}
@@ -0,0 +1,36 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/Archive.h"
+
+// Helpers to serialize the const object pointers of the compiled program.
+namespace DungeonRulesSerialization
+{
+	template<typename T>
+	void SerializeObject(FArchive& Ar, const T*& Object)
+	{
+		UObject* Ptr = const_cast<T*>(Object);
+		Ar << Ptr;
+		if (Ar.IsLoading())
+			Object = Cast<T>(Ptr);
+	}
+
+	template<typename T>
+	void SerializeObjects(FArchive& Ar, TArray<const T*>& Objects)
+	{
+		int32 Num = Objects.Num();
+		Ar << Num;
+		if (Ar.IsLoading())
+			Objects.SetNum(Num);
+
+		for (const T*& Object : Objects)
+		{
+			SerializeObject(Ar, Object);
+		}
+	}
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesSimulationCommandlet.h"
+#include "DungeonRules.h"
+#include "DungeonRulesSimulator.h"
+#include "DungeonRulesLog.h"
+#include "Misc/FileHelper.h"
+
+UDungeonRulesSimulationCommandlet::UDungeonRulesSimulationCommandlet()
+	: Super()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UDungeonRulesSimulationCommandlet::Main(const FString& Params)
+{
+	FString RulesPath;
+	if (!FParse::Value(*Params, TEXT("Rules="), RulesPath))
+	{
+		RulesLog_Error("Missing -Rules=<AssetPath> argument.");
+		return 1;
+	}
+
+	UDungeonRules* Rules = LoadObject<UDungeonRules>(nullptr, *RulesPath);
+	if (!Rules)
+	{
+		RulesLog_Error("Can't load the dungeon rules '%s'.", *RulesPath);
+		return 1;
+	}
+
+	FDungeonSimulationSettings Settings;
+	FParse::Value(*Params, TEXT("Seeds="), Settings.NumSeeds);
+	FParse::Value(*Params, TEXT("FirstSeed="), Settings.FirstSeed);
+	FParse::Value(*Params, TEXT("MaxRooms="), Settings.MaxRooms);
+	Settings.bParallel = !FParse::Param(*Params, TEXT("Serial"));
+
+	FString CsvPath;
+	const bool bWriteCsv = FParse::Value(*Params, TEXT("Csv="), CsvPath);
+
+	// The room choosers can't choose room data which are not loaded.
+	Rules->LoadRoomData();
+
+	const FDungeonRulesSimulator Simulator(Rules->GetProgram());
+	if (!Simulator.IsThreadSafe())
+	{
+		// The validators are not used by the simulation, only the room choosers and conditions matter.
+		TArray<const UObject*> NotThreadSafeObjects;
+		Rules->GetProgram().GetNotThreadSafeObjects(NotThreadSafeObjects);
+		for (const UObject* Object : NotThreadSafeObjects)
+		{
+			RulesLog_Warning("'%s' is not thread safe.", *GetNameSafe(Object));
+		}
+	}
+
+	TArray<FDungeonSimulationResult> Results;
+	const FDungeonSimulationStats Stats = Simulator.Run(Settings, bWriteCsv ? &Results : nullptr);
+
+	RulesLog_Info("Simulation of '%s' (%s):", *Rules->GetName(), Simulator.IsThreadSafe() && Settings.bParallel ? TEXT("parallel") : TEXT("serial"));
+	Stats.Dump(*GLog, &Rules->GetProgram());
+
+	if (bWriteCsv)
+	{
+		TArray<FString> Lines;
+		Lines.Reserve(Results.Num() + 1);
+		Lines.Add(TEXT("Seed,Rooms,DiscardedRooms,End"));
+		for (const FDungeonSimulationResult& Result : Results)
+		{
+			Lines.Add(FString::Printf(TEXT("%d,%d,%d,%s"), Result.Seed, Result.NumRooms, Result.NumFailedRooms, FDungeonRulesSimulator::GetEndName(Result.End)));
+		}
+
+		if (!FFileHelper::SaveStringArrayToFile(Lines, *CsvPath))
+		{
+			RulesLog_Error("Can't write the simulation results in '%s'.", *CsvPath);
+			return 1;
+		}
+		RulesLog_Info("Simulation results saved in '%s'.", *CsvPath);
+	}
+
+	Rules->ReleaseRoomData();
+	return 0;
+}
@@ -0,0 +1,25 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "DungeonRulesSimulationCommandlet.generated.h"
+
+// Simulates a dungeon rules asset on many seeds without spawning anything, and logs aggregated statistics.
+// Usage: UnrealEditor-Cmd <Project> -run=DungeonRulesSimulation -Rules=<AssetPath> [-Seeds=1000] [-FirstSeed=0] [-MaxRooms=500] [-Serial] [-Csv=<FilePath>]
+UCLASS()
+class UDungeonRulesSimulationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UDungeonRulesSimulationCommandlet();
+
+	//~ Begin UCommandlet Interface
+	virtual int32 Main(const FString& Params) override;
+	//~ End UCommandlet Interface
+};
@@ -0,0 +1,459 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesSimulator.h"
+#include "DungeonRules.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonRulesEvaluationContext.h"
+#include "DungeonRoomChooser.h"
+#include "DungeonRulesLog.h"
+#include "RoomData.h"
+#include "Async/ParallelFor.h"
+#include "HAL/PlatformTime.h"
+#include <atomic>
+
+namespace
+{
+	// Rotates a cell of a room by a number of quarter turns (North is +X, East is +Y).
+	FIntVector RotateCell(const FIntVector& Cell, uint8 Rotation)
+	{
+		switch (Rotation & 3)
+		{
+		case 1:
+			return FIntVector(-Cell.Y, Cell.X, Cell.Z);
+		case 2:
+			return FIntVector(-Cell.X, -Cell.Y, Cell.Z);
+		case 3:
+			return FIntVector(Cell.Y, -Cell.X, Cell.Z);
+		default:
+			return Cell;
+		}
+	}
+
+	FORCEINLINE uint8 GetDirection(const FDoorDef& Door)
+	{
+		return static_cast<uint8>(Door.Direction) & 3;
+	}
+
+	// Cell in front of a door facing the direction.
+	FORCEINLINE FIntVector GetFacingCell(const FIntVector& Cell, uint8 Direction)
+	{
+		return Cell + RotateCell(FIntVector(1, 0, 0), Direction);
+	}
+
+	// Computes the cells occupied by a room, the bounds of the room data being exclusive on the second point.
+	void GetRoomBounds(const URoomData* RoomData, const FIntVector& Location, uint8 Rotation, FIntVector& OutMin, FIntVector& OutMax)
+	{
+		const FIntVector& First = RoomData->FirstPoint;
+		const FIntVector& Second = RoomData->SecondPoint;
+		const FIntVector LocalMin(FMath::Min(First.X, Second.X), FMath::Min(First.Y, Second.Y), FMath::Min(First.Z, Second.Z));
+		const FIntVector LocalMax(FMath::Max(First.X, Second.X) - 1, FMath::Max(First.Y, Second.Y) - 1, FMath::Max(First.Z, Second.Z) - 1);
+		const FIntVector A = Location + RotateCell(LocalMin, Rotation);
+		const FIntVector B = Location + RotateCell(LocalMax, Rotation);
+		OutMin = FIntVector(FMath::Min(A.X, B.X), FMath::Min(A.Y, B.Y), FMath::Min(A.Z, B.Z));
+		OutMax = FIntVector(FMath::Max(A.X, B.X), FMath::Max(A.Y, B.Y), FMath::Max(A.Z, B.Z));
+	}
+
+	// Number of seeds simulated by each task, so each task reuses its state and layout for several seeds.
+	constexpr int32 SeedsPerTask = 32;
+
+	// A room chooser or a transition drawing more numbers than that is not replayed.
+	constexpr int32 MaxRecordedDraws = 1024;
+
+	// Number of numbers drawn from the stream since it was at the seed, INDEX_NONE when too many.
+	int32 CountDraws(int32 SeedBefore, const FRandomStream& Random)
+	{
+		const FRandomStream Before(SeedBefore);
+		for (int32 NumDraws = 0; NumDraws <= MaxRecordedDraws; ++NumDraws)
+		{
+			if (Before.GetCurrentSeed() == Random.GetCurrentSeed())
+				return NumDraws;
+			Before.GetUnsignedInt();
+		}
+		return INDEX_NONE;
+	}
+}
+
+void FDungeonSimulatedLayout::Reset()
+{
+	Rooms.Reset();
+	Choices.Reset();
+	NumFailedRooms = 0;
+	End = EDungeonSimulationEnd::Failed;
+}
+
+bool FDungeonSimulatedLayout::Overlaps(const FIntVector& BoundsMin, const FIntVector& BoundsMax) const
+{
+	for (const FDungeonSimulatedRoom& Room : Rooms)
+	{
+		if (BoundsMin.X <= Room.BoundsMax.X && Room.BoundsMin.X <= BoundsMax.X
+			&& BoundsMin.Y <= Room.BoundsMax.Y && Room.BoundsMin.Y <= BoundsMax.Y
+			&& BoundsMin.Z <= Room.BoundsMax.Z && Room.BoundsMin.Z <= BoundsMax.Z)
+			return true;
+	}
+	return false;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+void FDungeonSimulationStats::Add(const FDungeonSimulatedLayout& Layout)
+{
+	const int32 NumRooms = Layout.Rooms.Num();
+	++NumGenerations;
+	MinRooms = FMath::Min(MinRooms, NumRooms);
+	MaxRooms = FMath::Max(MaxRooms, NumRooms);
+	TotalRooms += NumRooms;
+	TotalFailedRooms += Layout.NumFailedRooms;
+	++Ends[static_cast<uint8>(Layout.End)];
+
+	for (const FDungeonSimulatedRoom& Room : Layout.Rooms)
+	{
+		if (Room.Rule >= RuleRooms.Num())
+			RuleRooms.SetNumZeroed(Room.Rule + 1);
+		if (Room.Rule >= 0)
+			++RuleRooms[Room.Rule];
+		++RoomDataRooms.FindOrAdd(Room.RoomData, 0);
+	}
+}
+
+void FDungeonSimulationStats::Merge(const FDungeonSimulationStats& Other)
+{
+	NumGenerations += Other.NumGenerations;
+	MinRooms = FMath::Min(MinRooms, Other.MinRooms);
+	MaxRooms = FMath::Max(MaxRooms, Other.MaxRooms);
+	TotalRooms += Other.TotalRooms;
+	TotalFailedRooms += Other.TotalFailedRooms;
+	for (int32 i = 0; i < UE_ARRAY_COUNT(Ends); ++i)
+	{
+		Ends[i] += Other.Ends[i];
+	}
+
+	if (Other.RuleRooms.Num() > RuleRooms.Num())
+		RuleRooms.SetNumZeroed(Other.RuleRooms.Num());
+	for (int32 i = 0; i < Other.RuleRooms.Num(); ++i)
+	{
+		RuleRooms[i] += Other.RuleRooms[i];
+	}
+
+	for (const auto& Pair : Other.RoomDataRooms)
+	{
+		RoomDataRooms.FindOrAdd(Pair.Key, 0) += Pair.Value;
+	}
+}
+
+void FDungeonSimulationStats::Dump(FOutputDevice& Output, const FDungeonRulesProgram* Program) const
+{
+	Output.Logf(TEXT("Simulated %d dungeons in %.3f seconds."), NumGenerations, Seconds);
+	if (NumGenerations <= 0)
+		return;
+
+	Output.Logf(TEXT("Rooms: min %d, max %d, average %.2f (%.2f discarded by generation)."), MinRooms, MaxRooms, GetAverageRooms(), static_cast<double>(TotalFailedRooms) / NumGenerations);
+	for (int32 i = 0; i < UE_ARRAY_COUNT(Ends); ++i)
+	{
+		const EDungeonSimulationEnd End = static_cast<EDungeonSimulationEnd>(i);
+		Output.Logf(TEXT("  %s: %d (%.1f%%)"), FDungeonRulesSimulator::GetEndName(End), Ends[i], 100.0 * Ends[i] / NumGenerations);
+	}
+
+	Output.Logf(TEXT("Average rooms by rule:"));
+	for (int32 i = 0; i < RuleRooms.Num(); ++i)
+	{
+		const bool bHasName = Program && Program->IsValidRule(i) && Program->Rules[i].Rule;
+		const FString RuleName = bHasName ? Program->Rules[i].Rule->RuleName : FString::Printf(TEXT("#%d"), i);
+		Output.Logf(TEXT("  '%s': %.2f"), *RuleName, static_cast<double>(RuleRooms[i]) / NumGenerations);
+	}
+
+	Output.Logf(TEXT("Average rooms by room data:"));
+	for (const auto& Pair : RoomDataRooms)
+	{
+		Output.Logf(TEXT("  '%s': %.2f"), *GetNameSafe(Pair.Key), static_cast<double>(Pair.Value) / NumGenerations);
+	}
+}
+
+//////////////////////////////////////////////////////////////////////
+
+FDungeonRulesSimulator::FDungeonRulesSimulator(const FDungeonRulesProgram& InProgram)
+	: Program(InProgram)
+{
+	TArray<const UObject*> NotThreadSafeObjects;
+	Program.GetNotThreadSafeObjects(NotThreadSafeObjects);
+	bThreadSafe = NotThreadSafeObjects.Num() == 0;
+}
+
+bool FDungeonRulesSimulator::Simulate(int32 Seed, int32 MaxRooms, FDungeonRulesRuntimeState& State, FDungeonSimulatedLayout& OutLayout) const
+{
+	FDungeonSimulationCursor Cursor;
+	if (!Begin(Seed, State, OutLayout, Cursor))
+		return false;
+
+	Step(MaxRooms, TNumericLimits<double>::Max(), State, OutLayout, Cursor);
+	return true;
+}
+
+bool FDungeonRulesSimulator::Begin(int32 Seed, FDungeonRulesRuntimeState& State, FDungeonSimulatedLayout& OutLayout, FDungeonSimulationCursor& OutCursor) const
+{
+	check(bThreadSafe || IsInGameThread());
+
+	OutLayout.Reset();
+	State.Reset(Program);
+	OutCursor.Random.Initialize(Seed);
+	OutCursor.RoomIndex = 0;
+	OutCursor.Door = 0;
+	OutCursor.bFinished = true;
+
+	if (!Program.IsValidRule(State.CurrentRule) || !IsValid(Program.Rules[State.CurrentRule].RoomChooser))
+		return false;
+
+	const FRandomStream& Random = OutCursor.Random;
+	FDungeonSimulatedChoice& Choice = OutLayout.Choices.AddDefaulted_GetRef();
+	Choice.Rule = State.CurrentRule;
+	Choice.RandomBefore = Random.GetCurrentSeed();
+	URoomData* FirstRoom = Program.Rules[State.CurrentRule].RoomChooser->DispatchChooseFirstRoomData(State.MakeContext(nullptr, nullptr, &Random));
+	Choice.RoomData = FirstRoom;
+	Choice.NumChooserDraws = CountDraws(Choice.RandomBefore, Random);
+	Choice.bPlaced = IsValid(FirstRoom);
+	if (!Choice.bPlaced)
+		return false;
+
+	AddRoom(OutLayout, FirstRoom, State.CurrentRule, FIntVector::ZeroValue, 0);
+	State.Histogram.AddRoom(FirstRoom);
+	const int32 RandomBeforeRules = Random.GetCurrentSeed();
+	State.CurrentRule = Program.GetNextRule(State, State.MakeContext(nullptr, nullptr, &Random));
+	Choice.NextRule = State.CurrentRule;
+	Choice.NumRuleDraws = CountDraws(RandomBeforeRules, Random);
+	OutCursor.bFinished = false;
+	return true;
+}
+
+bool FDungeonRulesSimulator::Step(int32 MaxRooms, double Deadline, FDungeonRulesRuntimeState& State, FDungeonSimulatedLayout& Layout, FDungeonSimulationCursor& Cursor) const
+{
+	check(bThreadSafe || IsInGameThread());
+	if (Cursor.bFinished)
+		return true;
+
+	const bool bHasDeadline = Deadline < TNumericLimits<double>::Max();
+	const FRandomStream& Random = Cursor.Random;
+
+	// Same as the generator: the doors of a room are all tried before the doors of the next room.
+	while (Cursor.RoomIndex < Layout.Rooms.Num())
+	{
+		if (Cursor.Door >= Layout.Rooms[Cursor.RoomIndex].Connections.Num())
+		{
+			++Cursor.RoomIndex;
+			Cursor.Door = 0;
+			continue;
+		}
+
+		if (!Program.IsValidRule(State.CurrentRule))
+		{
+			Layout.End = EDungeonSimulationEnd::Stopped;
+			Cursor.bFinished = true;
+			return true;
+		}
+
+		if (Layout.Rooms.Num() >= MaxRooms)
+		{
+			Layout.End = EDungeonSimulationEnd::MaxRooms;
+			Cursor.bFinished = true;
+			return true;
+		}
+
+		// The room array may grow, so the room is not kept between the iterations.
+		const int32 RoomIndex = Cursor.RoomIndex;
+		const int32 Door = Cursor.Door++;
+		const FDungeonSimulatedRoom& Room = Layout.Rooms[RoomIndex];
+		if (Room.Connections[Door] != INDEX_NONE)
+			continue;
+
+		const UDungeonRoomChooser* RoomChooser = Program.Rules[State.CurrentRule].RoomChooser;
+		const int32 RandomBefore = Random.GetCurrentSeed();
+		int DoorIndex = INDEX_NONE;
+		URoomData* NextRoom = IsValid(RoomChooser) ? RoomChooser->DispatchChooseNextRoomData(State.MakeContext(nullptr, nullptr, &Random), Room.RoomData->Doors[Door], DoorIndex) : nullptr;
+
+		// The choice is filled once the room is placed, since placing it may grow the room array.
+		FDungeonSimulatedChoice Choice;
+		Choice.ParentRoom = Room.RoomData;
+		Choice.ParentDoor = Door;
+		Choice.ParentIndex = RoomIndex;
+		Choice.RoomData = NextRoom;
+		Choice.Rule = State.CurrentRule;
+		Choice.NumRooms = Layout.Rooms.Num();
+		Choice.RandomBefore = RandomBefore;
+		Choice.NumChooserDraws = CountDraws(RandomBefore, Random);
+		Choice.bPlaced = IsValid(NextRoom) && TryConnectRoom(Layout, RoomIndex, Door, NextRoom, State.CurrentRule, DoorIndex, Random);
+		Choice.DoorIndex = DoorIndex;
+		if (Choice.bPlaced)
+		{
+			State.Histogram.AddRoom(NextRoom);
+			const int32 RandomBeforeRules = Random.GetCurrentSeed();
+			State.CurrentRule = Program.GetNextRule(State, State.MakeContext(nullptr, nullptr, &Random));
+			Choice.NextRule = State.CurrentRule;
+			Choice.NumRuleDraws = CountDraws(RandomBeforeRules, Random);
+		}
+		else
+		{
+			++Layout.NumFailedRooms;
+		}
+		Layout.Choices.Add(Choice);
+
+		// At least one door is processed by each step, so the simulation always progresses.
+		if (bHasDeadline && FPlatformTime::Seconds() >= Deadline)
+			return false;
+	}
+
+	Layout.End = Program.IsValidRule(State.CurrentRule) ? EDungeonSimulationEnd::NoMoreDoors : EDungeonSimulationEnd::Stopped;
+	Cursor.bFinished = true;
+	return true;
+}
+
+FDungeonSimulationStats FDungeonRulesSimulator::Run(const FDungeonSimulationSettings& Settings, TArray<FDungeonSimulationResult>* OutResults) const
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumSeeds = FMath::Max(0, Settings.NumSeeds);
+	const int32 NumTasks = FMath::DivideAndRoundUp(NumSeeds, SeedsPerTask);
+
+	if (OutResults)
+		OutResults->SetNum(NumSeeds);
+
+	// Each task has its own state, layout and stats, merged once all the tasks are done.
+	TArray<FDungeonSimulationStats> TaskStats;
+	TaskStats.SetNum(NumTasks);
+	auto RunTask = [&](int32 TaskIndex)
+	{
+		FDungeonRulesRuntimeState State;
+		FDungeonSimulatedLayout Layout;
+		const int32 FirstIndex = TaskIndex * SeedsPerTask;
+		const int32 LastIndex = FMath::Min(FirstIndex + SeedsPerTask, NumSeeds);
+		for (int32 Index = FirstIndex; Index < LastIndex; ++Index)
+		{
+			const int32 Seed = Settings.FirstSeed + Index;
+			Simulate(Seed, Settings.MaxRooms, State, Layout);
+			TaskStats[TaskIndex].Add(Layout);
+
+			if (OutResults)
+			{
+				FDungeonSimulationResult& Result = (*OutResults)[Index];
+				Result.Seed = Seed;
+				Result.NumRooms = Layout.Rooms.Num();
+				Result.NumFailedRooms = Layout.NumFailedRooms;
+				Result.End = Layout.End;
+			}
+		}
+	};
+
+	const bool bParallel = Settings.bParallel && bThreadSafe;
+	if (Settings.bParallel && !bThreadSafe)
+		RulesLog_Warning("The dungeon rules are not thread safe, the seeds are simulated on the game thread only.");
+
+	ParallelFor(NumTasks, RunTask, !bParallel);
+
+	FDungeonSimulationStats Stats;
+	for (const FDungeonSimulationStats& Task : TaskStats)
+	{
+		Stats.Merge(Task);
+	}
+	Stats.Seconds = FPlatformTime::Seconds() - StartTime;
+	return Stats;
+}
+
+int32 FDungeonRulesSimulator::FindFirstValidSeed(TConstArrayView<int32> Seeds, int32 MaxRooms, TFunctionRef<bool(const FDungeonSimulatedLayout&)> IsLayoutValid, FDungeonSimulatedLayout& OutLayout) const
+{
+	// Lowest index of the accepted candidates, so the winner does not depend on the order the tasks are run.
+	std::atomic<int32> Winner {Seeds.Num()};
+	TArray<FDungeonSimulatedLayout> Layouts;
+	Layouts.SetNum(Seeds.Num());
+
+	ParallelFor(Seeds.Num(), [&](int32 Index)
+	{
+		if (Index > Winner.load())
+			return;
+
+		FDungeonRulesRuntimeState State;
+		FDungeonSimulatedLayout& Layout = Layouts[Index];
+		if (!Simulate(Seeds[Index], MaxRooms, State, Layout) || Layout.End == EDungeonSimulationEnd::MaxRooms)
+			return;
+
+		if (!IsLayoutValid(Layout))
+			return;
+
+		int32 Current = Winner.load();
+		while (Index < Current && !Winner.compare_exchange_weak(Current, Index))
+		{
+		}
+	}, !bThreadSafe);
+
+	const int32 Result = Winner.load();
+	if (Result >= Seeds.Num())
+		return INDEX_NONE;
+
+	OutLayout = MoveTemp(Layouts[Result]);
+	return Result;
+}
+
+const TCHAR* FDungeonRulesSimulator::GetEndName(EDungeonSimulationEnd End)
+{
+	switch (End)
+	{
+	case EDungeonSimulationEnd::Stopped:
+		return TEXT("Stopped");
+	case EDungeonSimulationEnd::NoMoreDoors:
+		return TEXT("NoMoreDoors");
+	case EDungeonSimulationEnd::MaxRooms:
+		return TEXT("MaxRooms");
+	case EDungeonSimulationEnd::Failed:
+		return TEXT("Failed");
+	default:
+		checkNoEntry();
+		return TEXT("Unknown");
+	}
+}
+
+void FDungeonRulesSimulator::AddRoom(FDungeonSimulatedLayout& Layout, const URoomData* RoomData, int32 Rule, const FIntVector& Location, uint8 Rotation) const
+{
+	FDungeonSimulatedRoom& Room = Layout.Rooms.AddDefaulted_GetRef();
+	Room.RoomData = RoomData;
+	Room.Rule = Rule;
+	Room.Location = Location;
+	Room.Rotation = Rotation & 3;
+	GetRoomBounds(RoomData, Location, Rotation, Room.BoundsMin, Room.BoundsMax);
+	Room.Connections.Init(INDEX_NONE, RoomData->Doors.Num());
+}
+
+bool FDungeonRulesSimulator::TryConnectRoom(FDungeonSimulatedLayout& Layout, int32 ParentIndex, int32 ParentDoor, const URoomData* RoomData, int32 Rule, int32& DoorIndex, const FRandomStream& Random) const
+{
+	const FDungeonSimulatedRoom& Parent = Layout.Rooms[ParentIndex];
+	const FDoorDef& FromDoor = Parent.RoomData->Doors[ParentDoor];
+
+	if (!RoomData->Doors.IsValidIndex(DoorIndex))
+	{
+		TArray<int32, TInlineAllocator<8>> CompatibleDoors;
+		for (int32 i = 0; i < RoomData->Doors.Num(); ++i)
+		{
+			if (FDoorDef::AreCompatible(FromDoor, RoomData->Doors[i]))
+				CompatibleDoors.Add(i);
+		}
+
+		if (CompatibleDoors.Num() <= 0)
+			return false;
+		DoorIndex = CompatibleDoors[Random.RandRange(0, CompatibleDoors.Num() - 1)];
+	}
+
+	// The door of the new room is in the cell facing the door of the parent, and looks at it.
+	const FDoorDef& ToDoor = RoomData->Doors[DoorIndex];
+	const uint8 FromDirection = (GetDirection(FromDoor) + Parent.Rotation) & 3;
+	const FIntVector FromCell = Parent.Location + RotateCell(FromDoor.Position, Parent.Rotation);
+	const uint8 Rotation = (FromDirection + 2 - GetDirection(ToDoor) + 4) & 3;
+	const FIntVector Location = GetFacingCell(FromCell, FromDirection) - RotateCell(ToDoor.Position, Rotation);
+
+	FIntVector BoundsMin, BoundsMax;
+	GetRoomBounds(RoomData, Location, Rotation, BoundsMin, BoundsMax);
+	if (Layout.Overlaps(BoundsMin, BoundsMax))
+		return false;
+
+	const int32 NewIndex = Layout.Rooms.Num();
+	AddRoom(Layout, RoomData, Rule, Location, Rotation);
+	Layout.Rooms[NewIndex].Connections[DoorIndex] = ParentIndex;
+	Layout.Rooms[ParentIndex].Connections[ParentDoor] = NewIndex;
+	return true;
+}
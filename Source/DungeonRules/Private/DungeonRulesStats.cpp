@@ -0,0 +1,22 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesStats.h"
+
+DEFINE_STAT(STAT_DungeonRules_GetFirstRoomData);
+DEFINE_STAT(STAT_DungeonRules_GetNextRoomData);
+DEFINE_STAT(STAT_DungeonRules_GetNextRule);
+DEFINE_STAT(STAT_DungeonRules_IsDungeonValid);
+DEFINE_STAT(STAT_DungeonRules_CanStillBeValid);
+DEFINE_STAT(STAT_DungeonRules_InitializeDungeon);
+DEFINE_STAT(STAT_DungeonRules_OnPreGeneration);
+DEFINE_STAT(STAT_DungeonRules_OnPostGeneration);
+DEFINE_STAT(STAT_DungeonRules_OnGenerationInit);
+DEFINE_STAT(STAT_DungeonRules_OnGenerationFailed);
+DEFINE_STAT(STAT_DungeonRules_OnRoomAdded);
+DEFINE_STAT(STAT_DungeonRules_OnFailedToAddRoom);
+DEFINE_STAT(STAT_DungeonRules_OnRoomsAdded);
+
+UE_TRACE_CHANNEL_DEFINE(DungeonRulesChannel);
@@ -0,0 +1,322 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesTracer.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonRules.h"
+#include "DungeonRulesLog.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Serialization/Archive.h"
+
+static TAutoConsoleVariable<int32> CVarDungeonRulesTrace(
+	TEXT("DungeonRules.Trace"),
+	0,
+	TEXT("Number of rule decisions kept by each generator with rules (rounded up to a power of two).\n")
+	TEXT("0: disabled (default)"),
+	ECVF_Default);
+
+namespace
+{
+	static constexpr uint32 TraceFileMagic = 0x54524744; // 'DGRT'
+
+	// Versions of the trace files.
+	// The files older than TraceFileVersion_Identity can't be matched with a rules asset, so they are not loaded anymore.
+	static constexpr uint32 TraceFileVersion_Initial = 1;
+	static constexpr uint32 TraceFileVersion_Seconds = 2;
+	static constexpr uint32 TraceFileVersion_Identity = 3;
+	static constexpr uint32 TraceFileVersion = TraceFileVersion_Identity;
+
+	const TCHAR* GetResultName(EDungeonRulesTraceResult Result)
+	{
+		switch (Result)
+		{
+		case EDungeonRulesTraceResult::Failed:
+			return TEXT("Failed");
+		case EDungeonRulesTraceResult::Passed:
+			return TEXT("Passed");
+		case EDungeonRulesTraceResult::NextRule:
+			return TEXT("Next Rule");
+		case EDungeonRulesTraceResult::Start:
+			return TEXT("Start");
+		default:
+			return TEXT("Unknown");
+		}
+	}
+
+	// True when the record can have been recorded by the program.
+	bool IsValidRecord(const FDungeonRulesTraceRecord& Record, const FDungeonRulesProgram& Program)
+	{
+		if (!FMath::IsFinite(Record.Seconds) || Record.Seconds < 0.0f)
+			return false;
+		if (Record.Rule != INDEX_NONE && !Program.IsValidRule(Record.Rule))
+			return false;
+
+		switch (Record.Result)
+		{
+		case EDungeonRulesTraceResult::Failed:
+		case EDungeonRulesTraceResult::Passed:
+			return Program.Transitions.IsValidIndex(Record.Transition);
+		case EDungeonRulesTraceResult::NextRule:
+		case EDungeonRulesTraceResult::Start:
+			return Record.Transition == INDEX_NONE;
+		default:
+			return false;
+		}
+	}
+
+	FString GetRuleName(const FDungeonRulesProgram* Program, int32 RuleIndex)
+	{
+		if (RuleIndex == INDEX_NONE)
+			return TEXT("<Stop>");
+		if (!Program || !Program->IsValidRule(RuleIndex))
+			return FString::Printf(TEXT("#%d"), RuleIndex);
+		return Program->Rules[RuleIndex].Rule->RuleName;
+	}
+
+	FString GetTransitionName(const FDungeonRulesProgram* Program, int32 TransitionIndex)
+	{
+		if (!Program || !Program->Transitions.IsValidIndex(TransitionIndex))
+			return FString::Printf(TEXT("#%d"), TransitionIndex);
+
+		const FDungeonRulesProgram::FTransition& Transition = Program->Transitions[TransitionIndex];
+		switch (Transition.TargetType)
+		{
+		case EDungeonRulesNodeType::Rule:
+			return FString::Printf(TEXT("#%d to '%s'"), TransitionIndex, *GetRuleName(Program, Transition.Target));
+		case EDungeonRulesNodeType::Conduit:
+			return FString::Printf(TEXT("#%d to conduit #%d"), TransitionIndex, Transition.Target);
+		default:
+			return FString::Printf(TEXT("#%d to <Stop>"), TransitionIndex);
+		}
+	}
+}
+
+static void SerializeRecord(FArchive& Ar, FDungeonRulesTraceRecord& Record, uint32 Version)
+{
+	Ar << Record.Step;
+	Ar << Record.Rule;
+	Ar << Record.Transition;
+	Ar << Record.Result;
+	if (Version >= TraceFileVersion_Seconds)
+		Ar << Record.Seconds;
+}
+
+// Writes the string as UTF-8, preceded by its length in bytes.
+static void WriteString(FArchive& Ar, const FString& String)
+{
+	FTCHARToUTF8 Utf8(*String);
+	int32 Length = Utf8.Length();
+	Ar << Length;
+	Ar.Serialize(const_cast<UTF8CHAR*>(Utf8.Get()), Length);
+}
+
+// Reads a string written by WriteString, failing when its length exceeds the remaining size of the archive.
+static bool ReadString(FArchive& Ar, FString& OutString)
+{
+	int32 Length = 0;
+	Ar << Length;
+	if (Ar.IsError() || Length < 0 || Length > Ar.TotalSize() - Ar.Tell())
+		return false;
+
+	TArray<UTF8CHAR> Utf8;
+	Utf8.SetNumUninitialized(Length);
+	Ar.Serialize(Utf8.GetData(), Length);
+	OutString = FString(FUTF8ToTCHAR(Utf8.GetData(), Length));
+	return !Ar.IsError();
+}
+
+// Number of bytes written by SerializeRecord.
+static int64 GetSerializedRecordSize(uint32 Version)
+{
+	int64 Size = sizeof(FDungeonRulesTraceRecord::Step) + sizeof(FDungeonRulesTraceRecord::Rule) + sizeof(FDungeonRulesTraceRecord::Transition) + sizeof(FDungeonRulesTraceRecord::Result);
+	if (Version >= TraceFileVersion_Seconds)
+		Size += sizeof(FDungeonRulesTraceRecord::Seconds);
+	return Size;
+}
+
+void FDungeonRulesTracer::Configure()
+{
+	SetCapacity(CVarDungeonRulesTrace.GetValueOnGameThread());
+}
+
+void FDungeonRulesTracer::SetCapacity(int32 NewCapacity)
+{
+	const int32 Capacity = (NewCapacity > 0) ? static_cast<int32>(FMath::RoundUpToPowerOfTwo(NewCapacity)) : 0;
+	if (Capacity != Records.Num())
+	{
+		Records.Empty(Capacity);
+		Records.SetNumZeroed(Capacity);
+	}
+	Clear();
+}
+
+void FDungeonRulesTracer::Clear()
+{
+	WriteIndex = 0;
+	Step = 0;
+	CurrentRule = INDEX_NONE;
+}
+
+void FDungeonRulesTracer::BeginGeneration(int32 FirstRule)
+{
+	Record(FirstRule, INDEX_NONE, EDungeonRulesTraceResult::Start);
+}
+
+void FDungeonRulesTracer::BeginStep(int32 Rule)
+{
+	++Step;
+	CurrentRule = Rule;
+}
+
+void FDungeonRulesTracer::RecordTransition(int32 Transition, bool bPassed, float Seconds)
+{
+	Record(CurrentRule, Transition, bPassed ? EDungeonRulesTraceResult::Passed : EDungeonRulesTraceResult::Failed, Seconds);
+}
+
+void FDungeonRulesTracer::EndStep(int32 NextRule)
+{
+	Record(NextRule, INDEX_NONE, EDungeonRulesTraceResult::NextRule);
+}
+
+void FDungeonRulesTracer::Record(int32 Rule, int32 Transition, EDungeonRulesTraceResult Result, float Seconds)
+{
+	// The capacity is a power of two, so the mask gives the index in the ring buffer.
+	FDungeonRulesTraceRecord& NewRecord = Records[WriteIndex & (Records.Num() - 1)];
+	NewRecord.Step = Step;
+	NewRecord.Rule = Rule;
+	NewRecord.Transition = Transition;
+	NewRecord.Result = Result;
+	NewRecord.Seconds = Seconds;
+	++WriteIndex;
+}
+
+void FDungeonRulesTracer::ForEachRecord(TFunctionRef<void(const FDungeonRulesTraceRecord&)> Func) const
+{
+	const uint64 Count = Num();
+	for (uint64 Index = WriteIndex - Count; Index < WriteIndex; ++Index)
+	{
+		Func(Records[Index & (Records.Num() - 1)]);
+	}
+}
+
+void FDungeonRulesTracer::Dump(FOutputDevice& Output, const FDungeonRulesProgram* Program) const
+{
+	Output.Logf(TEXT("Dungeon rules trace: %d record(s) (%llu recorded since the last clear)."), Num(), WriteIndex);
+	ForEachRecord([&Output, Program](const FDungeonRulesTraceRecord& Record)
+	{
+		if (Record.Transition == INDEX_NONE)
+		{
+			Output.Logf(TEXT("[%u] %s: '%s'"), Record.Step, GetResultName(Record.Result), *GetRuleName(Program, Record.Rule));
+		}
+		else
+		{
+			Output.Logf(TEXT("[%u] '%s' transition %s: %s"), Record.Step, *GetRuleName(Program, Record.Rule), *GetTransitionName(Program, Record.Transition), GetResultName(Record.Result));
+		}
+	});
+}
+
+bool FDungeonRulesTracer::SaveToFile(const FString& FilePath, const FString& AssetPath, const FDungeonRulesProgram& Program) const
+{
+	TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileWriter(*FilePath));
+	if (!Ar)
+	{
+		RulesLog_Error("Failed to write the dungeon rules trace in '%s'.", *FilePath);
+		return false;
+	}
+
+	uint32 Magic = TraceFileMagic;
+	uint32 Version = TraceFileVersion;
+	int32 Count = Num();
+	uint32 ProgramHash = Program.GetLayoutHash();
+	*Ar << Magic << Version << Count;
+	WriteString(*Ar, AssetPath);
+	*Ar << ProgramHash;
+	ForEachRecord([&Ar](const FDungeonRulesTraceRecord& Record)
+	{
+		SerializeRecord(*Ar, const_cast<FDungeonRulesTraceRecord&>(Record), TraceFileVersion);
+	});
+	return Ar->Close();
+}
+
+bool FDungeonRulesTracer::LoadFromFile(const FString& FilePath, const FString& AssetPath, const FDungeonRulesProgram& Program, TArray<FDungeonRulesTraceRecord>& OutRecords)
+{
+	TUniquePtr<FArchive> Ar(IFileManager::Get().CreateFileReader(*FilePath));
+	if (!Ar)
+	{
+		RulesLog_Error("Failed to read the dungeon rules trace in '%s'.", *FilePath);
+		return false;
+	}
+
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	int32 Count = 0;
+	*Ar << Magic << Version << Count;
+	if (Ar->IsError() || Magic != TraceFileMagic || Version < TraceFileVersion_Initial || Version > TraceFileVersion || Count < 0)
+	{
+		RulesLog_Error("'%s' is not a valid dungeon rules trace file.", *FilePath);
+		return false;
+	}
+
+	if (Version < TraceFileVersion_Identity)
+	{
+		RulesLog_Error("The dungeon rules trace '%s' has been saved by an older version which doesn't record its rules asset.", *FilePath);
+		return false;
+	}
+
+	FString Path;
+	uint32 ProgramHash = 0;
+	if (!ReadString(*Ar, Path))
+	{
+		RulesLog_Error("'%s' is not a valid dungeon rules trace file.", *FilePath);
+		return false;
+	}
+
+	*Ar << ProgramHash;
+	if (Ar->IsError() || Path != AssetPath)
+	{
+		RulesLog_Error("The dungeon rules trace '%s' has been recorded by '%s', not by '%s'.", *FilePath, *Path, *AssetPath);
+		return false;
+	}
+
+	if (ProgramHash != Program.GetLayoutHash())
+	{
+		RulesLog_Error("The dungeon rules trace '%s' has been recorded before '%s' was modified.", *FilePath, *AssetPath);
+		return false;
+	}
+
+	// The count is checked before allocating the records, so a truncated or corrupted file can't request a huge allocation.
+	const int64 RemainingSize = Ar->TotalSize() - Ar->Tell();
+	if (Count > RemainingSize / GetSerializedRecordSize(Version))
+	{
+		RulesLog_Error("The dungeon rules trace '%s' is truncated (%d records expected, %lld bytes remaining).", *FilePath, Count, RemainingSize);
+		return false;
+	}
+
+	TArray<FDungeonRulesTraceRecord> Records;
+	Records.SetNum(Count);
+	for (FDungeonRulesTraceRecord& Record : Records)
+	{
+		SerializeRecord(*Ar, Record, Version);
+	}
+
+	if (Ar->IsError())
+	{
+		RulesLog_Error("Failed to read the records of the dungeon rules trace '%s'.", *FilePath);
+		return false;
+	}
+
+	for (int32 i = 0; i < Records.Num(); ++i)
+	{
+		if (!IsValidRecord(Records[i], Program))
+		{
+			RulesLog_Error("The dungeon rules trace '%s' has an invalid record (#%d) for '%s'.", *FilePath, i, *AssetPath);
+			return false;
+		}
+	}
+
+	OutRecords = MoveTemp(Records);
+	return true;
+}
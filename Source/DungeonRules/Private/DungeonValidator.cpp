@@ -4,8 +4,36 @@
 // (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
 
 #include "DungeonValidator.h"
+#include "DungeonRulesDispatch.h"
+#include "Room.h" // IReadOnlyRoom
+
+void UDungeonValidator::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BlueprintIsDungeonValid = FDungeonRulesDispatch::FindBlueprintEvent(GetClass(), GET_FUNCTION_NAME_CHECKED(UDungeonValidator, IsDungeonValid));
+	BlueprintCanStillBeValid = FDungeonRulesDispatch::FindBlueprintEvent(GetClass(), GET_FUNCTION_NAME_CHECKED(UDungeonValidator, CanStillBeValid));
+}
 
 bool UDungeonValidator::IsDungeonValid_Implementation(const ADungeonGenerator* Generator) const
 {
 	return false;
 }
+
+bool UDungeonValidator::CanStillBeValid_Implementation(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom) const
+{
+	return true;
+}
+
+bool UDungeonValidator::DispatchCanStillBeValid(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom) const
+{
+	if (!FDungeonRulesDispatch::IsNativeDispatchEnabled())
+		return CanStillBeValid(Generator, NewRoom);
+
+	if (!BlueprintCanStillBeValid)
+		return CanStillBeValid_Implementation(Generator, NewRoom);
+
+	FDungeonRulesEventParams Params(*BlueprintCanStillBeValid);
+	Params.Set(Generator, NewRoom);
+	Params.Call(this);
+	return Params.GetReturnValue<bool>();
+}
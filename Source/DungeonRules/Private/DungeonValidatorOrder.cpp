@@ -0,0 +1,88 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonValidatorOrder.h"
+#include "DungeonValidator.h"
+
+void FDungeonValidatorOrder::Update(TConstArrayView<TObjectPtr<UDungeonValidator>> Validators)
+{
+	int32 NumValidators = 0;
+	bool bUpToDate = true;
+	for (const UDungeonValidator* Validator : Validators)
+	{
+		if (!Validator)
+			continue;
+		++NumValidators;
+		bUpToDate &= Stats.Contains(Validator);
+	}
+
+	if (bUpToDate && NumValidators == Order.Num())
+		return;
+
+	// Known validators keep their place, after the new ones.
+	TArray<const UDungeonValidator*> NewOrder;
+	NewOrder.Reserve(NumValidators);
+	for (const UDungeonValidator* Validator : Validators)
+	{
+		if (Validator && !Stats.Contains(Validator))
+			NewOrder.AddUnique(Validator);
+	}
+
+	for (const UDungeonValidator* Validator : Order)
+	{
+		if (Validators.Contains(Validator))
+			NewOrder.Add(Validator);
+	}
+
+	TMap<const UDungeonValidator*, FStats> NewStats;
+	for (const UDungeonValidator* Validator : NewOrder)
+	{
+		NewStats.Add(Validator, Stats.FindRef(Validator));
+	}
+
+	Order = MoveTemp(NewOrder);
+	Stats = MoveTemp(NewStats);
+}
+
+void FDungeonValidatorOrder::Reset()
+{
+	Order.Reset();
+	Stats.Reset();
+}
+
+void FDungeonValidatorOrder::Record(const UDungeonValidator* Validator, double Seconds, bool bPassed)
+{
+	FStats& ValidatorStats = Stats.FindOrAdd(Validator);
+	++ValidatorStats.NumCalls;
+	ValidatorStats.Seconds += Seconds;
+	if (!bPassed)
+		++ValidatorStats.NumFailures;
+}
+
+void FDungeonValidatorOrder::Merge(const FDungeonValidatorOrder& Other)
+{
+	for (const auto& Pair : Other.Stats)
+	{
+		FStats& ValidatorStats = Stats.FindOrAdd(Pair.Key);
+		ValidatorStats.NumCalls += Pair.Value.NumCalls;
+		ValidatorStats.NumFailures += Pair.Value.NumFailures;
+		ValidatorStats.Seconds += Pair.Value.Seconds;
+	}
+
+	for (const UDungeonValidator* Validator : Other.Order)
+	{
+		Order.AddUnique(Validator);
+	}
+	Sort();
+}
+
+void FDungeonValidatorOrder::Sort()
+{
+	// Stable, so validators with the same priority keep their order (e.g. the authored one when nothing is known).
+	Order.StableSort([this](const UDungeonValidator& A, const UDungeonValidator& B)
+	{
+		return Stats.FindChecked(&A).GetPriority() < Stats.FindChecked(&B).GetPriority();
+	});
+}
@@ -6,19 +6,61 @@
 #include "RoomChoosers/DRR_RandomData.h"
 #include "RoomData.h"
 #include "DungeonGenerator.h"
+#include "DungeonRulesEvaluationContext.h"
 
 #define LOCTEXT_NAMESPACE "UDRR_RandomData"
 
+void UDRR_RandomData::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BuildCandidates();
+}
+
+void UDRR_RandomData::PostLoad()
+{
+	Super::PostLoad();
+	BuildCandidates();
+}
+
+void UDRR_RandomData::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	CastChecked<UDRR_RandomData>(InThis)->Candidates.AddReferencedObjects(Collector);
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+#if WITH_EDITOR
+void UDRR_RandomData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	BuildCandidates();
+}
+#endif
+
 URoomData* UDRR_RandomData::ChooseFirstRoomData_Implementation(ADungeonGenerator* Generator) const
 {
-	check(IsValid(Generator));
-	return Generator->GetRandomRoomData(RoomList);
+	// No random stream without generator (e.g. simulated with the native dispatch disabled).
+	if (!IsValid(Generator))
+		return nullptr;
+	return Candidates.Choose(Generator->GetRandomStream());
 }
 
 URoomData* UDRR_RandomData::ChooseNextRoomData_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const
 {
-	check(IsValid(Generator));
-	return Generator->GetRandomRoomData(RoomList);
+	if (!IsValid(Generator))
+		return nullptr;
+	return Candidates.Choose(DoorData.Type, Generator->GetRandomStream());
+}
+
+URoomData* UDRR_RandomData::ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	check(Context.Random);
+	return Candidates.Choose(*Context.Random);
+}
+
+URoomData* UDRR_RandomData::ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const
+{
+	check(Context.Random);
+	return Candidates.Choose(DoorData.Type, *Context.Random);
 }
 
 FText UDRR_RandomData::GetDescription_Implementation() const
@@ -26,4 +68,47 @@ FText UDRR_RandomData::GetDescription_Implementation() const
 	return LOCTEXT("Description", "Return a random (uniform) RoomData from a static array.");
 }
 
+void UDRR_RandomData::GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const
+{
+	for (const TSoftObjectPtr<URoomData>& Room : RoomList)
+	{
+		if (!Room.IsNull())
+			OutRoomData.AddUnique(Room.ToSoftObjectPath());
+	}
+}
+
+void UDRR_RandomData::OnRoomDataLoaded()
+{
+	BuildCandidates();
+}
+
+void UDRR_RandomData::OnRoomDataReleased()
+{
+	Candidates.Reset();
+}
+
+#if WITH_DEV_AUTOMATION_TESTS
+void UDRR_RandomData::SetRoomList(const TArray<URoomData*>& NewList)
+{
+	RoomList.Reset(NewList.Num());
+	for (URoomData* Room : NewList)
+	{
+		RoomList.Add(Room);
+	}
+	BuildCandidates();
+}
+#endif
+
+void UDRR_RandomData::BuildCandidates()
+{
+	TArray<URoomData*> Rooms;
+	Rooms.Reserve(RoomList.Num());
+	for (const TSoftObjectPtr<URoomData>& Room : RoomList)
+	{
+		Rooms.Add(Room.Get());
+	}
+
+	Candidates.Build(Rooms);
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -5,22 +5,81 @@
 
 #include "RoomChoosers/DRR_SingleData.h"
 #include "RoomData.h"
+#include "DungeonRulesEvaluationContext.h"
 
 #define LOCTEXT_NAMESPACE "UDRR_SingleData"
 
+void UDRR_SingleData::PostInitProperties()
+{
+	Super::PostInitProperties();
+	ResolveRoomData();
+}
+
+void UDRR_SingleData::PostLoad()
+{
+	Super::PostLoad();
+	ResolveRoomData();
+}
+
+void UDRR_SingleData::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	UDRR_SingleData* This = CastChecked<UDRR_SingleData>(InThis);
+	Collector.AddReferencedObject(This->LoadedRoomData, This);
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+#if WITH_EDITOR
+void UDRR_SingleData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	ResolveRoomData();
+}
+#endif
+
 URoomData* UDRR_SingleData::ChooseFirstRoomData_Implementation(ADungeonGenerator* Generator) const
 {
-	return RoomData;
+	return RoomData.Get();
 }
 
 URoomData* UDRR_SingleData::ChooseNextRoomData_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const
 {
-	return RoomData;
+	return RoomData.Get();
 }
 
 FText UDRR_SingleData::GetDescription_Implementation() const
 {
-	return FText::Format(LOCTEXT("Description", "Return '{0}'"), FText::FromString(GetNameSafe(RoomData)));
+	return FText::Format(LOCTEXT("Description", "Return '{0}'"), FText::FromString(RoomData.IsNull() ? TEXT("None") : RoomData.GetAssetName()));
+}
+
+void UDRR_SingleData::GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const
+{
+	if (!RoomData.IsNull())
+		OutRoomData.AddUnique(RoomData.ToSoftObjectPath());
+}
+
+void UDRR_SingleData::OnRoomDataLoaded()
+{
+	ResolveRoomData();
+}
+
+void UDRR_SingleData::OnRoomDataReleased()
+{
+	LoadedRoomData = nullptr;
+}
+
+URoomData* UDRR_SingleData::ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	return LoadedRoomData;
+}
+
+URoomData* UDRR_SingleData::ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const
+{
+	return LoadedRoomData;
+}
+
+void UDRR_SingleData::ResolveRoomData()
+{
+	LoadedRoomData = RoomData.Get();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -6,39 +6,120 @@
 #include "RoomChoosers/DRR_WeightedRandomData.h"
 #include "RoomData.h"
 #include "DungeonGenerator.h"
-#include "RoomData.h"
+#include "DungeonRulesEvaluationContext.h"
 
 #define LOCTEXT_NAMESPACE "UDRR_WeightedRandomData"
 
+void UDRR_WeightedRandomData::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BuildCandidates();
+}
+
+void UDRR_WeightedRandomData::PostLoad()
+{
+	Super::PostLoad();
+	BuildCandidates();
+}
+
+void UDRR_WeightedRandomData::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	CastChecked<UDRR_WeightedRandomData>(InThis)->Candidates.AddReferencedObjects(Collector);
+	Super::AddReferencedObjects(InThis, Collector);
+}
+
+#if WITH_EDITOR
+void UDRR_WeightedRandomData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	BuildCandidates();
+}
+#endif
+
 URoomData* UDRR_WeightedRandomData::ChooseFirstRoomData_Implementation(ADungeonGenerator* Generator) const
 {
-	check(IsValid(Generator));
+	// No random stream without generator (e.g. simulated with the native dispatch disabled).
+	if (!IsValid(Generator))
+		return nullptr;
+	return ChooseRoomData(Generator->GetRandomStream());
+}
+
+URoomData* UDRR_WeightedRandomData::ChooseNextRoomData_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const
+{
+	if (!IsValid(Generator))
+		return nullptr;
+	return Candidates.Choose(DoorData.Type, Generator->GetRandomStream());
+}
+
+URoomData* UDRR_WeightedRandomData::ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	check(Context.Random);
+	return ChooseRoomData(*Context.Random);
+}
+
+URoomData* UDRR_WeightedRandomData::ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const
+{
+	check(Context.Random);
+	return Candidates.Choose(DoorData.Type, *Context.Random);
+}
+
+FText UDRR_WeightedRandomData::GetDescription_Implementation() const
+{
+	return LOCTEXT("Description", "Return a random (weighted) RoomData from a static array.");
+}
+
+URoomData* UDRR_WeightedRandomData::ChooseRoomData(const FRandomStream& Random) const
+{
+	return Candidates.Choose(Random);
+}
 
-	TMap<URoomData*, int> WeightedMap;
+void UDRR_WeightedRandomData::GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const
+{
 	for (const auto& Pair : WeightedRoomList)
 	{
-		WeightedMap.Add(Pair.RoomData, Pair.Weight);
+		if (!Pair.RoomData.IsNull())
+			OutRoomData.AddUnique(Pair.RoomData.ToSoftObjectPath());
 	}
+}
+
+void UDRR_WeightedRandomData::OnRoomDataLoaded()
+{
+	BuildCandidates();
+}
 
-	return Generator->GetRandomRoomDataWeighted(WeightedMap);
+void UDRR_WeightedRandomData::OnRoomDataReleased()
+{
+	Candidates.Reset();
 }
 
-URoomData* UDRR_WeightedRandomData::ChooseNextRoomData_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const
+#if WITH_DEV_AUTOMATION_TESTS
+void UDRR_WeightedRandomData::SetWeightedRoomList(const TArray<FRoomWeightPair>& NewList)
 {
-	check(IsValid(Generator));
+	WeightedRoomList = NewList;
+	BuildCandidates();
+}
+#endif
 
-	TMap<URoomData*, int> WeightedMap;
+void UDRR_WeightedRandomData::BuildCandidates()
+{
+	// A room data listed several times keeps its last weight.
+	TMap<TSoftObjectPtr<URoomData>, int> WeightedMap;
 	for (const auto& Pair : WeightedRoomList)
 	{
 		WeightedMap.Add(Pair.RoomData, Pair.Weight);
 	}
 
-	return Generator->GetRandomRoomDataWeighted(WeightedMap);
-}
+	TArray<URoomData*> RoomList;
+	TArray<int32> Weights;
+	RoomList.Reserve(WeightedMap.Num());
+	Weights.Reserve(WeightedMap.Num());
+	for (const auto& Pair : WeightedMap)
+	{
+		RoomList.Add(Pair.Key.Get());
+		Weights.Add(Pair.Value);
+	}
 
-FText UDRR_WeightedRandomData::GetDescription_Implementation() const
-{
-	return LOCTEXT("Description", "Return a random (weighted) RoomData from a static array.");
+	Candidates.Build(RoomList, Weights);
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -5,6 +5,44 @@
 
 #include "RuleTransitionCondition.h"
 #include "DungeonRulesLog.h"
+#include "DungeonRulesDispatch.h"
+#include "DungeonConditionExpression.h"
+#include "DungeonRulesEvaluationContext.h"
+#include "DungeonRulesStats.h"
+
+void URuleTransitionCondition::PostInitProperties()
+{
+	Super::PostInitProperties();
+	BlueprintCheck = FDungeonRulesDispatch::FindBlueprintEvent(GetClass(), GET_FUNCTION_NAME_CHECKED(URuleTransitionCondition, Check));
+}
+
+bool URuleTransitionCondition::DispatchCheck(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
+{
+	if (!FDungeonRulesDispatch::IsNativeDispatchEnabled())
+		return Check(Generator, PreviousRoom);
+
+	if (!BlueprintCheck)
+		return Check_Implementation(Generator, PreviousRoom);
+
+	FDungeonRulesEventParams Params(*BlueprintCheck);
+	Params.Set(Generator, PreviousRoom);
+	Params.Call(this);
+	return Params.GetReturnValue<bool>();
+}
+
+bool URuleTransitionCondition::DispatchCheck(const FDungeonRulesEvaluationContext& Context) const
+{
+	DUNGEONRULES_TRACE_SCOPE(GetClass()->GetName());
+	if (BlueprintCheck || !FDungeonRulesDispatch::IsNativeDispatchEnabled())
+		return DispatchCheck(Context.GetMutableGenerator(), Context.PreviousRoom);
+
+	return CheckWithContext(Context);
+}
+
+bool URuleTransitionCondition::CheckWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	return Check_Implementation(Context.GetMutableGenerator(), Context.PreviousRoom);
+}
 
 bool URuleTransitionCondition::Check_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
 {
@@ -20,3 +58,8 @@ FText URuleTransitionCondition::GetDescription_Implementation() const
 	return FText();
 #endif
 }
+
+int32 URuleTransitionCondition::BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const
+{
+	return Expression.AddCall(this);
+}
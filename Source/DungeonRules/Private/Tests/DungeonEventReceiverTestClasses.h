@@ -0,0 +1,59 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "DungeonEventReceiver.h"
+#include "DungeonEventReceiverTestClasses.generated.h"
+
+#if !WITH_DEV_AUTOMATION_TESTS
+static_assert("Do not include this file outside of unit tests!");
+#endif
+
+// Receiver counting all the events, without declaring which ones it implements.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDER_AllEvents : public UDungeonEventReceiver
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnGenerationInit_Implementation(ADungeonGenerator*) override { ++NumGenerationInit; }
+	virtual void OnPostGeneration_Implementation(ADungeonGenerator*) override { ++NumPostGeneration; }
+
+	int32 NumGenerationInit {0};
+	int32 NumPostGeneration {0};
+};
+
+// Receiver only implementing OnGenerationInit.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDER_GenerationInitOnly : public UDungeonEventReceiver
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnGenerationInit_Implementation(ADungeonGenerator*) override { ++NumGenerationInit; }
+
+	int32 NumGenerationInit {0};
+
+protected:
+	virtual bool HasNativeEvent(EDungeonEvent Event) const override { return Event == EDungeonEvent::OnGenerationInit; }
+};
+
+// Receiver counting the rooms added, one by one or in a batch.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDER_RoomCounter : public UDungeonEventReceiver
+{
+	GENERATED_BODY()
+
+public:
+	virtual void OnRoomAdded_Implementation(ADungeonGenerator*, const TScriptInterface<IReadOnlyRoom>&) override { ++NumRoomAdded; }
+	virtual void OnRoomsAdded_Implementation(ADungeonGenerator*, const TArray<TScriptInterface<IReadOnlyRoom>>& NewRooms) override { ++NumBatches; NumBatchedRooms += NewRooms.Num(); }
+
+	void SetBatchRoomAdded(bool bBatch) { bBatchRoomAdded = bBatch; }
+
+	int32 NumRoomAdded {0};
+	int32 NumBatches {0};
+	int32 NumBatchedRooms {0};
+};
@@ -0,0 +1,86 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonRules.h"
+#include "DungeonRulesRuntimeState.h"
+#include "DungeonEventReceiverTestClasses.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonEventReceiver_SubscriptionTests, "ProceduralDungeon.Rules.EventReceivers.Subscription", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonEventReceiver_SubscriptionTests::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<UDungeonRules> Rules(NewObject<UDungeonRules>(GetTransientPackage()));
+	TStrongObjectPtr<UDER_AllEvents> AllEvents(NewObject<UDER_AllEvents>(Rules.Get()));
+	TStrongObjectPtr<UDER_GenerationInitOnly> InitOnly(NewObject<UDER_GenerationInitOnly>(Rules.Get()));
+
+	// Receivers subscribe to the events of their class.
+	{
+		TestTrue(TEXT("Undeclared native events are subscribed"), AllEvents->IsSubscribedTo(EDungeonEvent::OnRoomAdded));
+		TestTrue(TEXT("Declared native event is subscribed"), InitOnly->IsSubscribedTo(EDungeonEvent::OnGenerationInit));
+		TestFalse(TEXT("Other native events are not subscribed"), InitOnly->IsSubscribedTo(EDungeonEvent::OnRoomAdded));
+	}
+
+	// Only the subscribers of an event receive it.
+	{
+		Rules->SetEventReceivers({AllEvents.Get(), nullptr, InitOnly.Get()});
+		TestEqual(TEXT("Two receivers of OnGenerationInit"), Rules->GetNumEventSubscribers(EDungeonEvent::OnGenerationInit), 2);
+		TestEqual(TEXT("One receiver of OnPostGeneration"), Rules->GetNumEventSubscribers(EDungeonEvent::OnPostGeneration), 1);
+		TestEqual(TEXT("One receiver of OnRoomAdded"), Rules->GetNumEventSubscribers(EDungeonEvent::OnRoomAdded), 1);
+
+		FDungeonRulesRuntimeState State;
+		Rules->OnGenerationInit(nullptr);
+		Rules->OnPostGeneration(nullptr, State);
+		TestEqual(TEXT("OnGenerationInit routed to the first receiver"), AllEvents->NumGenerationInit, 1);
+		TestEqual(TEXT("OnPostGeneration routed to the first receiver"), AllEvents->NumPostGeneration, 1);
+		TestEqual(TEXT("OnGenerationInit routed to the second receiver"), InitOnly->NumGenerationInit, 1);
+	}
+
+	// The lists are rebuilt when the receivers change.
+	{
+		Rules->SetEventReceivers({InitOnly.Get()});
+		TestEqual(TEXT("No receiver of OnPostGeneration left"), Rules->GetNumEventSubscribers(EDungeonEvent::OnPostGeneration), 0);
+		TestEqual(TEXT("One receiver of OnGenerationInit left"), Rules->GetNumEventSubscribers(EDungeonEvent::OnGenerationInit), 1);
+	}
+
+	// Batched receivers get all the rooms at once after the generation.
+	{
+		TStrongObjectPtr<UDER_RoomCounter> Immediate(NewObject<UDER_RoomCounter>(Rules.Get()));
+		TStrongObjectPtr<UDER_RoomCounter> Batched(NewObject<UDER_RoomCounter>(Rules.Get()));
+		Batched->SetBatchRoomAdded(true);
+		Rules->SetEventReceivers({Immediate.Get(), Batched.Get()});
+		TestTrue(TEXT("Rules have batched receivers"), Rules->HasBatchedRoomAdded());
+		TestEqual(TEXT("One receiver of OnRoomAdded"), Rules->GetNumEventSubscribers(EDungeonEvent::OnRoomAdded), 1);
+		TestEqual(TEXT("One receiver of OnRoomsAdded"), Rules->GetNumEventSubscribers(EDungeonEvent::OnRoomsAdded), 1);
+
+		const FDungeonRulesProgram EmptyProgram;
+		FDungeonRulesRuntimeState State;
+		State.Reset(EmptyProgram);
+		for (int32 i = 0; i < 3; ++i)
+		{
+			Rules->OnRoomAdded(nullptr, nullptr, State);
+		}
+		TestEqual(TEXT("Immediate receiver got each room"), Immediate->NumRoomAdded, 3);
+		TestEqual(TEXT("Batched receiver got nothing yet"), Batched->NumRoomAdded + Batched->NumBatches, 0);
+		TestEqual(TEXT("Rooms are buffered"), State.AddedRooms.Num(), 3);
+
+		Rules->OnPostGeneration(nullptr, State);
+		TestEqual(TEXT("Immediate receiver got no batch"), Immediate->NumBatches, 0);
+		TestEqual(TEXT("Batched receiver got a single batch"), Batched->NumBatches, 1);
+		TestEqual(TEXT("Batch contains all the rooms"), Batched->NumBatchedRooms, 3);
+
+		State.Reset(EmptyProgram);
+		TestEqual(TEXT("Buffer is emptied for the next generation"), State.AddedRooms.Num(), 0);
+		TestTrue(TEXT("Buffer keeps its memory"), State.AddedRooms.Max() >= 3);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,46 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "DungeonGeneratorWithRules.h"
+#include "DungeonGeneratorTestClasses.generated.h"
+
+#if !WITH_DEV_AUTOMATION_TESTS
+static_assert("Do not include this file outside of unit tests!");
+#endif
+
+// Generator with a fixed seed, recording the rooms added by its last generation.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class ADungeonGeneratorRecorder : public ADungeonGeneratorWithRules
+{
+	GENERATED_BODY()
+
+public:
+	ADungeonGeneratorRecorder() { SeedType = ESeedType::Fixed; }
+
+	void SetDungeonRules(UDungeonRules* NewRules) { DungeonRules = NewRules; }
+
+	virtual void OnGenerationInit_Implementation() override
+	{
+		Super::OnGenerationInit_Implementation();
+		AddedRooms.Reset();
+	}
+
+	virtual void OnRoomAdded_Implementation(const URoomData* NewRoom, const TScriptInterface<IReadOnlyRoom>& RoomInstance) override
+	{
+		Super::OnRoomAdded_Implementation(NewRoom, RoomInstance);
+		AddedRooms.Add(NewRoom);
+	}
+
+	virtual void OnPostGeneration_Implementation() override
+	{
+		Super::OnPostGeneration_Implementation();
+		bGenerated = true;
+	}
+
+	TArray<const URoomData*> AddedRooms;
+	bool bGenerated {false};
+};
@@ -0,0 +1,122 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonRules.h"
+#include "TransitionConditions/DRT_RoomDataCount.h"
+#include "RoomChoosers/DRR_RandomData.h"
+#include "RoomData.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "Containers/Ticker.h"
+#include "UObject/StrongObjectPtr.h"
+#include "DungeonGeneratorTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonGenerator_TimeSlicedTests, "ProceduralDungeon.Rules.Generator.TimeSliced", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+namespace
+{
+	URoomData* CreateRoom(const FName& Name, const TArray<EDoorDirection>& Doors)
+	{
+		URoomData* Room = NewObject<URoomData>(GetTransientPackage(), Name);
+		Room->FirstPoint = FIntVector::ZeroValue;
+		Room->SecondPoint = FIntVector(1);
+		for (const EDoorDirection Direction : Doors)
+		{
+			FDoorDef& DoorDef = Room->Doors.AddDefaulted_GetRef();
+			DoorDef.Position = FIntVector::ZeroValue;
+			DoorDef.Direction = Direction;
+		}
+		return Room;
+	}
+
+	// Ticks the world, and the core ticker planning the time sliced generations, until the generator has finished.
+	bool WaitForGeneration(UWorld* World, ADungeonGeneratorRecorder* Generator)
+	{
+		for (int32 Frame = 0; Frame < 1000 && !Generator->bGenerated; ++Frame)
+		{
+			FTSTicker::GetCoreTicker().Tick(0.016f);
+			World->Tick(LEVELTICK_All, 0.016f);
+		}
+		return Generator->bGenerated;
+	}
+}
+
+bool FDungeonGenerator_TimeSlicedTests::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<URoomData> Corridor(CreateRoom(TEXT("SlicedCorridor"), {EDoorDirection::North, EDoorDirection::South}));
+	TStrongObjectPtr<URoomData> Cross(CreateRoom(TEXT("SlicedCross"), {EDoorDirection::North, EDoorDirection::East, EDoorDirection::South, EDoorDirection::West}));
+	TStrongObjectPtr<URoomData> DeadEnd(CreateRoom(TEXT("SlicedDeadEnd"), {EDoorDirection::North}));
+
+	// A single rule choosing random rooms until the dungeon has 15 of them.
+	TStrongObjectPtr<UDungeonRules> Rules(NewObject<UDungeonRules>(GetTransientPackage()));
+	UDRR_RandomData* Chooser = NewObject<UDRR_RandomData>(Rules.Get());
+	Chooser->SetRoomList({Corridor.Get(), Cross.Get(), DeadEnd.Get()});
+	UDRT_RoomDataCount* Stop = NewObject<UDRT_RoomDataCount>(Rules.Get());
+	Stop->SetCount(EComparisonOp::GreaterEqual, 15);
+
+	UDungeonRule* Rule = NewObject<UDungeonRule>(Rules.Get());
+	Rule->RoomChooser = Chooser;
+	UDungeonRuleTransition* Transition = NewObject<UDungeonRuleTransition>(Rules.Get());
+	Transition->Condition = Stop;
+	Rule->AddTransition(Transition);
+	Rules->AddRule(Rule);
+	Rules->SetFirstRule(Rule);
+	Rules->AddTransition(Transition);
+	Rules->Compile();
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+	World->InitializeActorsForPlay(FURL());
+	World->BeginPlay();
+
+	ADungeonGeneratorRecorder* Generator = World->SpawnActor<ADungeonGeneratorRecorder>();
+	Generator->SetDungeonRules(Rules.Get());
+
+	// The time sliced generation replays its plan, and adds the same rooms as Generate() for the same seed,
+	// whether the generation follows its whole plan or diverges from it.
+	int32 NumFollowedPlans = 0;
+	for (int32 Seed = 0; Seed < 10; ++Seed)
+	{
+		Generator->SetSeed(Seed);
+		Generator->bGenerated = false;
+		Generator->Generate();
+		if (!TestTrue(*FString::Printf(TEXT("Synchronous generation finished for seed %d"), Seed), WaitForGeneration(World, Generator)))
+			break;
+		TestFalse(*FString::Printf(TEXT("No plan replayed by Generate() for seed %d"), Seed), Generator->WasPlanReplayed());
+		const TArray<const URoomData*> SynchronousRooms = Generator->AddedRooms;
+
+		Generator->bGenerated = false;
+		Generator->GenerateTimeSliced();
+		TestTrue(*FString::Printf(TEXT("Planning started for seed %d"), Seed), Generator->IsPlanning());
+		if (!TestTrue(*FString::Printf(TEXT("Time sliced generation finished for seed %d"), Seed), WaitForGeneration(World, Generator)))
+			break;
+
+		TestTrue(*FString::Printf(TEXT("Plan replayed for seed %d"), Seed), Generator->WasPlanReplayed());
+		TestEqual(*FString::Printf(TEXT("Same rooms for seed %d"), Seed), Generator->AddedRooms, SynchronousRooms);
+		if (Generator->WasPlanReplayed() && Generator->GetPlanDivergence() == INDEX_NONE)
+			++NumFollowedPlans;
+	}
+
+	AddInfo(FString::Printf(TEXT("%d of 10 time sliced generations have followed their whole plan."), NumFollowedPlans));
+
+	// The generations use the compiled program, until the rules are edited.
+	TestFalse(TEXT("Program not dirty after the generations"), Rules->IsProgramDirty());
+	FPropertyChangedEvent ChangedEvent(nullptr);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Broadcast(Chooser, ChangedEvent);
+	TestTrue(TEXT("Program dirty once a room chooser is edited"), Rules->IsProgramDirty());
+	Rules->PrepareForGeneration();
+	TestFalse(TEXT("Program compiled before the next generation"), Rules->IsProgramDirty());
+
+	GEngine->DestroyWorldContext(World);
+	World->DestroyWorld(false);
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS && WITH_EDITOR
@@ -0,0 +1,69 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "DungeonRoomInitializer.h"
+#include <atomic>
+#include "DungeonInitializerTestClasses.generated.h"
+
+#if !WITH_DEV_AUTOMATION_TESTS
+static_assert("Do not include this file outside of unit tests!");
+#endif
+
+// Room initializer writing a value computed from the room index in the slot of each room.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDRI_RoomIndex : public UDungeonRoomInitializer
+{
+	GENERATED_BODY()
+
+public:
+	mutable TArray<int32> Slots;
+	mutable TArray<uint32> Threads;
+	mutable int32 NumEndRooms {0};
+	bool bThreadSafe {true};
+
+protected:
+	virtual void BeginRooms(const ADungeonGenerator*, int32 NumRooms) const override
+	{
+		Slots.SetNumZeroed(NumRooms);
+		Threads.SetNumZeroed(NumRooms);
+	}
+
+	virtual void InitializeRoom(const ADungeonGenerator*, const URoom*, int32 RoomIndex) const override
+	{
+		Slots[RoomIndex] = RoomIndex * 2 + 1;
+		Threads[RoomIndex] = FPlatformTLS::GetCurrentThreadId();
+	}
+
+	virtual void EndRooms(const ADungeonGenerator*, TConstArrayView<URoom*>) const override { ++NumEndRooms; }
+	virtual bool IsInitializeRoomThreadSafe() const override { return bThreadSafe; }
+};
+
+// Initializer declaring the data set by the test, and counting its calls.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDRI_DataAccess : public UDungeonInitializer
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitializeDungeon_Implementation(const ADungeonGenerator*, const UDungeonGraph*) const override { ++NumCalls; }
+
+	virtual bool GetDataAccess(TArray<FName>& OutReads, TArray<FName>& OutWrites) const override
+	{
+		OutReads = Reads;
+		OutWrites = Writes;
+		return bDeclared;
+	}
+
+	TArray<FName> Reads;
+	TArray<FName> Writes;
+	bool bDeclared {true};
+	bool bThreadSafe {true};
+	mutable std::atomic<int32> NumCalls {0};
+
+protected:
+	virtual bool IsNativeThreadSafe() const override { return bThreadSafe; }
+};
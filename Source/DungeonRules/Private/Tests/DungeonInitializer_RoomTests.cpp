@@ -0,0 +1,59 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonInitializerTestClasses.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonInitializer_RoomTests, "ProceduralDungeon.Rules.Initializers.Rooms", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonInitializer_RoomTests::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<UDRI_RoomIndex> Initializer(NewObject<UDRI_RoomIndex>(GetTransientPackage()));
+
+	// The room objects are not used by the test initializer.
+	TArray<URoom*> Rooms;
+	Rooms.SetNumZeroed(500);
+
+	// Each room gets its own slot, whatever the thread initializing it.
+	{
+		Initializer->InitializeRooms(nullptr, Rooms);
+		TestEqual(TEXT("One slot per room"), Initializer->Slots.Num(), Rooms.Num());
+		bool bAllSlots = true;
+		for (int32 i = 0; i < Initializer->Slots.Num(); ++i)
+		{
+			bAllSlots &= Initializer->Slots[i] == i * 2 + 1;
+		}
+		TestTrue(TEXT("All slots are written"), bAllSlots);
+		TestEqual(TEXT("EndRooms called once"), Initializer->NumEndRooms, 1);
+	}
+
+	// Not thread safe initializers only run on the game thread.
+	{
+		Initializer->bThreadSafe = false;
+		Initializer->InitializeRooms(nullptr, Rooms);
+		bool bGameThread = true;
+		for (uint32 Thread : Initializer->Threads)
+		{
+			bGameThread &= Thread == GGameThreadId;
+		}
+		TestTrue(TEXT("All rooms initialized on the game thread"), bGameThread);
+		TestEqual(TEXT("Last slot is written"), Initializer->Slots.Last(), 999);
+	}
+
+	// No room, no slot.
+	{
+		Initializer->InitializeRooms(nullptr, {});
+		TestEqual(TEXT("No slot"), Initializer->Slots.Num(), 0);
+		TestEqual(TEXT("EndRooms still called"), Initializer->NumEndRooms, 3);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
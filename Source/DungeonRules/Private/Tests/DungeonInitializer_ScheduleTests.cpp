@@ -0,0 +1,83 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonInitializerSchedule.h"
+#include "DungeonInitializerTestClasses.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonInitializer_ScheduleTests, "ProceduralDungeon.Rules.Initializers.Schedule", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonInitializer_ScheduleTests::RunTest(const FString& Parameters)
+{
+	auto MakeInitializer = [](TArray<FName> Reads, TArray<FName> Writes) {
+		TStrongObjectPtr<UDRI_DataAccess> Initializer(NewObject<UDRI_DataAccess>(GetTransientPackage()));
+		Initializer->Reads = Reads;
+		Initializer->Writes = Writes;
+		return Initializer;
+	};
+
+	// A writes tags, B writes spawns, C reads tags and writes lights, D reads lights.
+	TStrongObjectPtr<UDRI_DataAccess> A = MakeInitializer({}, {TEXT("Tags")});
+	TStrongObjectPtr<UDRI_DataAccess> B = MakeInitializer({}, {TEXT("Spawns")});
+	TStrongObjectPtr<UDRI_DataAccess> C = MakeInitializer({TEXT("Tags")}, {TEXT("Lights")});
+	TStrongObjectPtr<UDRI_DataAccess> D = MakeInitializer({TEXT("Lights")}, {});
+
+	// Independent initializers share a wave, dependent ones wait for the previous wave.
+	{
+		TArray<TObjectPtr<UDungeonInitializer>> Initializers {A.Get(), B.Get(), nullptr, C.Get(), D.Get()};
+		FDungeonInitializerSchedule Schedule;
+		Schedule.Build(Initializers);
+		TestEqual(TEXT("Three waves"), Schedule.GetNumWaves(), 3);
+		TestEqual(TEXT("A and B in the first wave"), Schedule.GetWave(0).Num(), 2);
+		TestTrue(TEXT("A in the first wave"), Schedule.GetWave(0).Contains(A.Get()));
+		TestTrue(TEXT("B in the first wave"), Schedule.GetWave(0).Contains(B.Get()));
+		TestTrue(TEXT("C after A"), Schedule.GetWave(1).Contains(C.Get()));
+		TestTrue(TEXT("D after C"), Schedule.GetWave(2).Contains(D.Get()));
+
+		Schedule.Run(nullptr, nullptr);
+		TestTrue(TEXT("Each initializer called once"), A->NumCalls == 1 && B->NumCalls == 1 && C->NumCalls == 1 && D->NumCalls == 1);
+	}
+
+	// Readers of the same data don't depend on each other.
+	{
+		TStrongObjectPtr<UDRI_DataAccess> E = MakeInitializer({TEXT("Tags")}, {});
+		TArray<TObjectPtr<UDungeonInitializer>> Initializers {C.Get(), E.Get()};
+		FDungeonInitializerSchedule Schedule;
+		Schedule.Build(Initializers);
+		TestEqual(TEXT("Readers in a single wave"), Schedule.GetNumWaves(), 1);
+	}
+
+	// Undeclared or not thread safe initializers run alone, in the order of the array.
+	{
+		TStrongObjectPtr<UDRI_DataAccess> Undeclared = MakeInitializer({}, {});
+		Undeclared->bDeclared = false;
+		TStrongObjectPtr<UDRI_DataAccess> NotThreadSafe = MakeInitializer({}, {TEXT("Actors")});
+		NotThreadSafe->bThreadSafe = false;
+
+		TArray<TObjectPtr<UDungeonInitializer>> Initializers {A.Get(), Undeclared.Get(), B.Get(), NotThreadSafe.Get(), D.Get()};
+		FDungeonInitializerSchedule Schedule;
+		Schedule.Build(Initializers);
+		TestEqual(TEXT("Five waves"), Schedule.GetNumWaves(), 5);
+		for (int32 i = 0; i < Schedule.GetNumWaves(); ++i)
+		{
+			TestTrue(FString::Printf(TEXT("Wave %d is the initializer %d"), i, i), Schedule.GetWave(i).Num() == 1 && Schedule.GetWave(i)[0] == Initializers[i]);
+		}
+	}
+
+	// Nothing to run.
+	{
+		FDungeonInitializerSchedule Schedule;
+		Schedule.Build({});
+		TestEqual(TEXT("No wave"), Schedule.GetNumWaves(), 0);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "DungeonRulesHeatmap.h"
+#include "DungeonRulesTracer.h"
+#include "DungeonRulesProgram.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonRulesHeatmapTests, "ProceduralDungeon.Rules.Heatmap", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonRulesHeatmapTests::RunTest(const FString& Parameters)
+{
+	// Two steps from rule 0: transition 0 fails then transition 1 passes to rule 1, then the generation stops.
+	FDungeonRulesTracer Tracer;
+	Tracer.SetCapacity(16);
+	Tracer.BeginGeneration(0);
+	Tracer.BeginStep(0);
+	Tracer.RecordTransition(0, false, 0.5f);
+	Tracer.RecordTransition(1, true, 0.25f);
+	Tracer.EndStep(1);
+	Tracer.BeginStep(1);
+	Tracer.RecordTransition(2, true, 1.0f);
+	Tracer.EndStep(INDEX_NONE);
+
+	// The trace files are checked against the program which recorded them: two rules and three transitions.
+	const FString AssetPath = TEXT("/Game/Tests/HeatmapRules.HeatmapRules");
+	FDungeonRulesProgram Program;
+	Program.Rules.SetNum(2);
+	Program.Transitions.SetNum(3);
+	Program.FirstRule = 0;
+
+	// The records are accumulated per rule and per transition.
+	{
+		FDungeonRulesHeatmap Heatmap;
+		TestTrue(TEXT("Empty heatmap"), Heatmap.IsEmpty());
+		Heatmap.Add(Tracer);
+		Heatmap.Add(Tracer);
+		TestEqual(TEXT("All records added"), Heatmap.GetNumRecords(), static_cast<int64>(2 * Tracer.Num()));
+
+		const FDungeonRulesHeatmap::FEntry* RuleA = Heatmap.FindRule(0);
+		const FDungeonRulesHeatmap::FEntry* RuleB = Heatmap.FindRule(1);
+		if (TestNotNull(TEXT("Rule 0 recorded"), RuleA) && TestNotNull(TEXT("Rule 1 recorded"), RuleB))
+		{
+			TestEqual(TEXT("Rule 0 visited at each start"), RuleA->Visits, 2ll);
+			TestEqual(TEXT("Rule 1 visited once per generation"), RuleB->Visits, 2ll);
+			TestEqual(TEXT("Time of the transitions of rule 0"), RuleA->Seconds, 1.5, 1e-6);
+		}
+
+		const FDungeonRulesHeatmap::FEntry* Failing = Heatmap.FindTransition(0);
+		if (TestNotNull(TEXT("Transition 0 recorded"), Failing))
+		{
+			TestEqual(TEXT("Transition 0 checked twice"), Failing->Visits, 2ll);
+			TestEqual(TEXT("Transition 0 never passed"), Failing->Passes, 0ll);
+		}
+
+		TestNull(TEXT("Unknown rule"), Heatmap.FindRule(5));
+		TestEqual(TEXT("Max transition time"), Heatmap.GetMaxTransition().Seconds, 2.0, 1e-6);
+		TestEqual(TEXT("Max rule visits"), Heatmap.GetMaxRule().Visits, 2ll);
+
+		// Merging sums the entries of both heatmaps.
+		FDungeonRulesHeatmap Other;
+		Other.Add(Tracer);
+		Other.Merge(Heatmap);
+		TestEqual(TEXT("Merged records"), Other.GetNumRecords(), static_cast<int64>(3 * Tracer.Num()));
+		const FDungeonRulesHeatmap::FEntry* Passing = Other.FindTransition(1);
+		if (TestNotNull(TEXT("Merged transition 1"), Passing))
+			TestEqual(TEXT("Merged passes"), Passing->Passes, 3ll);
+	}
+
+	// The time survives a round trip in a trace file.
+	{
+		const FString FilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("HeatmapTest.drtrace"));
+		TArray<FDungeonRulesTraceRecord> Records;
+		if (TestTrue(TEXT("Trace saved"), Tracer.SaveToFile(FilePath, AssetPath, Program)) && TestTrue(TEXT("Trace loaded"), FDungeonRulesTracer::LoadFromFile(FilePath, AssetPath, Program, Records)))
+		{
+			FDungeonRulesHeatmap Heatmap;
+			Heatmap.Add(Records);
+			const FDungeonRulesHeatmap::FEntry* Transition = Heatmap.FindTransition(2);
+			TestTrue(TEXT("Time loaded"), Transition && FMath::IsNearlyEqual(Transition->Seconds, 1.0));
+		}
+		IFileManager::Get().Delete(*FilePath);
+	}
+
+	// A file announcing more records than it contains is rejected before allocating them.
+	{
+		const FString FilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("TruncatedTest.drtrace"));
+		TArray<uint8> Bytes;
+		if (TestTrue(TEXT("Trace saved"), Tracer.SaveToFile(FilePath, AssetPath, Program)) && TestTrue(TEXT("Trace read"), FFileHelper::LoadFileToArray(Bytes, *FilePath)))
+		{
+			// The record count follows the magic number and the version.
+			const int32 Count = MAX_int32;
+			FMemory::Memcpy(Bytes.GetData() + 2 * sizeof(uint32), &Count, sizeof(Count));
+			FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+
+			AddExpectedError(TEXT("is truncated"), EAutomationExpectedErrorFlags::Contains, 1);
+			TArray<FDungeonRulesTraceRecord> Records;
+			TestFalse(TEXT("Truncated trace not loaded"), FDungeonRulesTracer::LoadFromFile(FilePath, AssetPath, Program, Records));
+			TestEqual(TEXT("No record loaded"), Records.Num(), 0);
+		}
+		IFileManager::Get().Delete(*FilePath);
+	}
+
+	// A file recorded by another asset, or by another program of the asset, is rejected.
+	{
+		const FString FilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("MismatchTest.drtrace"));
+		if (TestTrue(TEXT("Trace saved"), Tracer.SaveToFile(FilePath, AssetPath, Program)))
+		{
+			AddExpectedError(TEXT("has been recorded by"), EAutomationExpectedErrorFlags::Contains, 1);
+			TArray<FDungeonRulesTraceRecord> Records;
+			TestFalse(TEXT("Trace of another asset not loaded"), FDungeonRulesTracer::LoadFromFile(FilePath, TEXT("/Game/Tests/OtherRules.OtherRules"), Program, Records));
+
+			FDungeonRulesProgram ModifiedProgram;
+			ModifiedProgram.Rules.SetNum(2);
+			ModifiedProgram.Transitions.SetNum(2);
+			ModifiedProgram.FirstRule = 0;
+			AddExpectedError(TEXT("has been recorded before"), EAutomationExpectedErrorFlags::Contains, 1);
+			TestFalse(TEXT("Trace of a modified asset not loaded"), FDungeonRulesTracer::LoadFromFile(FilePath, AssetPath, ModifiedProgram, Records));
+			TestEqual(TEXT("No record loaded"), Records.Num(), 0);
+		}
+		IFileManager::Get().Delete(*FilePath);
+	}
+
+	// A file with a corrupted record is rejected instead of reaching the heatmap.
+	{
+		const FString FilePath = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("CorruptedTest.drtrace"));
+		TArray<uint8> Bytes;
+		if (TestTrue(TEXT("Trace saved"), Tracer.SaveToFile(FilePath, AssetPath, Program)) && TestTrue(TEXT("Trace read"), FFileHelper::LoadFileToArray(Bytes, *FilePath)))
+		{
+			// The last record ends with its result and its time.
+			Bytes[Bytes.Num() - sizeof(float) - 1] = 0xFF;
+			FFileHelper::SaveArrayToFile(Bytes, *FilePath);
+
+			AddExpectedError(TEXT("has an invalid record"), EAutomationExpectedErrorFlags::Contains, 1);
+			TArray<FDungeonRulesTraceRecord> Records;
+			TestFalse(TEXT("Corrupted trace not loaded"), FDungeonRulesTracer::LoadFromFile(FilePath, AssetPath, Program, Records));
+			TestEqual(TEXT("No record loaded"), Records.Num(), 0);
+		}
+		IFileManager::Get().Delete(*FilePath);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,97 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "TransitionConditions/DRT_LogicalOperator.h"
+#include "TransitionConditions/DRT_NotOperator.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonRulesRuntimeState.h"
+#include "Serialization/ObjectWriter.h"
+#include "Serialization/ObjectReader.h"
+#include "UObject/StrongObjectPtr.h"
+#include "TransitionConditionTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonRulesProgram_SerializationTests, "ProceduralDungeon.Rules.ProgramSerialization", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonRulesProgram_SerializationTests::RunTest(const FString& Parameters)
+{
+	CREATE_CONDITION_INSTANCE(UDRT_Variable, A);
+	CREATE_CONDITION_INSTANCE(UDRT_Variable, B);
+	CREATE_CONDITION_INSTANCE(UDRT_NotOperator, NotB);
+	CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Operator_OR);
+	NotB->SetCondition(B.Get());
+	Operator_OR->SetOperator(ELogicalOperator::OR);
+	Operator_OR->SetConditions({A.Get(), NotB.Get()});
+
+	// Two rules looping on each other, through a conduit for the second one.
+	FDungeonRulesProgram Program;
+	Program.Rules.SetNum(2);
+	Program.Conduits.SetNum(1);
+	auto AddTransition = [&Program](const URuleTransitionCondition* Condition, int32 Target, EDungeonRulesNodeType TargetType) {
+		FDungeonRulesProgram::FTransition& Transition = Program.Transitions.AddDefaulted_GetRef();
+		Transition.Condition = Program.AddCondition(Condition);
+		Transition.Target = Target;
+		Transition.TargetType = TargetType;
+	};
+
+	AddTransition(Operator_OR.Get(), 0, EDungeonRulesNodeType::Conduit);
+	Program.Rules[0].Transitions = {0, 1};
+	AddTransition(A.Get(), 0, EDungeonRulesNodeType::Rule);
+	Program.Rules[1].Transitions = {1, 1};
+	AddTransition(nullptr, 1, EDungeonRulesNodeType::Rule);
+	Program.Conduits[0].Transitions = {2, 1};
+	Program.FirstRule = 0;
+	Program.CompileConditions();
+
+	TArray<uint8> Bytes;
+	FObjectWriter Writer(Bytes);
+	Program.Serialize(Writer);
+
+	FDungeonRulesProgram Loaded;
+	FObjectReader Reader(Bytes);
+	Loaded.Serialize(Reader);
+
+	TestFalse(TEXT("No error while reading"), Reader.IsError());
+	TestEqual(TEXT("Same number of rules"), Loaded.Rules.Num(), Program.Rules.Num());
+	TestEqual(TEXT("Same number of conduits"), Loaded.Conduits.Num(), Program.Conduits.Num());
+	TestEqual(TEXT("Same number of transitions"), Loaded.Transitions.Num(), Program.Transitions.Num());
+	TestEqual(TEXT("Same first rule"), Loaded.FirstRule, Program.FirstRule);
+	TestTrue(TEXT("Same conditions"), Loaded.Conditions == Program.Conditions);
+	TestEqual(TEXT("Same number of instructions"), Loaded.Bytecode.Num(), Program.Bytecode.Num());
+	TestNotEqual(TEXT("New room counter layout"), Loaded.RoomCounters.GetSerial(), Program.RoomCounters.GetSerial());
+
+	for (int32 i = 0; i < Program.Transitions.Num(); ++i)
+	{
+		const FDungeonRulesProgram::FTransition& Expected = Program.Transitions[i];
+		const FDungeonRulesProgram::FTransition& Result = Loaded.Transitions[i];
+		TestTrue(*FString::Printf(TEXT("Same transition #%d"), i), Expected.Condition == Result.Condition && Expected.Target == Result.Target && Expected.TargetType == Result.TargetType);
+	}
+
+	// The loaded program must take the same decisions.
+	FDungeonRulesRuntimeState ExpectedState;
+	FDungeonRulesRuntimeState LoadedState;
+	ExpectedState.Reset(Program);
+	LoadedState.Reset(Loaded);
+	for (int32 Inputs = 0; Inputs < 4; ++Inputs)
+	{
+		A->bValue = Inputs & 1;
+		B->bValue = (Inputs >> 1) & 1;
+		for (int32 Rule = 0; Rule < 2; ++Rule)
+		{
+			ExpectedState.CurrentRule = Rule;
+			LoadedState.CurrentRule = Rule;
+			const int32 Expected = Program.GetNextRule(ExpectedState, ExpectedState.MakeContext(nullptr, nullptr));
+			const int32 Result = Loaded.GetNextRule(LoadedState, LoadedState.MakeContext(nullptr, nullptr));
+			TestEqual(*FString::Printf(TEXT("Same next rule from rule %d {A=%d, B=%d}"), Rule, Inputs & 1, (Inputs >> 1) & 1), Result, Expected);
+		}
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,79 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonRulesRuntimeState.h"
+#include "Serialization/ObjectWriter.h"
+#include "UObject/StrongObjectPtr.h"
+#include "TransitionConditionTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonRulesRuntimeStateTests, "ProceduralDungeon.Rules.RuntimeState", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonRulesRuntimeStateTests::RunTest(const FString& Parameters)
+{
+	CREATE_CONDITION_INSTANCE(UDRT_Variable, A);
+
+	// Rule 0 always goes to rule 1, rule 1 goes back to rule 0 when A is true.
+	FDungeonRulesProgram Program;
+	Program.Rules.SetNum(2);
+	auto AddTransition = [&Program](const URuleTransitionCondition* Condition, int32 Target) {
+		FDungeonRulesProgram::FTransition& Transition = Program.Transitions.AddDefaulted_GetRef();
+		Transition.Condition = Program.AddCondition(Condition);
+		Transition.Target = Target;
+		Transition.TargetType = EDungeonRulesNodeType::Rule;
+	};
+
+	AddTransition(nullptr, 1);
+	Program.Rules[0].Transitions = {0, 1};
+	AddTransition(A.Get(), 0);
+	Program.Rules[1].Transitions = {1, 1};
+	Program.FirstRule = 0;
+	Program.CompileConditions();
+
+	auto SaveProgram = [&Program]() {
+		TArray<uint8> Bytes;
+		FObjectWriter Writer(Bytes);
+		Program.Serialize(Writer);
+		return Bytes;
+	};
+
+	const TArray<uint8> ProgramBefore = SaveProgram();
+
+	// Two generations sharing the program, evaluated in turns.
+	FDungeonRulesRuntimeState StateA;
+	FDungeonRulesRuntimeState StateB;
+	StateA.Reset(Program);
+	StateB.Reset(Program);
+	TestEqual(TEXT("State A starts at the first rule"), StateA.CurrentRule, 0);
+	TestEqual(TEXT("State B starts at the first rule"), StateB.CurrentRule, 0);
+
+	A->bValue = false;
+	StateA.CurrentRule = Program.GetNextRule(StateA, StateA.MakeContext(nullptr, nullptr));
+	StateA.CurrentRule = Program.GetNextRule(StateA, StateA.MakeContext(nullptr, nullptr));
+	StateB.CurrentRule = Program.GetNextRule(StateB, StateB.MakeContext(nullptr, nullptr));
+	TestEqual(TEXT("State A stays in rule 1"), StateA.CurrentRule, 1);
+	TestEqual(TEXT("State B is in rule 1"), StateB.CurrentRule, 1);
+
+	// The cached result of A in a state must not leak into the other one.
+	A->bValue = true;
+	StateB.CurrentRule = Program.GetNextRule(StateB, StateB.MakeContext(nullptr, nullptr));
+	TestEqual(TEXT("State B goes back to rule 0"), StateB.CurrentRule, 0);
+	TestEqual(TEXT("State A is still in rule 1"), StateA.CurrentRule, 1);
+
+	TestTrue(TEXT("Program not modified by the evaluation"), SaveProgram() == ProgramBefore);
+
+	// A reused state starts over.
+	StateA.Reset(Program);
+	TestEqual(TEXT("Reset state is at the first rule"), StateA.CurrentRule, 0);
+	TestEqual(TEXT("Reset state has no room"), StateA.Histogram.GetTotal(), 0);
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,100 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonRulesProgram.h"
+#include "RoomChoosers/DRR_RandomData.h"
+#include "RoomData.h"
+#include "DungeonRulesEvaluationContext.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonRules_PreloadTests, "ProceduralDungeon.Rules.Preload", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonRules_PreloadTests::RunTest(const FString& Parameters)
+{
+	// Rule 0 leads to rule 1 through a conduit, rule 1 leads to rule 0.
+	// Rule 2 is only reachable from the global transitions, and rules 3 and 4 only from each other.
+	{
+		FDungeonRulesProgram Program;
+		Program.Rules.SetNum(5);
+		Program.Conduits.SetNum(1);
+		auto AddTransition = [&Program](int32 Target, EDungeonRulesNodeType TargetType) {
+			FDungeonRulesProgram::FTransition& Transition = Program.Transitions.AddDefaulted_GetRef();
+			Transition.Target = Target;
+			Transition.TargetType = TargetType;
+		};
+
+		AddTransition(0, EDungeonRulesNodeType::Conduit);
+		Program.Rules[0].Transitions = {0, 1};
+		AddTransition(0, EDungeonRulesNodeType::Rule);
+		AddTransition(INDEX_NONE, EDungeonRulesNodeType::None);
+		Program.Rules[1].Transitions = {1, 2};
+		AddTransition(1, EDungeonRulesNodeType::Rule);
+		Program.Conduits[0].Transitions = {3, 1};
+		AddTransition(4, EDungeonRulesNodeType::Rule);
+		Program.Rules[3].Transitions = {4, 1};
+		AddTransition(3, EDungeonRulesNodeType::Rule);
+		Program.Rules[4].Transitions = {5, 1};
+		AddTransition(2, EDungeonRulesNodeType::Rule);
+		Program.GlobalTransitions = {6, 1};
+
+		const TBitArray<> Reachable = Program.GetReachableRules();
+		TestEqual(TEXT("One bit per rule"), Reachable.Num(), 5);
+		TestTrue(TEXT("First rule is reachable"), Reachable[0]);
+		TestTrue(TEXT("Rule behind the conduit is reachable"), Reachable[1]);
+		TestTrue(TEXT("Rule of the global transitions is reachable"), Reachable[2]);
+		TestFalse(TEXT("Rule 3 is not reachable"), Reachable[3]);
+		TestFalse(TEXT("Rule 4 is not reachable"), Reachable[4]);
+
+		Program.FirstRule = 3;
+		const TBitArray<> ReachableFromThree = Program.GetReachableRules();
+		TestFalse(TEXT("Rule 0 is not reachable from rule 3"), ReachableFromThree[0]);
+		TestTrue(TEXT("Rule 4 is reachable from rule 3"), ReachableFromThree[4]);
+		TestTrue(TEXT("Global transitions are reachable from rule 3"), ReachableFromThree[2]);
+
+		Program.FirstRule = INDEX_NONE;
+		TestFalse(TEXT("Nothing is reachable without first rule"), Program.GetReachableRules().Contains(true));
+	}
+
+	// The room data of a chooser are reported once, without the empty entries.
+	{
+		TStrongObjectPtr<URoomData> RoomA(NewObject<URoomData>(GetTransientPackage(), TEXT("PreloadRoomA")));
+		TStrongObjectPtr<URoomData> RoomB(NewObject<URoomData>(GetTransientPackage(), TEXT("PreloadRoomB")));
+		TStrongObjectPtr<UDRR_RandomData> Chooser(NewObject<UDRR_RandomData>(GetTransientPackage()));
+		Chooser->SetRoomList({RoomA.Get(), nullptr, RoomB.Get(), RoomA.Get()});
+
+		TArray<FSoftObjectPath> RoomData;
+		Chooser->GetRoomDataToLoad(RoomData);
+		TestEqual(TEXT("Two room data to load"), RoomData.Num(), 2);
+		TestTrue(TEXT("Room A to load"), RoomData.Contains(FSoftObjectPath(RoomA.Get())));
+		TestTrue(TEXT("Room B to load"), RoomData.Contains(FSoftObjectPath(RoomB.Get())));
+	}
+
+	// The rooms cached by a chooser are kept alive until the room data are released.
+	{
+		TStrongObjectPtr<UDRR_RandomData> Chooser(NewObject<UDRR_RandomData>(GetTransientPackage()));
+		TWeakObjectPtr<URoomData> Room = NewObject<URoomData>(GetTransientPackage(), TEXT("PreloadRoomCached"));
+		Chooser->SetRoomList({Room.Get()});
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+		TestTrue(TEXT("Cached room survives the GC"), Room.IsValid());
+
+		const FRandomStream Random(0);
+		FDungeonRulesEvaluationContext Context;
+		Context.Random = &Random;
+		Chooser->OnRoomDataReleased();
+		TestNull(TEXT("No room once released"), Chooser->DispatchChooseFirstRoomData(Context));
+
+		// Reloaded by something else: the candidates are rebuilt even if nothing was pending.
+		Chooser->OnRoomDataLoaded();
+		TestEqual(TEXT("Room chosen again once loaded"), Chooser->DispatchChooseFirstRoomData(Context), Room.Get());
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,249 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonRulesSimulator.h"
+#include "DungeonRulesProgram.h"
+#include "TransitionConditions/DRT_RoomDataCount.h"
+#include "RoomChoosers/DRR_RandomData.h"
+#include "RoomData.h"
+#include "UObject/StrongObjectPtr.h"
+#include "TransitionConditionTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonRules_SimulatorTests, "ProceduralDungeon.Rules.Simulator", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+namespace
+{
+	URoomData* CreateRoom(const FName& Name, const FIntVector& Size, const TArray<TPair<FIntVector, EDoorDirection>>& Doors)
+	{
+		URoomData* Room = NewObject<URoomData>(GetTransientPackage(), Name);
+		Room->FirstPoint = FIntVector::ZeroValue;
+		Room->SecondPoint = Size;
+		for (const auto& Door : Doors)
+		{
+			FDoorDef& DoorDef = Room->Doors.AddDefaulted_GetRef();
+			DoorDef.Position = Door.Key;
+			DoorDef.Direction = Door.Value;
+		}
+		return Room;
+	}
+
+	// Single rule choosing rooms in the list, stopping once the dungeon has the number of rooms (never when negative).
+	void BuildProgram(FDungeonRulesProgram& Program, const UDungeonRoomChooser* Chooser, const URuleTransitionCondition* StopCondition)
+	{
+		Program.Reset();
+		Program.Rules.SetNum(1);
+		Program.Rules[0].RoomChooser = Chooser;
+		if (StopCondition)
+		{
+			FDungeonRulesProgram::FTransition& Transition = Program.Transitions.AddDefaulted_GetRef();
+			Transition.Condition = Program.AddCondition(StopCondition);
+			Transition.TargetType = EDungeonRulesNodeType::None;
+			Program.Rules[0].Transitions = {0, 1};
+		}
+		Program.FirstRule = 0;
+		Program.CompileConditions();
+	}
+
+	bool HasOverlappingRooms(const FDungeonSimulatedLayout& Layout)
+	{
+		for (int32 i = 0; i < Layout.Rooms.Num(); ++i)
+		{
+			for (int32 j = i + 1; j < Layout.Rooms.Num(); ++j)
+			{
+				const FDungeonSimulatedRoom& A = Layout.Rooms[i];
+				const FDungeonSimulatedRoom& B = Layout.Rooms[j];
+				if (A.BoundsMin.X <= B.BoundsMax.X && B.BoundsMin.X <= A.BoundsMax.X
+					&& A.BoundsMin.Y <= B.BoundsMax.Y && B.BoundsMin.Y <= A.BoundsMax.Y
+					&& A.BoundsMin.Z <= B.BoundsMax.Z && B.BoundsMin.Z <= A.BoundsMax.Z)
+					return true;
+			}
+		}
+		return false;
+	}
+}
+
+bool FDungeonRules_SimulatorTests::RunTest(const FString& Parameters)
+{
+	const FIntVector Zero = FIntVector::ZeroValue;
+	TStrongObjectPtr<URoomData> Corridor(CreateRoom(TEXT("SimCorridor"), FIntVector(1), {{Zero, EDoorDirection::North}, {Zero, EDoorDirection::South}}));
+	TStrongObjectPtr<URoomData> Cross(CreateRoom(TEXT("SimCross"), FIntVector(1), {{Zero, EDoorDirection::North}, {Zero, EDoorDirection::East}, {Zero, EDoorDirection::South}, {Zero, EDoorDirection::West}}));
+	TStrongObjectPtr<URoomData> Big(CreateRoom(TEXT("SimBig"), FIntVector(3, 2, 1), {{FIntVector(2, 0, 0), EDoorDirection::North}, {FIntVector(0, 1, 0), EDoorDirection::South}, {FIntVector(1, 1, 0), EDoorDirection::East}}));
+	TStrongObjectPtr<URoomData> DeadEnd(CreateRoom(TEXT("SimDeadEnd"), FIntVector(1), {{Zero, EDoorDirection::North}}));
+
+	TStrongObjectPtr<UDRR_RandomData> Chooser(NewObject<UDRR_RandomData>(GetTransientPackage()));
+	CREATE_CONDITION_INSTANCE(UDRT_RoomDataCount, Stop);
+
+	FDungeonRulesProgram Program;
+	FDungeonRulesRuntimeState State;
+	FDungeonSimulatedLayout Layout;
+
+	// Corridors are connected in a straight line until the rules stop.
+	{
+		Chooser->SetRoomList({Corridor.Get()});
+		Stop->SetCount(EComparisonOp::GreaterEqual, 10);
+		BuildProgram(Program, Chooser.Get(), Stop.Get());
+
+		const FDungeonRulesSimulator Simulator(Program);
+		TestTrue(TEXT("[Corridor] Simulator is thread safe"), Simulator.IsThreadSafe());
+		TestTrue(TEXT("[Corridor] Simulation succeeded"), Simulator.Simulate(0, 100, State, Layout));
+		TestEqual(TEXT("[Corridor] Stopped by the rules"), Layout.End, EDungeonSimulationEnd::Stopped);
+		TestEqual(TEXT("[Corridor] Number of rooms"), Layout.Rooms.Num(), 10);
+		TestFalse(TEXT("[Corridor] No overlapping rooms"), HasOverlappingRooms(Layout));
+		TestFalse(TEXT("[Corridor] Rooms in a line"), Layout.Rooms.ContainsByPredicate([](const FDungeonSimulatedRoom& Room) { return Room.Location.Y != 0; }));
+		TestEqual(TEXT("[Corridor] First room connected on both sides"), Layout.Rooms[0].Connections, TArray<int32>({1, 2}));
+	}
+
+	// The simulation ends when the rules never stop.
+	{
+		BuildProgram(Program, Chooser.Get(), nullptr);
+
+		const FDungeonRulesSimulator Simulator(Program);
+		Simulator.Simulate(0, 5, State, Layout);
+		TestEqual(TEXT("[Endless] Reached the maximum number of rooms"), Layout.End, EDungeonSimulationEnd::MaxRooms);
+		TestEqual(TEXT("[Endless] Number of rooms"), Layout.Rooms.Num(), 5);
+
+		Chooser->SetRoomList({DeadEnd.Get()});
+		Simulator.Simulate(0, 5, State, Layout);
+		TestEqual(TEXT("[Dead End] No more doors"), Layout.End, EDungeonSimulationEnd::NoMoreDoors);
+		TestEqual(TEXT("[Dead End] Number of rooms"), Layout.Rooms.Num(), 2);
+	}
+
+	// The implementations taking a generator don't assert when simulated without one.
+	{
+		int DoorIndex = INDEX_NONE;
+		TestNull(TEXT("[No Generator] No first room"), Chooser->ChooseFirstRoomData(nullptr));
+		TestNull(TEXT("[No Generator] No next room"), Chooser->ChooseNextRoomData(nullptr, nullptr, Corridor->Doors[0], DoorIndex));
+		TestFalse(TEXT("[No Generator] Count condition not met"), Stop->Check(nullptr, nullptr));
+	}
+
+	// Many seeds give the same results on worker threads and on a single thread.
+	{
+		Chooser->SetRoomList({Corridor.Get(), Cross.Get(), Big.Get(), DeadEnd.Get()});
+		Stop->SetCount(EComparisonOp::GreaterEqual, 30);
+		BuildProgram(Program, Chooser.Get(), Stop.Get());
+
+		const FDungeonRulesSimulator Simulator(Program);
+		FDungeonSimulationSettings Settings;
+		Settings.NumSeeds = 500;
+		Settings.MaxRooms = 100;
+
+		TArray<FDungeonSimulationResult> ParallelResults;
+		const FDungeonSimulationStats ParallelStats = Simulator.Run(Settings, &ParallelResults);
+
+		Settings.bParallel = false;
+		TArray<FDungeonSimulationResult> SerialResults;
+		const FDungeonSimulationStats SerialStats = Simulator.Run(Settings, &SerialResults);
+
+		TestEqual(TEXT("[Batch] All seeds simulated"), ParallelStats.NumGenerations, Settings.NumSeeds);
+		TestEqual(TEXT("[Batch] One result per seed"), ParallelResults.Num(), Settings.NumSeeds);
+		TestEqual(TEXT("[Batch] Same total of rooms"), ParallelStats.TotalRooms, SerialStats.TotalRooms);
+		TestEqual(TEXT("[Batch] Same discarded rooms"), ParallelStats.TotalFailedRooms, SerialStats.TotalFailedRooms);
+		TestTrue(TEXT("[Batch] At most 30 rooms"), ParallelStats.MaxRooms <= 30);
+
+		int64 TotalRooms = 0;
+		int32 NumEnds = 0;
+		for (int32 i = 0; i < ParallelResults.Num(); ++i)
+		{
+			const FDungeonSimulationResult& Parallel = ParallelResults[i];
+			const FDungeonSimulationResult& Serial = SerialResults[i];
+			TotalRooms += Parallel.NumRooms;
+			if (!TestTrue(*FString::Printf(TEXT("[Batch] Same result for seed %d"), Parallel.Seed), Parallel.Seed == Serial.Seed && Parallel.NumRooms == Serial.NumRooms && Parallel.NumFailedRooms == Serial.NumFailedRooms && Parallel.End == Serial.End))
+				break;
+		}
+		for (int32 i = 0; i < 4; ++i)
+		{
+			NumEnds += ParallelStats.Ends[i];
+		}
+		TestEqual(TEXT("[Batch] Stats match the results"), ParallelStats.TotalRooms, TotalRooms);
+		TestEqual(TEXT("[Batch] One end by seed"), NumEnds, Settings.NumSeeds);
+
+		for (int32 Seed = 0; Seed < 20; ++Seed)
+		{
+			Simulator.Simulate(Seed, Settings.MaxRooms, State, Layout);
+			if (!TestFalse(*FString::Printf(TEXT("[Batch] No overlapping rooms for seed %d"), Seed), HasOverlappingRooms(Layout)))
+				break;
+		}
+	}
+
+	// A simulation run one door at a time takes the same decisions as when run at once.
+	{
+		const FDungeonRulesSimulator Simulator(Program);
+		for (int32 Seed = 0; Seed < 20; ++Seed)
+		{
+			Simulator.Simulate(Seed, 100, State, Layout);
+
+			FDungeonRulesRuntimeState SlicedState;
+			FDungeonSimulatedLayout SlicedLayout;
+			FDungeonSimulationCursor Cursor;
+			int32 NumSteps = 0;
+			if (Simulator.Begin(Seed, SlicedState, SlicedLayout, Cursor))
+			{
+				// A deadline in the past processes a single door by step.
+				while (!Simulator.Step(100, 0.0, SlicedState, SlicedLayout, Cursor))
+				{
+					++NumSteps;
+				}
+			}
+
+			bool bSameChoices = SlicedLayout.Choices.Num() == Layout.Choices.Num();
+			for (int32 i = 0; bSameChoices && i < Layout.Choices.Num(); ++i)
+			{
+				const FDungeonSimulatedChoice& A = Layout.Choices[i];
+				const FDungeonSimulatedChoice& B = SlicedLayout.Choices[i];
+				bSameChoices = A.ParentRoom == B.ParentRoom && A.ParentDoor == B.ParentDoor && A.RoomData == B.RoomData && A.DoorIndex == B.DoorIndex
+					&& A.Rule == B.Rule && A.NumRooms == B.NumRooms && A.RandomBefore == B.RandomBefore && A.NumChooserDraws == B.NumChooserDraws
+					&& A.NextRule == B.NextRule && A.NumRuleDraws == B.NumRuleDraws;
+			}
+
+			// The random chooser draws a single value, and the transitions only count the rooms.
+			bool bRecordedRandom = Layout.Choices.Num() > 0 && Layout.Choices[0].RandomBefore == Seed;
+			for (int32 i = 0; bRecordedRandom && i < Layout.Choices.Num(); ++i)
+			{
+				bRecordedRandom = Layout.Choices[i].NumChooserDraws == 1 && Layout.Choices[i].NumRuleDraws == 0;
+			}
+
+			TestTrue(*FString::Printf(TEXT("[Time Sliced] Several steps for seed %d"), Seed), NumSteps > 1);
+			TestTrue(*FString::Printf(TEXT("[Time Sliced] Same choices for seed %d"), Seed), bSameChoices);
+			TestTrue(*FString::Printf(TEXT("[Time Sliced] Random draws recorded for seed %d"), Seed), bRecordedRandom);
+			TestEqual(*FString::Printf(TEXT("[Time Sliced] Same end for seed %d"), Seed), SlicedLayout.End, Layout.End);
+			TestEqual(*FString::Printf(TEXT("[Time Sliced] Same rule for seed %d"), Seed), SlicedState.CurrentRule, State.CurrentRule);
+		}
+	}
+
+	// The first candidate accepted wins, whatever the order the candidates are simulated.
+	{
+		const FDungeonRulesSimulator Simulator(Program);
+		TArray<int32> Seeds;
+		int32 Expected = INDEX_NONE;
+		for (int32 i = 0; i < 64; ++i)
+		{
+			Seeds.Add(1000 + i);
+			Simulator.Simulate(Seeds[i], 100, State, Layout);
+			TestEqual(*FString::Printf(TEXT("[Speculative] One choice by room for seed %d"), Seeds[i]), Layout.Choices.Num(), Layout.Rooms.Num() + Layout.NumFailedRooms);
+			if (Expected == INDEX_NONE && Layout.NumFailedRooms >= 2)
+				Expected = i;
+		}
+
+		FDungeonSimulatedLayout Winner;
+		const int32 Result = Simulator.FindFirstValidSeed(Seeds, 100, [](const FDungeonSimulatedLayout& Candidate) { return Candidate.NumFailedRooms >= 2; }, Winner);
+		TestEqual(TEXT("[Speculative] First accepted candidate"), Result, Expected);
+		if (Result != INDEX_NONE)
+		{
+			TestTrue(TEXT("[Speculative] Layout of the winner"), Winner.NumFailedRooms >= 2);
+			TestNull(TEXT("[Speculative] First choice has no parent"), Winner.Choices[0].ParentRoom);
+		}
+
+		const int32 NoResult = Simulator.FindFirstValidSeed(Seeds, 100, [](const FDungeonSimulatedLayout&) { return false; }, Winner);
+		TestEqual(TEXT("[Speculative] No accepted candidate"), NoResult, INDEX_NONE);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,179 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "Async/ParallelFor.h"
+#include "TransitionConditions/DRT_LogicalOperator.h"
+#include "TransitionConditions/DRT_NotOperator.h"
+#include "TransitionConditions/DRT_RoomDataCount.h"
+#include "TransitionConditions/DRT_RoomClassCount.h"
+#include "RoomChoosers/DRR_SingleData.h"
+#include "RoomChoosers/DRR_RandomData.h"
+#include "RoomChoosers/DRR_WeightedRandomData.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonRulesRuntimeState.h"
+#include "RoomData.h"
+#include "UObject/StrongObjectPtr.h"
+#include "TransitionConditionTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonRules_ThreadSafetyTests, "ProceduralDungeon.Rules.ThreadSafety", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+namespace
+{
+	// Path taken by a generation: the rule and room chosen at each step.
+	struct FSimulatedGeneration
+	{
+		TArray<int32> Rules;
+		TArray<const URoomData*> Rooms;
+
+		bool operator==(const FSimulatedGeneration& Other) const { return Rules == Other.Rules && Rooms == Other.Rooms; }
+	};
+
+	// Runs the rules without generator, until they stop or after a maximum number of rooms.
+	FSimulatedGeneration Simulate(const FDungeonRulesProgram& Program, int32 Seed)
+	{
+		FSimulatedGeneration Generation;
+		FDungeonRulesRuntimeState State;
+		FRandomStream Random(Seed);
+		State.Reset(Program);
+		while (Program.IsValidRule(State.CurrentRule) && Generation.Rooms.Num() < 100)
+		{
+			const FDungeonRulesEvaluationContext Context = State.MakeContext(nullptr, nullptr, &Random);
+			const URoomData* Room = Program.Rules[State.CurrentRule].RoomChooser->DispatchChooseFirstRoomData(Context);
+			State.Histogram.AddRoom(Room);
+			Generation.Rules.Add(State.CurrentRule);
+			Generation.Rooms.Add(Room);
+			State.CurrentRule = Program.GetNextRule(State, Context);
+		}
+		return Generation;
+	}
+}
+
+bool FDungeonRules_ThreadSafetyTests::RunTest(const FString& Parameters)
+{
+	// Built-in classes are thread safe as long as the conditions they contain are.
+	{
+		CREATE_CONDITION_INSTANCE(UDRT_True, TRUE);
+		CREATE_CONDITION_INSTANCE(UDRT_Variable, Variable);
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, SafeOperator);
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, UnsafeOperator);
+		CREATE_CONDITION_INSTANCE(UDRT_NotOperator, SafeNot);
+		CREATE_CONDITION_INSTANCE(UDRT_NotOperator, UnsafeNot);
+		CREATE_CONDITION_INSTANCE(UDRT_RoomDataCount, DataCount);
+		CREATE_CONDITION_INSTANCE(UDRT_RoomClassCount, ClassCount);
+		SafeOperator->SetConditions({TRUE.Get(), DataCount.Get(), nullptr});
+		UnsafeOperator->SetConditions({TRUE.Get(), Variable.Get()});
+		SafeNot->SetCondition(SafeOperator.Get());
+		UnsafeNot->SetCondition(UnsafeOperator.Get());
+
+		TestFalse(TEXT("Test variable is not thread safe"), Variable->IsThreadSafe());
+		TestTrue(TEXT("Room data count is thread safe"), DataCount->IsThreadSafe());
+		TestTrue(TEXT("Room class count is thread safe"), ClassCount->IsThreadSafe());
+		TestTrue(TEXT("Operator of thread safe conditions is thread safe"), SafeOperator->IsThreadSafe());
+		TestFalse(TEXT("Operator with a thread unsafe condition is not thread safe"), UnsafeOperator->IsThreadSafe());
+		TestTrue(TEXT("NOT of a thread safe condition is thread safe"), SafeNot->IsThreadSafe());
+		TestFalse(TEXT("NOT of a thread unsafe condition is not thread safe"), UnsafeNot->IsThreadSafe());
+
+		TStrongObjectPtr<UDRR_SingleData> SingleData(NewObject<UDRR_SingleData>(GetTransientPackage()));
+		TStrongObjectPtr<UDRR_RandomData> RandomData(NewObject<UDRR_RandomData>(GetTransientPackage()));
+		TStrongObjectPtr<UDRR_WeightedRandomData> WeightedRandomData(NewObject<UDRR_WeightedRandomData>(GetTransientPackage()));
+		TestTrue(TEXT("Single data is thread safe"), SingleData->IsThreadSafe());
+		TestTrue(TEXT("Random data is thread safe"), RandomData->IsThreadSafe());
+		TestTrue(TEXT("Weighted random data is thread safe"), WeightedRandomData->IsThreadSafe());
+
+		FDungeonRulesProgram Program;
+		Program.Rules.AddDefaulted_GetRef().RoomChooser = RandomData.Get();
+		Program.AddCondition(SafeNot.Get());
+		TArray<const UObject*> NotThreadSafe;
+		Program.GetNotThreadSafeObjects(NotThreadSafe);
+		TestEqual(TEXT("Program of built-in classes is thread safe"), NotThreadSafe.Num(), 0);
+
+		Program.AddCondition(UnsafeNot.Get());
+		Program.GetNotThreadSafeObjects(NotThreadSafe);
+		TestTrue(TEXT("Program reports the thread unsafe condition"), NotThreadSafe.Num() == 1 && NotThreadSafe[0] == UnsafeNot.Get());
+	}
+
+	// Many generations sharing the same program on worker threads must take the same decisions as on a single thread.
+	{
+		TArray<TStrongObjectPtr<URoomData>> Rooms;
+		TArray<URoomData*> RoomList;
+		for (int32 i = 0; i < 5; ++i)
+		{
+			URoomData* Room = NewObject<URoomData>(GetTransientPackage(), *FString::Printf(TEXT("ThreadSafetyRoom_%d"), i));
+			Rooms.Emplace(Room);
+			RoomList.Add(Room);
+		}
+
+		TStrongObjectPtr<UDRR_RandomData> Chooser(NewObject<UDRR_RandomData>(GetTransientPackage()));
+		Chooser->SetRoomList(RoomList);
+
+		// Rule 0 goes to rule 1 after 3 rooms, rule 1 goes to rule 2 with 6 to 8 rooms, and rule 2 stops after 12 rooms.
+		CREATE_CONDITION_INSTANCE(UDRT_RoomDataCount, AtLeast3);
+		CREATE_CONDITION_INSTANCE(UDRT_RoomDataCount, AtLeast6);
+		CREATE_CONDITION_INSTANCE(UDRT_RoomDataCount, AtLeast9);
+		CREATE_CONDITION_INSTANCE(UDRT_RoomDataCount, AtLeast12);
+		CREATE_CONDITION_INSTANCE(UDRT_NotOperator, Below9);
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Between6And8);
+		AtLeast3->SetCount(EComparisonOp::GreaterEqual, 3);
+		AtLeast6->SetCount(EComparisonOp::GreaterEqual, 6);
+		AtLeast9->SetCount(EComparisonOp::GreaterEqual, 9);
+		AtLeast12->SetCount(EComparisonOp::GreaterEqual, 12);
+		Below9->SetCondition(AtLeast9.Get());
+		Between6And8->SetOperator(ELogicalOperator::AND);
+		Between6And8->SetConditions({AtLeast6.Get(), Below9.Get()});
+
+		FDungeonRulesProgram Program;
+		Program.Rules.SetNum(3);
+		auto AddTransition = [&Program](const URuleTransitionCondition* Condition, int32 Target, EDungeonRulesNodeType TargetType) {
+			FDungeonRulesProgram::FTransition& Transition = Program.Transitions.AddDefaulted_GetRef();
+			Transition.Condition = Program.AddCondition(Condition);
+			Transition.Target = Target;
+			Transition.TargetType = TargetType;
+		};
+
+		AddTransition(AtLeast3.Get(), 1, EDungeonRulesNodeType::Rule);
+		AddTransition(Between6And8.Get(), 2, EDungeonRulesNodeType::Rule);
+		AddTransition(AtLeast12.Get(), INDEX_NONE, EDungeonRulesNodeType::None);
+		for (int32 i = 0; i < 3; ++i)
+		{
+			Program.Rules[i].RoomChooser = Chooser.Get();
+			Program.Rules[i].Transitions = {i, 1};
+		}
+		Program.FirstRule = 0;
+		Program.CompileConditions();
+
+		TArray<const UObject*> NotThreadSafe;
+		Program.GetNotThreadSafeObjects(NotThreadSafe);
+		TestEqual(TEXT("Simulated program is thread safe"), NotThreadSafe.Num(), 0);
+
+		const int32 NumGenerations = 256;
+		TArray<FSimulatedGeneration> Expected;
+		for (int32 Seed = 0; Seed < NumGenerations; ++Seed)
+		{
+			Expected.Add(Simulate(Program, Seed));
+		}
+
+		TArray<FSimulatedGeneration> Results;
+		Results.SetNum(NumGenerations);
+		ParallelFor(NumGenerations, [&Program, &Results](int32 Seed) {
+			Results[Seed] = Simulate(Program, Seed);
+		});
+
+		TestEqual(TEXT("Generation stops after 12 rooms"), Expected[0].Rooms.Num(), 12);
+		TestTrue(TEXT("Generation goes through all the rules"), Expected[0].Rules == TArray<int32>({0, 0, 0, 1, 1, 1, 2, 2, 2, 2, 2, 2}));
+		for (int32 Seed = 0; Seed < NumGenerations; ++Seed)
+		{
+			if (!TestTrue(*FString::Printf(TEXT("Same generation for seed %d"), Seed), Results[Seed] == Expected[Seed]))
+				break;
+		}
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,36 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "DungeonValidator.h"
+#include "DungeonValidatorTestClasses.generated.h"
+
+#if !WITH_DEV_AUTOMATION_TESTS
+static_assert("Do not include this file outside of unit tests!");
+#endif
+
+// Validator only checking the finished dungeon.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDV_FinalOnly : public UDungeonValidator
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool IsDungeonValid_Implementation(const ADungeonGenerator*) const override { return true; }
+};
+
+// Validator whose incremental check returns the value set by the test.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDV_Incremental : public UDungeonValidator
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool IsDungeonValid_Implementation(const ADungeonGenerator*) const override { return bCanStillBeValid; }
+	virtual bool CanStillBeValid_Implementation(const ADungeonGenerator*, const TScriptInterface<IReadOnlyRoom>&) const override { return bCanStillBeValid; }
+
+	bool bCanStillBeValid {true};
+};
@@ -0,0 +1,49 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonRulesDispatch.h"
+#include "DungeonRulesRuntimeState.h"
+#include "Room.h" // IReadOnlyRoom
+#include "UObject/StrongObjectPtr.h"
+#include "DungeonValidatorTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonValidator_IncrementalTests, "ProceduralDungeon.Rules.Validators.Incremental", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonValidator_IncrementalTests::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<UDV_FinalOnly> FinalOnly(NewObject<UDV_FinalOnly>(GetTransientPackage()));
+	TStrongObjectPtr<UDV_Incremental> Incremental(NewObject<UDV_Incremental>(GetTransientPackage()));
+
+	const bool bWasEnabled = FDungeonRulesDispatch::IsNativeDispatchEnabled();
+	for (const bool bNativeDispatch : {true, false})
+	{
+		FDungeonRulesDispatch::SetNativeDispatchEnabled(bNativeDispatch);
+		const TCHAR* Mode = bNativeDispatch ? TEXT("Native") : TEXT("ProcessEvent");
+
+		TestTrue(*FString::Printf(TEXT("[%s] Validators never abort by default"), Mode), FinalOnly->DispatchCanStillBeValid(nullptr, nullptr));
+
+		Incremental->bCanStillBeValid = true;
+		TestTrue(*FString::Printf(TEXT("[%s] Dungeon can still be valid"), Mode), Incremental->DispatchCanStillBeValid(nullptr, nullptr));
+
+		Incremental->bCanStillBeValid = false;
+		TestFalse(*FString::Printf(TEXT("[%s] Dungeon can't be valid anymore"), Mode), Incremental->DispatchCanStillBeValid(nullptr, nullptr));
+	}
+	FDungeonRulesDispatch::SetNativeDispatchEnabled(bWasEnabled);
+
+	// The aborting validator is specific to a generation.
+	FDungeonRulesProgram Program;
+	FDungeonRulesRuntimeState State;
+	State.AbortingValidator = Incremental.Get();
+	State.Reset(Program);
+	TestNull(TEXT("No aborting validator in a new generation"), State.AbortingValidator);
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,72 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonValidatorOrder.h"
+#include "UObject/StrongObjectPtr.h"
+#include "DungeonValidatorTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonValidator_OrderTests, "ProceduralDungeon.Rules.Validators.Order", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FDungeonValidator_OrderTests::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<UDV_FinalOnly> Slow(NewObject<UDV_FinalOnly>(GetTransientPackage(), TEXT("Slow")));
+	TStrongObjectPtr<UDV_FinalOnly> Cheap(NewObject<UDV_FinalOnly>(GetTransientPackage(), TEXT("Cheap")));
+	TStrongObjectPtr<UDV_FinalOnly> Expensive(NewObject<UDV_FinalOnly>(GetTransientPackage(), TEXT("Expensive")));
+	TStrongObjectPtr<UDV_FinalOnly> Added(NewObject<UDV_FinalOnly>(GetTransientPackage(), TEXT("Added")));
+	TArray<TObjectPtr<UDungeonValidator>> Validators = {Slow.Get(), nullptr, Cheap.Get(), Expensive.Get()};
+
+	FDungeonValidatorOrder Order;
+	Order.Update(Validators);
+	Order.Sort();
+	TestTrue(TEXT("Authored order when nothing is known"), Order.Get() == TArray<const UDungeonValidator*>({Slow.Get(), Cheap.Get(), Expensive.Get()}));
+
+	// Slow: 1 ms and rarely fails, Cheap: 0.1 ms and fails half of the time, Expensive: 5 ms and almost always fails.
+	for (int32 i = 0; i < 100; ++i)
+	{
+		Order.Record(Slow.Get(), 0.001, i % 10 != 0);
+		Order.Record(Cheap.Get(), 0.0001, i % 2 != 0);
+		Order.Record(Expensive.Get(), 0.005, i % 10 == 0);
+	}
+	Order.Sort();
+	TestTrue(TEXT("Lowest cost per failure first"), Order.Get() == TArray<const UDungeonValidator*>({Cheap.Get(), Expensive.Get(), Slow.Get()}));
+
+	const FDungeonValidatorOrder::FStats* Stats = Order.FindStats(Cheap.Get());
+	if (TestNotNull(TEXT("Stats of the cheap validator"), Stats))
+	{
+		TestEqual(TEXT("Calls of the cheap validator"), Stats->NumCalls, 100);
+		TestEqual(TEXT("Failures of the cheap validator"), Stats->NumFailures, 50);
+	}
+
+	// Stats of another order are added to these ones.
+	FDungeonValidatorOrder Other;
+	Other.Update(Validators);
+	for (int32 i = 0; i < 100; ++i)
+	{
+		Other.Record(Slow.Get(), 0.0001, i % 2 != 0);
+	}
+	Order.Merge(Other);
+	Stats = Order.FindStats(Slow.Get());
+	if (TestNotNull(TEXT("Stats of the slow validator after merge"), Stats))
+	{
+		TestEqual(TEXT("Merged calls of the slow validator"), Stats->NumCalls, 200);
+		TestEqual(TEXT("Merged failures of the slow validator"), Stats->NumFailures, 60);
+	}
+	TestEqual(TEXT("Merge keeps one entry by validator"), Order.Get().Num(), 3);
+	TestTrue(TEXT("Merged order sorted"), Order.Get()[0] == Cheap.Get());
+
+	// New validators are evaluated first, removed ones are forgotten.
+	Validators = {Slow.Get(), Added.Get(), Expensive.Get()};
+	Order.Update(Validators);
+	TestTrue(TEXT("Learned order is kept when validators change"), Order.Get() == TArray<const UDungeonValidator*>({Added.Get(), Expensive.Get(), Slow.Get()}));
+	TestNull(TEXT("Removed validator is forgotten"), Order.FindStats(Cheap.Get()));
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
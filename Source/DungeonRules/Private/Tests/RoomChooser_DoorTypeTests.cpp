@@ -0,0 +1,88 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "DungeonRoomCandidates.h"
+#include "RoomData.h"
+#include "DoorType.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomChooser_DoorTypeTests, "ProceduralDungeon.Rules.RoomChoosers.DoorTypes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+namespace
+{
+	URoomData* CreateRoom(const FName& Name, const TArray<UDoorType*>& DoorTypes)
+	{
+		URoomData* Room = NewObject<URoomData>(GetTransientPackage(), Name);
+		for (UDoorType* DoorType : DoorTypes)
+		{
+			FDoorDef& Door = Room->Doors.AddDefaulted_GetRef();
+			Door.Type = DoorType;
+		}
+		return Room;
+	}
+}
+
+bool FRoomChooser_DoorTypeTests::RunTest(const FString& Parameters)
+{
+	TStrongObjectPtr<UDoorType> TypeA(NewObject<UDoorType>(GetTransientPackage(), TEXT("TypeA")));
+	TStrongObjectPtr<UDoorType> TypeB(NewObject<UDoorType>(GetTransientPackage(), TEXT("TypeB")));
+	TStrongObjectPtr<UDoorType> TypeC(NewObject<UDoorType>(GetTransientPackage(), TEXT("TypeC")));
+
+	TStrongObjectPtr<URoomData> RoomA(CreateRoom(TEXT("RoomA"), {TypeA.Get()}));
+	TStrongObjectPtr<URoomData> RoomB(CreateRoom(TEXT("RoomB"), {TypeB.Get(), TypeB.Get()}));
+	TStrongObjectPtr<URoomData> RoomAB(CreateRoom(TEXT("RoomAB"), {TypeA.Get(), TypeB.Get()}));
+
+	const TArray<URoomData*> RoomList = {RoomA.Get(), RoomB.Get(), RoomAB.Get()};
+	const int32 NumSamples = 1000;
+
+	// Uniform
+	{
+		FDungeonRoomCandidates Candidates;
+		Candidates.Build(RoomList);
+
+		TestNotNull(TEXT("[Uniform] Subset of type A"), Candidates.FindSubset(TypeA.Get()));
+		TestNotNull(TEXT("[Uniform] Subset of type B"), Candidates.FindSubset(TypeB.Get()));
+		TestNull(TEXT("[Uniform] No subset for type C"), Candidates.FindSubset(TypeC.Get()));
+
+		FRandomStream Random(0);
+		bool bOnlyCompatibleA = true;
+		bool bOnlyCompatibleB = true;
+		bool bAnyForTypeC = true;
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			bOnlyCompatibleA &= FDungeonRoomCandidates::IsCompatible(Candidates.Choose(TypeA.Get(), Random), TypeA.Get());
+			bOnlyCompatibleB &= FDungeonRoomCandidates::IsCompatible(Candidates.Choose(TypeB.Get(), Random), TypeB.Get());
+			bAnyForTypeC &= RoomList.Contains(Candidates.Choose(TypeC.Get(), Random));
+		}
+		TestTrue(TEXT("[Uniform] Only rooms compatible with type A"), bOnlyCompatibleA);
+		TestTrue(TEXT("[Uniform] Only rooms compatible with type B"), bOnlyCompatibleB);
+		TestTrue(TEXT("[Uniform] Whole list when no room is compatible"), bAnyForTypeC);
+	}
+
+	// Weighted
+	{
+		FDungeonRoomCandidates Candidates;
+		Candidates.Build(RoomList, {1, 2, 0});
+
+		FRandomStream Random(0);
+		bool bOnlyRoomA = true;
+		bool bOnlyRoomB = true;
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			bOnlyRoomA &= Candidates.Choose(TypeA.Get(), Random) == RoomA.Get();
+			bOnlyRoomB &= Candidates.Choose(TypeB.Get(), Random) == RoomB.Get();
+		}
+		TestTrue(TEXT("[Weighted] Rooms without weight are never picked for type A"), bOnlyRoomA);
+		TestTrue(TEXT("[Weighted] Rooms without weight are never picked for type B"), bOnlyRoomB);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
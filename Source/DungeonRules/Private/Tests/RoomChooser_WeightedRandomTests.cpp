@@ -0,0 +1,204 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "RoomChoosers/DRR_WeightedRandomData.h"
+#include "DungeonAliasTable.h"
+#include "RoomData.h"
+#include "UObject/StrongObjectPtr.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomChooser_WeightedRandomTests, "ProceduralDungeon.Rules.RoomChoosers.WeightedRandom", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FRoomChooser_WeightedRandomBenchmark, "ProceduralDungeon.Rules.RoomChoosers.WeightedRandomBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+namespace
+{
+	// Same algorithm as the previous implementation of the chooser (ADungeonGenerator::GetRandomRoomDataWeighted):
+	// a map built for each call, then a linear walk over the cumulated weights.
+	URoomData* ChooseWithMap(const TArray<FRoomWeightPair>& List, const FRandomStream& Random)
+	{
+		TMap<URoomData*, int> WeightedMap;
+		for (const auto& Pair : List)
+		{
+			WeightedMap.Add(Pair.RoomData.Get(), Pair.Weight);
+		}
+
+		int TotalWeight = 0;
+		for (const auto& Pair : WeightedMap)
+		{
+			TotalWeight += FMath::Max(Pair.Value, 0);
+		}
+
+		int Value = Random.RandRange(0, TotalWeight - 1);
+		for (const auto& Pair : WeightedMap)
+		{
+			Value -= FMath::Max(Pair.Value, 0);
+			if (Value < 0)
+				return Pair.Key;
+		}
+		return nullptr;
+	}
+
+	// Pearson's chi-square statistic of the observed counts against the weights.
+	double ChiSquare(const TArray<int32>& Observed, const TArray<int32>& Weights, int32 NumSamples)
+	{
+		int32 TotalWeight = 0;
+		for (const int32 Weight : Weights)
+		{
+			TotalWeight += Weight;
+		}
+
+		double Result = 0.0;
+		for (int32 i = 0; i < Weights.Num(); ++i)
+		{
+			if (Weights[i] <= 0)
+				continue;
+
+			const double Expected = static_cast<double>(NumSamples) * Weights[i] / TotalWeight;
+			const double Delta = Observed[i] - Expected;
+			Result += (Delta * Delta) / Expected;
+		}
+		return Result;
+	}
+}
+
+bool FRoomChooser_WeightedRandomTests::RunTest(const FString& Parameters)
+{
+	// Empty tables
+	{
+		FRandomStream Random(0);
+		FDungeonAliasTable Table;
+		TestEqual(TEXT("Default table is empty"), Table.Sample(Random), (int32)INDEX_NONE);
+
+		Table.Build({});
+		TestTrue(TEXT("No weight"), Table.IsEmpty());
+
+		Table.Build({0, 0, -1});
+		TestTrue(TEXT("Only null or negative weights"), Table.IsEmpty());
+	}
+
+	// Null and negative weights are never picked
+	{
+		FRandomStream Random(42);
+		FDungeonAliasTable Table;
+		Table.Build({0, 3, -2, 1, 0});
+
+		bool bOnlyValid = true;
+		for (int32 i = 0; i < 10000; ++i)
+		{
+			const int32 Index = Table.Sample(Random);
+			bOnlyValid &= (Index == 1 || Index == 3);
+		}
+		TestTrue(TEXT("Only indices with positive weight are picked"), bOnlyValid);
+	}
+
+	// Distribution of the alias table and of the previous implementation against the expected one.
+	// With 4 degrees of freedom, the chi-square statistic is above 18.47 with a probability of 0.001.
+	{
+		const TArray<int32> Weights = {1, 2, 3, 4, 10};
+		const int32 NumSamples = 100000;
+		const double CriticalValue = 18.47;
+
+		TArray<TStrongObjectPtr<URoomData>> Rooms;
+		TArray<FRoomWeightPair> List;
+		for (int32 i = 0; i < Weights.Num(); ++i)
+		{
+			URoomData* Room = NewObject<URoomData>(GetTransientPackage(), *FString::Printf(TEXT("Room_%d"), i));
+			Rooms.Emplace(Room);
+			List.Add({Room, Weights[i]});
+		}
+
+		TStrongObjectPtr<UDRR_WeightedRandomData> Chooser(NewObject<UDRR_WeightedRandomData>(GetTransientPackage()));
+		Chooser->SetWeightedRoomList(List);
+
+		auto IndexOf = [&Rooms](const URoomData* Room) {
+			return Rooms.IndexOfByPredicate([Room](const TStrongObjectPtr<URoomData>& Ptr) { return Ptr.Get() == Room; });
+		};
+
+		TArray<int32> AliasCounts;
+		TArray<int32> MapCounts;
+		AliasCounts.Init(0, Weights.Num());
+		MapCounts.Init(0, Weights.Num());
+
+		bool bAllFound = true;
+		FRandomStream AliasRandom(1234);
+		FRandomStream MapRandom(1234);
+		for (int32 i = 0; i < NumSamples; ++i)
+		{
+			const int32 AliasIndex = IndexOf(Chooser->ChooseRoomData(AliasRandom));
+			const int32 MapIndex = IndexOf(ChooseWithMap(List, MapRandom));
+			bAllFound &= (AliasIndex != INDEX_NONE && MapIndex != INDEX_NONE);
+			if (AliasIndex != INDEX_NONE)
+				++AliasCounts[AliasIndex];
+			if (MapIndex != INDEX_NONE)
+				++MapCounts[MapIndex];
+		}
+		TestTrue(TEXT("Always returns a room of the list"), bAllFound);
+
+		const double AliasChiSquare = ChiSquare(AliasCounts, Weights, NumSamples);
+		const double MapChiSquare = ChiSquare(MapCounts, Weights, NumSamples);
+		AddInfo(FString::Printf(TEXT("Chi-square: alias table = %.3f, previous implementation = %.3f"), AliasChiSquare, MapChiSquare));
+		TestTrue(TEXT("Alias table follows the weights"), AliasChiSquare < CriticalValue);
+		TestTrue(TEXT("Previous implementation follows the weights"), MapChiSquare < CriticalValue);
+
+		// Same seed gives the same sequence.
+		FRandomStream RandomA(99);
+		FRandomStream RandomB(99);
+		bool bDeterministic = true;
+		for (int32 i = 0; i < 1000; ++i)
+		{
+			bDeterministic &= (Chooser->ChooseRoomData(RandomA) == Chooser->ChooseRoomData(RandomB));
+		}
+		TestTrue(TEXT("Deterministic for a same seed"), bDeterministic);
+	}
+
+	return true;
+}
+
+bool FRoomChooser_WeightedRandomBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumRooms = 32;
+	const int32 NumSamples = 1000000;
+
+	TArray<TStrongObjectPtr<URoomData>> Rooms;
+	TArray<FRoomWeightPair> List;
+	for (int32 i = 0; i < NumRooms; ++i)
+	{
+		URoomData* Room = NewObject<URoomData>(GetTransientPackage(), *FString::Printf(TEXT("Room_%d"), i));
+		Rooms.Emplace(Room);
+		List.Add({Room, 1 + (i % 7)});
+	}
+
+	TStrongObjectPtr<UDRR_WeightedRandomData> Chooser(NewObject<UDRR_WeightedRandomData>(GetTransientPackage()));
+	Chooser->SetWeightedRoomList(List);
+
+	// Prevents the loops from being optimized out.
+	uint64 Checksum = 0;
+
+	FRandomStream MapRandom(0);
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		Checksum += reinterpret_cast<UPTRINT>(ChooseWithMap(List, MapRandom));
+	}
+	const double MapTime = FPlatformTime::Seconds() - StartTime;
+
+	FRandomStream AliasRandom(0);
+	StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < NumSamples; ++i)
+	{
+		Checksum += reinterpret_cast<UPTRINT>(Chooser->ChooseRoomData(AliasRandom));
+	}
+	const double AliasTime = FPlatformTime::Seconds() - StartTime;
+
+	AddInfo(FString::Printf(TEXT("%d samples over %d rooms: previous implementation = %.2f ms, alias table = %.2f ms (checksum %llu)"),
+		NumSamples, NumRooms, MapTime * 1000.0, AliasTime * 1000.0, Checksum));
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
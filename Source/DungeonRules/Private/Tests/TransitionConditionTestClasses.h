@@ -24,6 +24,9 @@ class UDRT_True : public URuleTransitionCondition
 
 public:
 	virtual bool Check_Implementation(ADungeonGenerator*, const TScriptInterface<IReadOnlyRoom>&) const override { return true; }
+
+protected:
+	virtual bool IsNativeThreadSafe() const override { return true; }
 };
 
 // Transition condition that always return false.
@@ -34,4 +37,20 @@ class UDRT_False : public URuleTransitionCondition
 
 public:
 	virtual bool Check_Implementation(ADungeonGenerator*, const TScriptInterface<IReadOnlyRoom>&) const override { return false; }
+
+protected:
+	virtual bool IsNativeThreadSafe() const override { return true; }
+};
+
+// Transition condition returning the value set by the test.
+// Not thread safe, since the value can be changed at any time.
+UCLASS(NotBlueprintable, NotBlueprintType, Hidden)
+class UDRT_Variable : public URuleTransitionCondition
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool Check_Implementation(ADungeonGenerator*, const TScriptInterface<IReadOnlyRoom>&) const override { return bValue; }
+
+	bool bValue {false};
 };
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "TransitionConditions/DRT_LogicalOperator.h"
+#include "TransitionConditions/DRT_NotOperator.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonConditionBytecode.h"
+#include "UObject/StrongObjectPtr.h"
+#include "TransitionConditionTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransitionCondition_BytecodeTests, "ProceduralDungeon.Rules.ConditionBytecode", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+namespace
+{
+	using ConditionList = TArray<TObjectPtr<URuleTransitionCondition>>;
+
+	bool HasCall(const FDungeonConditionBytecode& Bytecode, const FDungeonConditionBytecode::FRange& Range)
+	{
+		for (int32 i = Range.First; i < Range.First + Range.Num; ++i)
+		{
+			if (Bytecode.GetInstructions()[i].OpCode == EDungeonConditionOpCode::Call)
+				return true;
+		}
+		return false;
+	}
+}
+
+bool FTransitionCondition_BytecodeTests::RunTest(const FString& Parameters)
+{
+	CREATE_CONDITION_INSTANCE(UDRT_True, TRUE);
+	CREATE_CONDITION_INSTANCE(UDRT_False, FALSE);
+
+	FDungeonRulesProgram Program;
+	FDungeonRoomHistogram Histogram;
+	Histogram.Reset(Program.RoomCounters);
+	FDungeonRulesEvaluationContext Context;
+	Context.Histogram = &Histogram;
+
+	// The bytecode must give the same result as checking the condition objects.
+	auto TestSameResult = [&](const TCHAR* What, const URuleTransitionCondition* Condition) {
+		const FDungeonConditionBytecode::FRange Range = Program.Bytecode.Compile(Condition, Program);
+		const bool bExpected = Condition->Check(nullptr, nullptr);
+		const bool bResult = Program.Bytecode.Evaluate(Range, Context);
+		if (!TestEqual(What, bResult, bExpected))
+			AddInfo(Program.Bytecode.ToString(Range));
+		return Range;
+	};
+
+	const TArray<::ConditionList> Lists = {
+		{},
+		{FALSE.Get()},
+		{TRUE.Get()},
+		{FALSE.Get(), FALSE.Get(), FALSE.Get()},
+		{TRUE.Get(), TRUE.Get(), TRUE.Get()},
+		{FALSE.Get(), TRUE.Get(), TRUE.Get()},
+		{TRUE.Get(), FALSE.Get(), TRUE.Get()},
+		{TRUE.Get(), TRUE.Get(), FALSE.Get()},
+		{TRUE.Get(), FALSE.Get(), FALSE.Get()},
+		{FALSE.Get(), TRUE.Get(), FALSE.Get()},
+		{FALSE.Get(), FALSE.Get(), TRUE.Get()},
+	};
+
+	// Single operators
+	{
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Operator_AND);
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Operator_OR);
+		Operator_AND->SetOperator(ELogicalOperator::AND);
+		Operator_OR->SetOperator(ELogicalOperator::OR);
+
+		for (int32 i = 0; i < Lists.Num(); ++i)
+		{
+			Operator_AND->SetConditions(Lists[i]);
+			Operator_OR->SetConditions(Lists[i]);
+			TestSameResult(*FString::Printf(TEXT("[AND] list #%d"), i), Operator_AND.Get());
+			TestSameResult(*FString::Printf(TEXT("[OR] list #%d"), i), Operator_OR.Get());
+		}
+
+		CREATE_CONDITION_INSTANCE(UDRT_NotOperator, Operator_NOT);
+		Operator_NOT->SetCondition(nullptr);
+		TestSameResult(TEXT("[NOT] null"), Operator_NOT.Get());
+		Operator_NOT->SetCondition(FALSE.Get());
+		TestSameResult(TEXT("[NOT] false"), Operator_NOT.Get());
+		Operator_NOT->SetCondition(TRUE.Get());
+		TestSameResult(TEXT("[NOT] true"), Operator_NOT.Get());
+	}
+
+	// Nested operators: (A op1 B) op2 NOT(C)
+	{
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Inner);
+		CREATE_CONDITION_INSTANCE(UDRT_NotOperator, Negation);
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Outer);
+		Outer->SetConditions(::ConditionList({Inner.Get(), Negation.Get()}));
+
+		URuleTransitionCondition* Values[] = {FALSE.Get(), TRUE.Get()};
+		for (const ELogicalOperator InnerOp : {ELogicalOperator::AND, ELogicalOperator::OR})
+		{
+			for (const ELogicalOperator OuterOp : {ELogicalOperator::AND, ELogicalOperator::OR})
+			{
+				Inner->SetOperator(InnerOp);
+				Outer->SetOperator(OuterOp);
+				for (int32 Bits = 0; Bits < 8; ++Bits)
+				{
+					Inner->SetConditions(::ConditionList({Values[Bits & 1], Values[(Bits >> 1) & 1]}));
+					Negation->SetCondition(Values[(Bits >> 2) & 1]);
+					TestSameResult(*FString::Printf(TEXT("[Nested] inner %d, outer %d, inputs %d"), (int32)InnerOp, (int32)OuterOp, Bits), Outer.Get());
+				}
+			}
+		}
+	}
+
+	// Built-in only trees don't call any condition object.
+	{
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Empty_AND);
+		CREATE_CONDITION_INSTANCE(UDRT_NotOperator, Not_Empty);
+		CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Root);
+		Empty_AND->SetOperator(ELogicalOperator::AND);
+		Not_Empty->SetCondition(Empty_AND.Get());
+		Root->SetOperator(ELogicalOperator::OR);
+		Root->SetConditions(::ConditionList({Not_Empty.Get(), Empty_AND.Get()}));
+
+		const FDungeonConditionBytecode::FRange Range = TestSameResult(TEXT("[Built-in] OR(NOT(AND()), AND())"), Root.Get());
+		TestFalse(TEXT("[Built-in] No call instruction"), HasCall(Program.Bytecode, Range));
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,136 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "TransitionConditions/DRT_LogicalOperator.h"
+#include "TransitionConditions/DRT_NotOperator.h"
+#include "DungeonRulesDispatch.h"
+#include "UObject/StrongObjectPtr.h"
+#include "TransitionConditionTestClasses.h"
+
+#if WITH_EDITOR
+#include "Engine/Blueprint.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#include "EdGraphSchema_K2.h"
+#include "K2Node_FunctionResult.h"
+#endif
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransitionCondition_DispatchBenchmark, "ProceduralDungeon.Rules.LogicalOperatorsBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+namespace
+{
+	using ConditionList = TArray<TObjectPtr<URuleTransitionCondition>>;
+
+	// Returns the time of a single check of the condition, in nanoseconds.
+	double MeasureCheck(const URuleTransitionCondition* Condition, int32 NumCalls, bool& bOutResult)
+	{
+		int32 NumPassed = 0;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < NumCalls; ++i)
+		{
+			NumPassed += Condition->DispatchCheck(nullptr, nullptr) ? 1 : 0;
+		}
+		const double Duration = FPlatformTime::Seconds() - StartTime;
+		bOutResult = (NumPassed == NumCalls);
+		return Duration * 1e9 / NumCalls;
+	}
+
+#if WITH_EDITOR
+	// Creates a Blueprint condition overriding Check to return true, so it is dispatched with its Blueprint parameters.
+	UBlueprint* CreateBlueprintCondition()
+	{
+		const FName Name = MakeUniqueObjectName(GetTransientPackage(), UBlueprint::StaticClass(), TEXT("BP_DispatchBenchmarkCondition"));
+		UBlueprint* Blueprint = FKismetEditorUtilities::CreateBlueprint(URuleTransitionCondition::StaticClass(), GetTransientPackage(), Name, BPTYPE_Normal, UBlueprint::StaticClass(), UBlueprintGeneratedClass::StaticClass());
+
+		UEdGraph* Graph = FBlueprintEditorUtils::CreateNewGraph(Blueprint, GET_FUNCTION_NAME_CHECKED(URuleTransitionCondition, Check), UEdGraph::StaticClass(), UEdGraphSchema_K2::StaticClass());
+		FBlueprintEditorUtils::AddFunctionGraph<UClass>(Blueprint, Graph, /*bIsUserCreated = */false, URuleTransitionCondition::StaticClass());
+
+		TArray<UK2Node_FunctionResult*> ResultNodes;
+		Graph->GetNodesOfClass(ResultNodes);
+		for (UK2Node_FunctionResult* ResultNode : ResultNodes)
+		{
+			if (UEdGraphPin* ReturnPin = ResultNode->FindPin(UEdGraphSchema_K2::PN_ReturnValue))
+				ReturnPin->DefaultValue = TEXT("true");
+		}
+
+		FKismetEditorUtilities::CompileBlueprint(Blueprint);
+		return Blueprint;
+	}
+#endif
+}
+
+bool FTransitionCondition_DispatchBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumCalls = 200000;
+
+	CREATE_CONDITION_INSTANCE(UDRT_True, TRUE);
+	CREATE_CONDITION_INSTANCE(UDRT_False, FALSE);
+
+	// AND(OR(false, false, true), NOT(false), AND(true, true, true)): 11 conditions checked per call.
+	CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Operator_OR);
+	Operator_OR->SetOperator(ELogicalOperator::OR);
+	Operator_OR->SetConditions(::ConditionList({FALSE.Get(), FALSE.Get(), TRUE.Get()}));
+
+	CREATE_CONDITION_INSTANCE(UDRT_NotOperator, Operator_NOT);
+	Operator_NOT->SetCondition(FALSE.Get());
+
+	CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Operator_AND);
+	Operator_AND->SetOperator(ELogicalOperator::AND);
+	Operator_AND->SetConditions(::ConditionList({TRUE.Get(), TRUE.Get(), TRUE.Get()}));
+
+	CREATE_CONDITION_INSTANCE(UDRT_LogicalOperator, Root);
+	Root->SetOperator(ELogicalOperator::AND);
+	Root->SetConditions(::ConditionList({Operator_OR.Get(), Operator_NOT.Get(), Operator_AND.Get()}));
+
+	const bool bWasEnabled = FDungeonRulesDispatch::IsNativeDispatchEnabled();
+
+	bool bReflectionResult = false;
+	FDungeonRulesDispatch::SetNativeDispatchEnabled(false);
+	const double ReflectionTime = MeasureCheck(Root.Get(), NumCalls, bReflectionResult);
+
+	bool bNativeResult = false;
+	FDungeonRulesDispatch::SetNativeDispatchEnabled(true);
+	const double NativeTime = MeasureCheck(Root.Get(), NumCalls, bNativeResult);
+
+	FDungeonRulesDispatch::SetNativeDispatchEnabled(bWasEnabled);
+
+	// Timings depend on the machine, so they are only reported.
+	AddInfo(FString::Printf(TEXT("Logical operator tree: %.1f ns per check through ProcessEvent, %.1f ns per check with native dispatch."), ReflectionTime, NativeTime));
+	TestTrue(TEXT("Same result through ProcessEvent"), bReflectionResult);
+	TestTrue(TEXT("Same result with native dispatch"), bNativeResult);
+
+#if WITH_EDITOR
+	// A condition overridden in Blueprint is always called through ProcessEvent, with parameters built from the cached layout.
+	TStrongObjectPtr<UBlueprint> Blueprint(CreateBlueprintCondition());
+	if (!TestNotNull(TEXT("Blueprint condition compiled"), Blueprint->GeneratedClass.Get()))
+		return false;
+
+	TStrongObjectPtr<URuleTransitionCondition> BlueprintCondition(NewObject<URuleTransitionCondition>(GetTransientPackage(), Blueprint->GeneratedClass));
+	TestTrue(TEXT("Blueprint condition overrides Check"), BlueprintCondition->HasBlueprintCheck());
+
+	bool bBlueprintReflectionResult = false;
+	FDungeonRulesDispatch::SetNativeDispatchEnabled(false);
+	const double BlueprintReflectionTime = MeasureCheck(BlueprintCondition.Get(), NumCalls, bBlueprintReflectionResult);
+
+	bool bBlueprintDispatchResult = false;
+	FDungeonRulesDispatch::SetNativeDispatchEnabled(true);
+	const double BlueprintDispatchTime = MeasureCheck(BlueprintCondition.Get(), NumCalls, bBlueprintDispatchResult);
+
+	FDungeonRulesDispatch::SetNativeDispatchEnabled(bWasEnabled);
+
+	AddInfo(FString::Printf(TEXT("Blueprint condition: %.1f ns per check through the generated event function, %.1f ns per check with the cached parameter layout."), BlueprintReflectionTime, BlueprintDispatchTime));
+	TestTrue(TEXT("Blueprint result through the generated event function"), bBlueprintReflectionResult);
+	TestTrue(TEXT("Blueprint result with the cached parameter layout"), bBlueprintDispatchResult);
+#endif
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -0,0 +1,129 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "CoreTypes.h"
+#include "Misc/AutomationTest.h"
+#include "TransitionConditions/DRT_LogicalOperator.h"
+#include "TransitionConditions/DRT_NotOperator.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonConditionBytecode.h"
+#include "UObject/StrongObjectPtr.h"
+#include "TransitionConditionTestClasses.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTransitionCondition_SimplificationTests, "ProceduralDungeon.Rules.ConditionSimplification", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+namespace {
+	using ConditionList = TArray<TObjectPtr<URuleTransitionCondition>>;
+}
+
+bool FTransitionCondition_SimplificationTests::RunTest(const FString& Parameters)
+{
+	// Creating condition instances
+	CREATE_CONDITION_INSTANCE(UDRT_Variable, A);
+	CREATE_CONDITION_INSTANCE(UDRT_Variable, B);
+	CREATE_CONDITION_INSTANCE(UDRT_Variable, C);
+	UDRT_Variable* Variables[] = {A.Get(), B.Get(), C.Get()};
+
+	// Keeps the operators alive during the test.
+	TArray<TStrongObjectPtr<URuleTransitionCondition>> Operators;
+	auto AND = [&Operators](const ::ConditionList& List) -> URuleTransitionCondition* {
+		UDRT_LogicalOperator* Operator = NewObject<UDRT_LogicalOperator>(GetTransientPackage());
+		Operator->SetOperator(ELogicalOperator::AND);
+		Operator->SetConditions(List);
+		Operators.Emplace(Operator);
+		return Operator;
+	};
+	auto OR = [&Operators](const ::ConditionList& List) -> URuleTransitionCondition* {
+		UDRT_LogicalOperator* Operator = NewObject<UDRT_LogicalOperator>(GetTransientPackage());
+		Operator->SetOperator(ELogicalOperator::OR);
+		Operator->SetConditions(List);
+		Operators.Emplace(Operator);
+		return Operator;
+	};
+	auto NOT = [&Operators](URuleTransitionCondition* Condition) -> URuleTransitionCondition* {
+		UDRT_NotOperator* Operator = NewObject<UDRT_NotOperator>(GetTransientPackage());
+		Operator->SetCondition(Condition);
+		Operators.Emplace(Operator);
+		return Operator;
+	};
+
+	const TArray<TPair<FString, URuleTransitionCondition*>> Trees = {
+		{TEXT("NOT(NOT(A))"), NOT(NOT(A.Get()))},
+		{TEXT("NOT(NOT(NOT(A)))"), NOT(NOT(NOT(A.Get())))},
+		{TEXT("AND(A)"), AND({A.Get()})},
+		{TEXT("OR(A)"), OR({A.Get()})},
+		{TEXT("AND(A, AND(B, C))"), AND({A.Get(), AND({B.Get(), C.Get()})})},
+		{TEXT("OR(OR(A, B), C)"), OR({OR({A.Get(), B.Get()}), C.Get()})},
+		{TEXT("AND(A, OR(B, C))"), AND({A.Get(), OR({B.Get(), C.Get()})})},
+		{TEXT("AND(A, A, B)"), AND({A.Get(), A.Get(), B.Get()})},
+		{TEXT("OR(A, B, A, B)"), OR({A.Get(), B.Get(), A.Get(), B.Get()})},
+		{TEXT("AND(A, AND())"), AND({A.Get(), AND({})})},
+		{TEXT("OR(A, OR())"), OR({A.Get(), OR({})})},
+		{TEXT("AND(A, NOT(AND()))"), AND({A.Get(), NOT(AND({}))})},
+		{TEXT("OR(A, NOT(OR()))"), OR({A.Get(), NOT(OR({}))})},
+		{TEXT("OR(NOT(AND()), NOT(OR()))"), OR({NOT(AND({})), NOT(OR({}))})},
+		{TEXT("AND(NOT(null), A)"), AND({NOT(nullptr), A.Get()})},
+		{TEXT("OR(NOT(null), A)"), OR({NOT(nullptr), A.Get()})},
+		{TEXT("NOT(AND(A, NOT(NOT(B))))"), NOT(AND({A.Get(), NOT(NOT(B.Get()))}))},
+		{TEXT("AND(OR(A), NOT(NOT(B)), OR(C, C))"), AND({OR({A.Get()}), NOT(NOT(B.Get())), OR({C.Get(), C.Get()})})},
+		{TEXT("OR(AND(A, B), AND(A, B), NOT(C))"), OR({AND({A.Get(), B.Get()}), AND({A.Get(), B.Get()}), NOT(C.Get())})},
+		{TEXT("AND(OR(A, OR(B, AND(C))), AND(AND(A)))"), AND({OR({A.Get(), OR({B.Get(), AND({C.Get()})})}), AND({AND({A.Get()})})})},
+	};
+
+	FDungeonRulesProgram Program;
+	FDungeonRoomHistogram Histogram;
+	Histogram.Reset(Program.RoomCounters);
+	FDungeonRulesEvaluationContext Context;
+	Context.Histogram = &Histogram;
+
+	// The simplified tree must give the same result as the condition objects for all the inputs.
+	for (const auto& Tree : Trees)
+	{
+		const FDungeonConditionBytecode::FRange Original = Program.Bytecode.Compile(Tree.Value, Program, /*bSimplify = */false);
+		const FDungeonConditionBytecode::FRange Simplified = Program.Bytecode.Compile(Tree.Value, Program, /*bSimplify = */true);
+		TestTrue(*FString::Printf(TEXT("%s is not longer when simplified"), *Tree.Key), Simplified.Num <= Original.Num);
+
+		for (int32 Inputs = 0; Inputs < 8; ++Inputs)
+		{
+			for (int32 i = 0; i < 3; ++i)
+			{
+				Variables[i]->bValue = (Inputs >> i) & 1;
+			}
+
+			const bool bExpected = Tree.Value->Check(nullptr, nullptr);
+			const FString What = FString::Printf(TEXT("%s {A=%d, B=%d, C=%d}"), *Tree.Key, Inputs & 1, (Inputs >> 1) & 1, (Inputs >> 2) & 1);
+			TestEqual(*(What + TEXT(" [original]")), Program.Bytecode.Evaluate(Original, Context), bExpected);
+			if (!TestEqual(*(What + TEXT(" [simplified]")), Program.Bytecode.Evaluate(Simplified, Context), bExpected))
+				AddInfo(Program.Bytecode.ToString(Simplified));
+		}
+	}
+
+	// Expected simplifications
+	{
+		// Jump targets depend on where the range is in the bytecode, so only the number of instructions is compared.
+		auto NumSimplified = [&Program](const URuleTransitionCondition* Condition) {
+			return Program.Bytecode.Compile(Condition, Program).Num;
+		};
+
+		TestEqual(TEXT("NOT(NOT(A)) is A"), NumSimplified(NOT(NOT(A.Get()))), 1);
+		TestEqual(TEXT("AND(A) is A"), NumSimplified(AND({A.Get()})), 1);
+		TestEqual(TEXT("OR(OR(), A) is true"), NumSimplified(OR({OR({}), A.Get()})), 1);
+		TestEqual(TEXT("AND(NOT(AND()), A) is false"), NumSimplified(AND({NOT(AND({})), A.Get()})), 1);
+		TestEqual(TEXT("OR(NOT(AND()), NOT(OR())) is false"), NumSimplified(OR({NOT(AND({})), NOT(OR({}))})), 1);
+		// A, JUMP, B, JUMP, C
+		TestEqual(TEXT("AND(A, AND(B, C)) is AND(A, B, C)"), NumSimplified(AND({A.Get(), AND({B.Get(), C.Get()})})), 5);
+
+		// Calls may have side effects, so they are all kept, as well as the constant after them.
+		TestEqual(TEXT("AND(A, A, A) keeps its calls"), NumSimplified(AND({A.Get(), A.Get(), A.Get()})), 5);
+		TestEqual(TEXT("OR(A, OR()) keeps its call"), NumSimplified(OR({A.Get(), OR({})})), 3);
+		TestEqual(TEXT("AND(A, NOT(AND()), B) is AND(A, false)"), NumSimplified(AND({A.Get(), NOT(AND({})), B.Get()})), 3);
+	}
+
+	return true;
+}
+
+#endif //WITH_DEV_AUTOMATION_TESTS
@@ -5,6 +5,9 @@
 
 #include "TransitionConditions/DRT_LogicalOperator.h"
 #include "RoomData.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonConditionExpression.h"
+#include "DungeonRulesEvaluationContext.h"
 
 #define LOCTEXT_NAMESPACE "DRT_LogicalOperator"
 
@@ -15,15 +18,43 @@ bool UDRT_LogicalOperator::Check_Implementation(ADungeonGenerator* Generator, co
 	if (Conditions.Num() <= 0)
 		return true;
 
+	// A missing condition is false, as in CheckWithContext.
 	const bool OperatorResult = static_cast<bool>(Operator);
 	for (const URuleTransitionCondition* Condition : Conditions)
 	{
-		if (Condition->Check(Generator, PreviousRoom) != OperatorResult)
+		const bool bResult = Condition && Condition->DispatchCheck(Generator, PreviousRoom);
+		if (bResult != OperatorResult)
 			return !OperatorResult;
 	}
 	return OperatorResult;
 }
 
+bool UDRT_LogicalOperator::CheckWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	if (Conditions.Num() <= 0)
+		return true;
+
+	// Same as the compiled expression: a missing condition is false.
+	const bool OperatorResult = static_cast<bool>(Operator);
+	for (const URuleTransitionCondition* Condition : Conditions)
+	{
+		const bool bResult = Condition && Condition->DispatchCheck(Context);
+		if (bResult != OperatorResult)
+			return !OperatorResult;
+	}
+	return OperatorResult;
+}
+
+bool UDRT_LogicalOperator::IsNativeThreadSafe() const
+{
+	for (const URuleTransitionCondition* Condition : Conditions)
+	{
+		if (Condition && !Condition->IsThreadSafe())
+			return false;
+	}
+	return true;
+}
+
 FText UDRT_LogicalOperator::GetDescription_Implementation() const
 {
 	switch (Operator)
@@ -38,4 +69,26 @@ FText UDRT_LogicalOperator::GetDescription_Implementation() const
 	return FText();
 }
 
+void UDRT_LogicalOperator::OnCompile(FDungeonRulesProgram& Program) const
+{
+	for (const URuleTransitionCondition* Condition : Conditions)
+	{
+		if (Condition)
+			Condition->OnCompile(Program);
+	}
+}
+
+int32 UDRT_LogicalOperator::BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const
+{
+	TArray<int32> Children;
+	Children.Reserve(Conditions.Num());
+	for (const URuleTransitionCondition* Condition : Conditions)
+	{
+		Children.Add(Expression.AddCondition(Condition, Program));
+	}
+
+	const EDungeonConditionNodeType Type = (Operator == ELogicalOperator::AND) ? EDungeonConditionNodeType::And : EDungeonConditionNodeType::Or;
+	return Expression.AddGroup(Type, MoveTemp(Children));
+}
+
 #undef LOCTEXT_NAMESPACE
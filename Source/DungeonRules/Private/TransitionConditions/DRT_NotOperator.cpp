@@ -5,12 +5,25 @@
 
 #include "TransitionConditions/DRT_NotOperator.h"
 #include "RoomData.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonConditionExpression.h"
+#include "DungeonRulesEvaluationContext.h"
 
 #define LOCTEXT_NAMESPACE "DRT_NotOperator"
 
 bool UDRT_NotOperator::Check_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
 {
-	return Condition && !Condition->Check(Generator, PreviousRoom);
+	return Condition && !Condition->DispatchCheck(Generator, PreviousRoom);
+}
+
+bool UDRT_NotOperator::CheckWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	return Condition && !Condition->DispatchCheck(Context);
+}
+
+bool UDRT_NotOperator::IsNativeThreadSafe() const
+{
+	return !Condition || Condition->IsThreadSafe();
 }
 
 FText UDRT_NotOperator::GetDescription_Implementation() const
@@ -22,4 +35,19 @@ FText UDRT_NotOperator::GetDescription_Implementation() const
 	return FText::Format(LOCTEXT("Description", "True when this condition is false:\n- {0}"), ChildConditionDescription);
 }
 
+void UDRT_NotOperator::OnCompile(FDungeonRulesProgram& Program) const
+{
+	if (Condition)
+		Condition->OnCompile(Program);
+}
+
+int32 UDRT_NotOperator::BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const
+{
+	// Same as Check_Implementation: false when there is no condition.
+	if (!Condition)
+		return Expression.AddConstant(false);
+
+	return Expression.AddNot(Expression.AddCondition(Condition, Program));
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -7,19 +7,65 @@
 #include "DungeonGenerator.h"
 #include "DungeonGraph.h"
 #include "RoomData.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonConditionExpression.h"
+#include "DungeonRulesEvaluationContext.h"
+#include "DungeonRulesLog.h"
 
 #define LOCTEXT_NAMESPACE "DRT_RoomClassCount"
 
 bool UDRT_RoomClassCount::Check_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
 {
-	check(IsValid(Generator));
-	const int Result = (RoomClassToCount.Num() > 0)
-		? Generator->GetRooms()->CountTotalRoomType(RoomClassToCount)
-		: Generator->GetRooms()->Count();
+	// Nothing to count without generator (e.g. simulated without histogram).
+	if (!IsValid(Generator))
+		return false;
+
+	int Result = 0;
+	if (RoomClassToCount.Num() <= 0)
+	{
+		Result = Generator->GetRooms()->Count();
+	}
+	else
+	{
+		// Use the counts maintained by the generator when available, instead of iterating over all rooms.
+		const FDungeonRoomHistogram* Histogram = FDungeonRoomHistogram::Get(Generator);
+		if (!Histogram || !Histogram->GetCount(this, Result))
+			Result = Generator->GetRooms()->CountTotalRoomType(RoomClassToCount);
+	}
 
 	return FComparisonHelper::Check(Result, Count, Comparison);
 }
 
+bool UDRT_RoomClassCount::CheckWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	if (!Context.Histogram)
+		return CheckGeneratorRooms(Context);
+
+	int Result = 0;
+	if (RoomClassToCount.Num() <= 0)
+		Result = Context.Histogram->GetTotal();
+	else if (!Context.Histogram->GetCount(this, Result))
+		return CheckGeneratorRooms(Context);
+
+	return FComparisonHelper::Check(Result, Count, Comparison);
+}
+
+bool UDRT_RoomClassCount::CheckGeneratorRooms(const FDungeonRulesEvaluationContext& Context) const
+{
+	if (!IsInGameThread())
+	{
+		RulesLog_Error("'%s' has no room counter in the histogram, it can't count the rooms outside of the game thread. Compile the dungeon rules again.", *GetName());
+		return false;
+	}
+	return Super::CheckWithContext(Context);
+}
+
+bool UDRT_RoomClassCount::IsNativeThreadSafe() const
+{
+	// Same as UDRT_RoomDataCount: only reads the histogram outside of the game thread.
+	return true;
+}
+
 FText UDRT_RoomClassCount::GetDescription_Implementation() const
 {
 	FText CompareText = FComparisonHelper::GetComparisonText(Comparison, Count);
@@ -32,4 +78,23 @@ FText UDRT_RoomClassCount::GetDescription_Implementation() const
 	return FText::Format(LOCTEXT("Description", "True when the dungeon has {0} room(s){1}."), CompareText, ClassText);
 }
 
+void UDRT_RoomClassCount::OnCompile(FDungeonRulesProgram& Program) const
+{
+	if (RoomClassToCount.Num() > 0)
+		Program.RoomCounters.AddRoomClassBucket(this, RoomClassToCount);
+}
+
+int32 UDRT_RoomClassCount::BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const
+{
+	if (RoomClassToCount.Num() <= 0)
+		return Expression.AddCount(INDEX_NONE, Count, Comparison);
+
+	// The bucket has been registered by OnCompile.
+	const int32 Bucket = Program.RoomCounters.FindBucket(this);
+	if (Bucket == INDEX_NONE)
+		return Expression.AddCall(this);
+
+	return Expression.AddCount(Bucket, Count, Comparison);
+}
+
 #undef LOCTEXT_NAMESPACE
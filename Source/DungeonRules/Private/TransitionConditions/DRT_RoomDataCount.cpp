@@ -7,19 +7,66 @@
 #include "DungeonGenerator.h"
 #include "DungeonGraph.h"
 #include "RoomData.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonConditionExpression.h"
+#include "DungeonRulesEvaluationContext.h"
+#include "DungeonRulesLog.h"
 
 #define LOCTEXT_NAMESPACE "DRT_RoomDataCount"
 
 bool UDRT_RoomDataCount::Check_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const
 {
-	check(IsValid(Generator));
-	const int Result = (RoomDataToCount.Num() > 0)
-		? Generator->GetRooms()->CountTotalRoomData(RoomDataToCount)
-		: Generator->GetRooms()->Count();
+	// Nothing to count without generator (e.g. simulated without histogram).
+	if (!IsValid(Generator))
+		return false;
+
+	int Result = 0;
+	if (RoomDataToCount.Num() <= 0)
+	{
+		Result = Generator->GetRooms()->Count();
+	}
+	else
+	{
+		// Use the counts maintained by the generator when available, instead of iterating over all rooms.
+		const FDungeonRoomHistogram* Histogram = FDungeonRoomHistogram::Get(Generator);
+		if (!Histogram || !Histogram->GetCount(this, Result))
+			Result = Generator->GetRooms()->CountTotalRoomData(RoomDataToCount);
+	}
 
 	return FComparisonHelper::Check(Result, Count, Comparison);
 }
 
+bool UDRT_RoomDataCount::CheckWithContext(const FDungeonRulesEvaluationContext& Context) const
+{
+	if (!Context.Histogram)
+		return CheckGeneratorRooms(Context);
+
+	int Result = 0;
+	if (RoomDataToCount.Num() <= 0)
+		Result = Context.Histogram->GetTotal();
+	else if (!Context.Histogram->GetCount(this, Result))
+		return CheckGeneratorRooms(Context);
+
+	return FComparisonHelper::Check(Result, Count, Comparison);
+}
+
+bool UDRT_RoomDataCount::CheckGeneratorRooms(const FDungeonRulesEvaluationContext& Context) const
+{
+	if (!IsInGameThread())
+	{
+		RulesLog_Error("'%s' has no room counter in the histogram, it can't count the rooms outside of the game thread. Compile the dungeon rules again.", *GetName());
+		return false;
+	}
+	return Super::CheckWithContext(Context);
+}
+
+bool UDRT_RoomDataCount::IsNativeThreadSafe() const
+{
+	// The counter of this condition is registered when the program is compiled, so the histogram of the context is used.
+	// The rooms of the generator are never read outside of the game thread (see CheckGeneratorRooms).
+	return true;
+}
+
 FText UDRT_RoomDataCount::GetDescription_Implementation() const
 {
 	FText CompareText = FComparisonHelper::GetComparisonText(Comparison, Count);
@@ -32,4 +79,23 @@ FText UDRT_RoomDataCount::GetDescription_Implementation() const
 	return FText::Format(LOCTEXT("Description", "True when the dungeon has {0} room(s){1}."), CompareText, DataText);
 }
 
+void UDRT_RoomDataCount::OnCompile(FDungeonRulesProgram& Program) const
+{
+	if (RoomDataToCount.Num() > 0)
+		Program.RoomCounters.AddRoomDataBucket(this, RoomDataToCount);
+}
+
+int32 UDRT_RoomDataCount::BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const
+{
+	if (RoomDataToCount.Num() <= 0)
+		return Expression.AddCount(INDEX_NONE, Count, Comparison);
+
+	// The bucket has been registered by OnCompile.
+	const int32 Bucket = Program.RoomCounters.FindBucket(this);
+	if (Bucket == INDEX_NONE)
+		return Expression.AddCall(this);
+
+	return Expression.AddCount(Bucket, Count, Comparison);
+}
+
 #undef LOCTEXT_NAMESPACE
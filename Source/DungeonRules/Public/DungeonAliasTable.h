@@ -0,0 +1,30 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// Alias table (Vose's method) to pick a weighted random index in constant time.
+// Built once from the weights, then sampled without any allocation.
+struct DUNGEONRULES_API FDungeonAliasTable
+{
+public:
+	// Builds the table from the weights. Null or negative weights are never picked.
+	// The table is empty if the sum of the weights is not positive.
+	void Build(TArrayView<const int32> Weights);
+	void Reset();
+
+	FORCEINLINE int32 Num() const { return Probabilities.Num(); }
+	FORCEINLINE bool IsEmpty() const { return Probabilities.Num() <= 0; }
+
+	// Returns an index with a probability proportional to its weight, or INDEX_NONE if the table is empty.
+	int32 Sample(const FRandomStream& Random) const;
+
+private:
+	// Probability to keep the column index instead of its alias.
+	TArray<float> Probabilities;
+	TArray<int32> Aliases;
+};
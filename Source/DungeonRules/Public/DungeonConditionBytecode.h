@@ -0,0 +1,106 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ScriptInterface.h"
+#include "DungeonRulesTypes.h"
+
+class ADungeonGenerator;
+class IReadOnlyRoom;
+class URuleTransitionCondition;
+struct FDungeonRoomHistogram;
+struct FDungeonRulesProgram;
+struct FDungeonConditionExpression;
+struct FDungeonRulesEvaluationContext;
+
+enum class EDungeonConditionOpCode : uint8
+{
+	Constant,		// Result = Operand != 0
+	Call,			// Result = Calls[Operand]->Check()
+	CountTotal,		// Result = Compare(total number of rooms, Value)
+	CountBucket,	// Result = Compare(number of rooms in the histogram bucket Operand, Value)
+	Not,			// Result = !Result
+	JumpIfFalse,	// Continue at instruction Operand when Result is false
+	JumpIfTrue,		// Continue at instruction Operand when Result is true
+};
+
+struct FDungeonConditionInstruction
+{
+	friend FArchive& operator<<(FArchive& Ar, FDungeonConditionInstruction& Instruction)
+	{
+		Ar << Instruction.OpCode;
+		Ar << Instruction.Comparison;
+		Ar << Instruction.Operand;
+		Ar << Instruction.Value;
+		return Ar;
+	}
+
+	EDungeonConditionOpCode OpCode {EDungeonConditionOpCode::Constant};
+	EComparisonOp Comparison {EComparisonOp::Equal};
+	int32 Operand {0};
+	int32 Value {0};
+};
+
+// Condition trees compiled into a flat list of instructions.
+// Built-in conditions are evaluated by the instructions, without calling the condition objects.
+// Other conditions (custom C++ or Blueprint) are a single Call instruction.
+// Operands are evaluated in postfix order, and AND/OR short-circuit by jumping to their end.
+// Since each sub-expression leaves its value in a single result register, the machine does not need a stack.
+struct DUNGEONRULES_API FDungeonConditionBytecode
+{
+	// A contiguous range in the Instructions array, compiled from a single condition tree.
+	struct FRange
+	{
+		int32 First {0};
+		int32 Num {0};
+
+		friend FArchive& operator<<(FArchive& Ar, FRange& Range)
+		{
+			Ar << Range.First;
+			Ar << Range.Num;
+			return Ar;
+		}
+	};
+
+public:
+	void Reset();
+	void Serialize(FArchive& Ar);
+
+	// Compiles the condition tree into a new range of instructions, simplifying it first when asked.
+	// The room counters used by the tree must already be registered in the histogram layout.
+	FRange Compile(const URuleTransitionCondition* Condition, const FDungeonRulesProgram& Program, bool bSimplify = true);
+
+	// Compiles a node of the expression into a new range of instructions.
+	FRange Compile(const FDungeonConditionExpression& Expression, int32 Root);
+
+	// Appends an instruction and returns its index.
+	int32 Emit(EDungeonConditionOpCode OpCode, int32 Operand = 0, int32 Value = 0, EComparisonOp Comparison = EComparisonOp::Equal);
+	int32 EmitCall(const URuleTransitionCondition* Condition);
+
+	// Makes the jump instruction continue after the last emitted instruction.
+	void PatchJump(int32 JumpIndex);
+
+	// Runs the instructions of the range.
+	// The context must have a histogram using the room counter layout of the program.
+	// Thread safe when all the called conditions are.
+	bool Evaluate(const FRange& Range, const FDungeonRulesEvaluationContext& Context) const;
+
+	FORCEINLINE int32 Num() const { return Instructions.Num(); }
+	FORCEINLINE const TArray<FDungeonConditionInstruction>& GetInstructions() const { return Instructions; }
+
+	// Writes the instructions of the range in a human readable form.
+	FString ToString(const FRange& Range) const;
+
+private:
+	void EmitNode(const FDungeonConditionExpression& Expression, int32 Node);
+
+private:
+	TArray<FDungeonConditionInstruction> Instructions;
+
+	// Conditions not compiled into instructions, called by the Call instructions.
+	TArray<const URuleTransitionCondition*> Calls;
+};
@@ -0,0 +1,71 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonRulesTypes.h"
+
+class URuleTransitionCondition;
+struct FDungeonRulesProgram;
+
+enum class EDungeonConditionNodeType : uint8
+{
+	Constant,		// Value != 0
+	Call,			// Check of a condition object
+	CountTotal,		// Compare(total number of rooms, Value)
+	CountBucket,	// Compare(number of rooms in the histogram bucket Operand, Value)
+	Not,
+	And,			// True when there is no child
+	Or,				// True when there is no child
+};
+
+// Condition tree built from the condition objects when compiling the dungeon rules.
+// It can be simplified before being compiled into bytecode, without modifying the condition objects.
+struct DUNGEONRULES_API FDungeonConditionExpression
+{
+	struct FNode
+	{
+		EDungeonConditionNodeType Type {EDungeonConditionNodeType::Constant};
+		EComparisonOp Comparison {EComparisonOp::Equal};
+		int32 Operand {0};
+		int32 Value {0};
+		const URuleTransitionCondition* Object {nullptr};
+		TArray<int32> Children;
+	};
+
+public:
+	void Reset();
+
+	// Adds the nodes of the condition tree, and returns the index of its root node.
+	// A null condition is false, and a condition overridden in Blueprint is always a single call.
+	int32 AddCondition(const URuleTransitionCondition* Condition, const FDungeonRulesProgram& Program);
+
+	int32 AddConstant(bool bValue);
+	int32 AddCall(const URuleTransitionCondition* Condition);
+	int32 AddCount(int32 Bucket, int32 Value, EComparisonOp Comparison);
+	int32 AddNot(int32 Child);
+	int32 AddGroup(EDungeonConditionNodeType Type, TArray<int32>&& Children);
+
+	// Returns a simplified version of the tree, giving the same results:
+	// folds constants, removes double negations, flattens nested groups of same type and removes duplicated room counts.
+	// Calls are kept as written, since a condition may have side effects (e.g. drawing from the random stream).
+	int32 Simplify(int32 Root);
+
+	FORCEINLINE const FNode& GetNode(int32 Index) const { return Nodes[Index]; }
+	FORCEINLINE int32 Num() const { return Nodes.Num(); }
+
+private:
+	int32 AddNode(EDungeonConditionNodeType Type);
+	int32 SimplifyGroup(int32 Index);
+	bool IsConstant(int32 Index, bool bValue) const;
+	bool IsSameLeaf(int32 A, int32 B) const;
+
+	// True when the node or one of its descendants is a call.
+	bool HasCall(int32 Index) const;
+
+private:
+	TArray<FNode> Nodes;
+};
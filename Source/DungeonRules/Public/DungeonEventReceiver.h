@@ -11,6 +11,20 @@
 
 class ADungeonGenerator;
 class URoom;
+struct FDungeonRulesEvent;
+
+// Events routed by the dungeon rules to the event receivers.
+enum class EDungeonEvent : uint8
+{
+	OnPreGeneration,
+	OnPostGeneration,
+	OnGenerationInit,
+	OnGenerationFailed,
+	OnRoomAdded,
+	OnFailedToAddRoom,
+	OnRoomsAdded,
+	Count
+};
 
 UCLASS(Abstract, BlueprintType, Blueprintable, EditInlineNew)
 class DUNGEONRULES_API UDungeonEventReceiver : public UObject
@@ -18,6 +32,10 @@ class DUNGEONRULES_API UDungeonEventReceiver : public UObject
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	//~ End UObject Interface
+
 	UFUNCTION(BlueprintNativeEvent, Category = "Dungeon Rules")
 	void OnPreGeneration(ADungeonGenerator* Generator);
 
@@ -35,4 +53,42 @@ public:
 
 	UFUNCTION(BlueprintNativeEvent, Category = "Dungeon Rules")
 	void OnFailedToAddRoom(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor);
+
+	// Called once before OnPostGeneration with all the rooms added during the generation, in the order they have been added.
+	// Only called when Batch Room Added is enabled.
+	UFUNCTION(BlueprintNativeEvent, Category = "Dungeon Rules")
+	void OnRoomsAdded(ADungeonGenerator* Generator, const TArray<TScriptInterface<IReadOnlyRoom>>& NewRooms);
+
+	// Same as the events above, but calling their C++ implementation directly when they are not implemented in Blueprint.
+	// Use those ones from C++.
+	void DispatchOnPreGeneration(ADungeonGenerator* Generator);
+	void DispatchOnPostGeneration(ADungeonGenerator* Generator);
+	void DispatchOnGenerationInit(ADungeonGenerator* Generator);
+	void DispatchOnGenerationFailed(ADungeonGenerator* Generator);
+	void DispatchOnRoomAdded(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom);
+	void DispatchOnFailedToAddRoom(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor);
+	void DispatchOnRoomsAdded(ADungeonGenerator* Generator, const TArray<TScriptInterface<IReadOnlyRoom>>& NewRooms);
+
+	// True when the event is implemented by the class of this receiver, so the dungeon rules have to route it.
+	bool IsSubscribedTo(EDungeonEvent Event) const;
+
+protected:
+	// Override it to return false for the events the C++ class does not implement, so they are not routed to it.
+	// Not called for Blueprint classes deriving directly from this one, since the C++ implementations are empty.
+	virtual bool HasNativeEvent(EDungeonEvent Event) const { return true; }
+
+	// Receives all the added rooms at once with OnRoomsAdded at the end of the generation, instead of OnRoomAdded for each room.
+	// Better for receivers only gathering data from the rooms, since nothing is done for them while the rooms are placed.
+	UPROPERTY(EditAnywhere, Category = "Event Receiver")
+	bool bBatchRoomAdded {false};
+
+private:
+	// Blueprint implementations of the events, if any.
+	TSharedPtr<const FDungeonRulesEvent> BlueprintOnPreGeneration;
+	TSharedPtr<const FDungeonRulesEvent> BlueprintOnPostGeneration;
+	TSharedPtr<const FDungeonRulesEvent> BlueprintOnGenerationInit;
+	TSharedPtr<const FDungeonRulesEvent> BlueprintOnGenerationFailed;
+	TSharedPtr<const FDungeonRulesEvent> BlueprintOnRoomAdded;
+	TSharedPtr<const FDungeonRulesEvent> BlueprintOnFailedToAddRoom;
+	TSharedPtr<const FDungeonRulesEvent> BlueprintOnRoomsAdded;
 };
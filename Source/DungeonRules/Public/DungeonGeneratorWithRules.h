@@ -7,10 +7,20 @@
 
 #include "CoreMinimal.h"
 #include "DungeonGenerator.h"
+#include "DungeonRules.h"
+#include "DungeonRulesRuntimeState.h"
+#include "DungeonRulesSimulator.h"
+#include "DungeonRulesHeatmap.h"
+#include "Containers/Ticker.h"
+#include "Tasks/Task.h"
+#include "UObject/StrongObjectPtr.h"
 #include "DungeonGeneratorWithRules.generated.h"
 
-class UDungeonRule;
-class UDungeonRules;
+class UDungeonValidator;
+
+DECLARE_DYNAMIC_DELEGATE(FDungeonRoomDataLoadedDelegate);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDungeonPlanningProgressEvent, int32, NumPlannedRooms);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FDungeonPlanningFinishedEvent, bool, bSuccess);
 
 UCLASS(ClassGroup = "Procedural Dungeon", meta = (KismetHideOverrides = "ChooseFirstRoomData,ChooseNextRoomData,ContinueToAddRoom"))
 class DUNGEONRULES_API ADungeonGeneratorWithRules : public ADungeonGenerator
@@ -33,11 +43,178 @@ public:
 	virtual void OnFailedToAddRoom_Implementation(const URoomData* FromRoom, const FDoorDef& FromDoor) override;
 	//~ End ADungeonGenerator Interface
 
+	//~ Begin AActor Interface
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+	//~ End AActor Interface
+
+	// Writes the last rule decisions of this generator in the log, or in a binary file when a path is provided.
+	// The decisions are only recorded when the console variable 'DungeonRules.Trace' is greater than 0.
+	UFUNCTION(BlueprintCallable, Category = "Dungeon Rules")
+	void DumpRulesTrace(const FString& FilePath = TEXT("")) const;
+
+	FORCEINLINE const FDungeonRulesTracer& GetRulesTracer() const { return RulesState.Tracer; }
+
+	// Visits and evaluation time of the rules and transitions, accumulated from the trace at the end of each generation.
+	// Shown in the dungeon rules editor; the trace must be large enough to hold a whole generation.
+	FORCEINLINE const FDungeonRulesHeatmap& GetRulesHeatmap() const { return RulesHeatmap; }
+
+	FORCEINLINE const UDungeonRules* GetDungeonRules() const { return DungeonRules; }
+
+	// Streams the room data the dungeon rules can choose, so the generation does not have to load them synchronously.
+	// The event is called once they are all loaded, the dungeon can then be generated.
+	UFUNCTION(BlueprintCallable, Category = "Dungeon Rules")
+	void PreloadRoomData(const FDungeonRoomDataLoadedDelegate& OnLoaded);
+
+	// Number of rooms added during the current generation, for each room counter of the dungeon rules.
+	FORCEINLINE const FDungeonRoomHistogram& GetRoomHistogram() const { return RulesState.Histogram; }
+
+	// Simulates SpeculativeCandidates seeds on worker threads, then generates the dungeon with the first one
+	// whose layout is accepted by the validators, replaying its choices as GenerateTimeSliced does.
+	// The dungeon is generated at once, without simulation, when the rules are not thread safe
+	// or when none of their validators supports the layout validation.
+	UFUNCTION(BlueprintCallable, Category = "Dungeon Rules")
+	void GenerateSpeculative();
+
+	// Plans the rule decisions over several frames, using at most TimeSliceBudget each frame,
+	// then generates the dungeon with the seed of the plan (whatever the seed type, which is restored afterwards).
+	// While the generation follows the plan, the planned rooms and rules are replayed: the room choosers and transitions
+	// are not evaluated again (nor traced), and the random stream is advanced as they advanced it.
+	// The plan is simulated and the generator may place the rooms differently, so each replayed choice is first checked
+	// against the generation (current rule, parent room and door, number of rooms and random stream).
+	// From the first choice which differs, the rules are evaluated as in Generate(): the dungeon is the same as Generate() for the same seed.
+	// Only the rules are time sliced: the rooms are spawned, validated and sent to the event receivers in a single frame, as in Generate().
+	// The dungeon is generated at once when the rules are not thread safe, since their decisions could not be planned.
+	UFUNCTION(BlueprintCallable, Category = "Dungeon Rules")
+	void GenerateTimeSliced();
+
+	UFUNCTION(BlueprintPure, Category = "Dungeon Rules")
+	FORCEINLINE bool IsPlanning() const { return PlanningTicker.IsValid(); }
+
+	UFUNCTION(BlueprintPure, Category = "Dungeon Rules")
+	FORCEINLINE int32 GetNumPlannedRooms() const { return PlanningLayout.Rooms.Num(); }
+
+	// Rough completion of the planning: rooms whose doors are all processed over the rooms planned so far.
+	UFUNCTION(BlueprintPure, Category = "Dungeon Rules")
+	float GetPlanningProgress() const;
+
+	// Called after each frame of the planning started by GenerateTimeSliced.
+	UPROPERTY(BlueprintAssignable, Category = "Dungeon Rules")
+	FDungeonPlanningProgressEvent OnPlanningProgress;
+
+	// Called when the planning (or the speculative generation) is finished, just before generating the dungeon when it succeeded.
+	UPROPERTY(BlueprintAssignable, Category = "Dungeon Rules")
+	FDungeonPlanningFinishedEvent OnPlanningFinished;
+
+	// Index of the first planned (or speculative) choice which differed from the last generation,
+	// INDEX_NONE when the generation has replayed its whole plan or had no plan (see WasPlanReplayed).
+	UFUNCTION(BlueprintPure, Category = "Dungeon Rules")
+	FORCEINLINE int32 GetPlanDivergence() const { return PlanDivergence; }
+
+	// Number of planned (or speculative) choices replayed by the last generation.
+	UFUNCTION(BlueprintPure, Category = "Dungeon Rules")
+	FORCEINLINE int32 GetNumReplayedChoices() const { return NumReplayedChoices; }
+
+	// False when the last generation had no plan, dropped it or diverged from its first choice.
+	UFUNCTION(BlueprintPure, Category = "Dungeon Rules")
+	FORCEINLINE bool WasPlanReplayed() const { return NumReplayedChoices > 0; }
+
+	// Validator which has aborted the current generation, nullptr if the generation has not been aborted.
+	FORCEINLINE const UDungeonValidator* GetAbortingValidator() const { return RulesState.AbortingValidator; }
+
+	// Number of generations each validator has aborted since this generator has been created.
+	FORCEINLINE const TMap<const UDungeonValidator*, int32>& GetValidatorAborts() const { return ValidatorAborts; }
+
+	// Everything the dungeon rules modify during the generation of this generator.
+	FORCEINLINE const FDungeonRulesRuntimeState& GetRulesState() const { return RulesState; }
+
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon Rules")
 	TObjectPtr<UDungeonRules> DungeonRules {nullptr};
 
+	// Number of seeds simulated on worker threads by GenerateSpeculative (0 to disable).
+	// The first seed whose abstract layout is accepted by the validators is then replayed by this generator,
+	// so strict validators reject most of the bad dungeons before any room is spawned.
+	// Only used when the dungeon rules are thread safe and a validator supports the layout validation.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon Rules|Speculative Generation", meta = (ClampMin = 0))
+	int32 SpeculativeCandidates {0};
+
+	// A candidate is rejected when its simulation reaches this number of rooms before the rules stop it.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon Rules|Speculative Generation", meta = (ClampMin = 1, EditCondition = "SpeculativeCandidates > 0"))
+	int32 SpeculativeMaxRooms {500};
+
+	// Maximum time spent each frame to plan the dungeon in GenerateTimeSliced.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon Rules|Time Slicing", meta = (ClampMin = 0.1, Units = "ms"))
+	float TimeSliceBudget {2.0f};
+
+	// The planning ends when this number of rooms is reached, even if the rules didn't stop.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Dungeon Rules|Time Slicing", meta = (ClampMin = 1))
+	int32 TimeSliceMaxRooms {500};
+
 private:
-	UPROPERTY(Transient)
-	TObjectPtr<const UDungeonRule> CurrentRule {nullptr};
+	bool TickPlanning(float DeltaTime);
+	bool TickSpeculation(float DeltaTime);
+	void StopPlanning();
+
+	// Seed the next generation would use with the current seed type.
+	int32 GetNextGenerationSeed() const;
+
+	// Generates the dungeon with the seed of the replay choices.
+	void GeneratePlanned(int32 Seed);
+
+	// Gets the next choice of the replayed plan, or returns false when there is nothing to replay.
+	// Stops the replay when the state of the generation is not the one the plan had for this choice.
+	bool ReplayChoice(const TScriptInterface<IReadOnlyRoom>& ParentRoom, const FDoorDef* ParentDoor, URoomData*& OutRoom, int& OutDoorIndex);
+	bool IsPlannedStep(const FDungeonSimulatedChoice& Choice, const TScriptInterface<IReadOnlyRoom>& ParentRoom, const FDoorDef* ParentDoor);
+	void StopReplay(int32 DivergentChoice);
+
+private:
+	// Current rule, caches and counters of the generation.
+	// The dungeon rules asset is shared with other generators, so it does not hold any of them.
+	FDungeonRulesRuntimeState RulesState;
+
+	// Only filled when the trace is enabled.
+	FDungeonRulesHeatmap RulesHeatmap;
+
+	// Validators are owned by the dungeon rules, so they are not referenced here.
+	TMap<const UDungeonValidator*, int32> ValidatorAborts;
+
+	// Choices of the winning candidate of the speculative generation, or of the plan of GenerateTimeSliced, replayed in order.
+	TArray<FDungeonSimulatedChoice> ReplayChoices;
+	int32 NextReplayChoice {0};
+
+	// Room instances added while replaying, in the same order as the rooms of the plan.
+	// Only compared with the parent rooms given by the generator, never dereferenced.
+	TArray<const UObject*> ReplayedRooms;
+
+	int32 PlanDivergence {INDEX_NONE};
+	int32 NumReplayedChoices {0};
+
+	// True when the replay choices come from GenerateTimeSliced, so the next generation uses them.
+	bool bReplayPlanned {false};
+
+	// Seed of the plan (the seed of the winner when speculative), the plan is dropped if the generation uses another one.
+	int32 PlannedSeed {0};
+
+	// Seed type of the generator, restored once the planned generation has resolved its seed.
+	ESeedType PlannedSeedType {ESeedType::Random};
+
+	// Index of the winner in SpeculativeSeeds and its layout, only read once the speculation task is completed.
+	struct FSpeculationResult
+	{
+		FDungeonSimulatedLayout Layout;
+		int32 Winner {INDEX_NONE};
+	};
+
+	// Simulation of the speculative candidates, running on worker threads.
+	UE::Tasks::FTask SpeculationTask;
+	TArray<int32> SpeculativeSeeds;
+	TSharedPtr<FSpeculationResult> SpeculationResult;
+
+	// Keeps the simulated dungeon rules alive until the task is finished, even if the generator uses other rules meanwhile.
+	TStrongObjectPtr<UDungeonRules> SpeculativeRules;
+
+	// Layout planned by GenerateTimeSliced, kept between the frames.
+	FDungeonSimulatedLayout PlanningLayout;
+	FDungeonSimulationCursor PlanningCursor;
+	FTSTicker::FDelegateHandle PlanningTicker;
 };
@@ -11,6 +11,7 @@
 
 class ADungeonGenerator;
 class UDungeonGraph;
+struct FDungeonRulesEvent;
 
 UCLASS(Abstract, BlueprintType, Blueprintable, EditInlineNew)
 class DUNGEONRULES_API UDungeonInitializer : public UObject
@@ -18,6 +19,30 @@ class DUNGEONRULES_API UDungeonInitializer : public UObject
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	//~ End UObject Interface
+
 	UFUNCTION(BlueprintCallable, BlueprintNativeEvent, Category = "Dungeon Rules")
 	void InitializeDungeon(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const;
+
+	// Same as InitializeDungeon, but calls InitializeDungeon_Implementation directly when not implemented in Blueprint.
+	void DispatchInitializeDungeon(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const;
+
+	// True when the initializer can run on any thread, concurrently with the initializers accessing other data.
+	// Always false when InitializeDungeon is implemented in Blueprint.
+	FORCEINLINE bool IsThreadSafe() const { return !BlueprintInitializeDungeon && IsNativeThreadSafe(); }
+
+	// Gets the names of the data (e.g. "RoomTags", "SpawnTables") read and written by the initializer.
+	// Two initializers can run concurrently only when none of them writes data accessed by the other.
+	// Returns false when the data are not declared, so the initializer runs alone, after all the previous ones.
+	virtual bool GetDataAccess(TArray<FName>& OutReads, TArray<FName>& OutWrites) const { return false; }
+
+protected:
+	// Override it to return true when InitializeDungeon_Implementation only modifies the data it declares in GetDataAccess.
+	virtual bool IsNativeThreadSafe() const { return false; }
+
+private:
+	// Blueprint implementation of InitializeDungeon, if any.
+	TSharedPtr<const FDungeonRulesEvent> BlueprintInitializeDungeon;
 };
@@ -0,0 +1,40 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDungeonInitializer;
+class ADungeonGenerator;
+class UDungeonGraph;
+
+// Order in which the initializers run, built from the data they read and write.
+// The initializers are grouped in waves: an initializer is in a later wave than all the previous initializers it conflicts with,
+// so the initializers of a wave can run concurrently while the result is the same as running them in the array order.
+// Initializers which are not thread safe or don't declare their data are alone in their wave, after all the previous ones.
+struct DUNGEONRULES_API FDungeonInitializerSchedule
+{
+public:
+	void Build(TConstArrayView<TObjectPtr<UDungeonInitializer>> Initializers);
+	void Reset();
+
+	// The initializers are owned by the dungeon rules, which report them through this function.
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+	// Runs the waves in order, each one on worker threads when it contains several initializers.
+	// Must be called from the game thread.
+	void Run(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const;
+
+	FORCEINLINE int32 GetNumWaves() const { return WaveStarts.Num(); }
+	TConstArrayView<const UDungeonInitializer*> GetWave(int32 Wave) const;
+
+private:
+	// Initializers sorted by wave, then by their order in the array.
+	TArray<const UDungeonInitializer*> Initializers;
+
+	// Index of the first initializer of each wave.
+	TArray<int32> WaveStarts;
+};
@@ -0,0 +1,64 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonAliasTable.h"
+#include "UObject/ObjectPtr.h"
+
+class URoomData;
+class UDoorType;
+class FReferenceCollector;
+
+// Room list of a room chooser, with the subsets of rooms that can be connected to each door type.
+// Built once from the list, so the choosers only pick rooms that have a door compatible with the open door.
+struct DUNGEONRULES_API FDungeonRoomCandidates
+{
+	struct FSubset
+	{
+		// Indices in the room list.
+		TArray<int32> Rooms;
+		// Only built when the list is weighted.
+		FDungeonAliasTable AliasTable;
+	};
+
+public:
+	// Builds the subsets for each door type used by the rooms of the list.
+	// When weights are provided (one per room), the rooms are picked with a probability proportional to their weight.
+	void Build(const TArray<URoomData*>& RoomList, const TArray<int32>& RoomWeights = {});
+	void Reset();
+
+	// The rooms are only soft referenced by the choosers, so the owner must report them to keep them alive while cached.
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+	FORCEINLINE int32 Num() const { return Rooms.Num(); }
+
+	// Picks a room from the whole list.
+	URoomData* Choose(const FRandomStream& Random) const;
+
+	// Picks a room having at least one door compatible with the door type.
+	// Picks from the whole list if no room is compatible.
+	URoomData* Choose(const UDoorType* DoorType, const FRandomStream& Random) const;
+
+	// Returns the subset of the door type, or nullptr if the door type is not used by the rooms of the list.
+	const FSubset* FindSubset(const UDoorType* DoorType) const;
+
+	static bool IsCompatible(const URoomData* Room, const UDoorType* DoorType);
+
+private:
+	bool IsWeighted() const { return Weights.Num() > 0; }
+	void BuildSubset(FSubset& Subset, TFunctionRef<bool(const URoomData*)> Filter) const;
+	int32 SampleSubset(const FSubset& Subset, const FRandomStream& Random) const;
+
+	// Same as sampling a subset, but filtering the rooms on the fly without allocation.
+	int32 SampleCompatible(const UDoorType* DoorType, const FRandomStream& Random) const;
+
+private:
+	TArray<TObjectPtr<URoomData>> Rooms;
+	TArray<int32> Weights;
+	FSubset AllRooms;
+	TMap<const UDoorType*, FSubset> Subsets;
+};
@@ -14,6 +14,8 @@
 class URoomData;
 class ADungeonGenerator;
 class IReadOnlyRoom;
+struct FDungeonRulesEvaluationContext;
+struct FDungeonRulesEvent;
 
 UCLASS(Abstract, Blueprintable, BlueprintType, EditInlineNew)
 class DUNGEONRULES_API UDungeonRoomChooser : public UObject
@@ -21,6 +23,11 @@ class DUNGEONRULES_API UDungeonRoomChooser : public UObject
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	//~ End UObject Interface
+
+	// Generator and PreviousRoom are null when the rules are simulated without generator.
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Dungeon Rules", meta = (DisplayName = "Choose First Room"))
 	URoomData* ChooseFirstRoomData(ADungeonGenerator* Generator) const;
 
@@ -29,4 +36,44 @@ public:
 
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Dungeon Rules")
 	FText GetDescription() const;
+
+	// Same as ChooseFirstRoomData and ChooseNextRoomData, but calling their C++ implementation directly
+	// when they are not implemented in Blueprint. Use those ones from C++.
+	URoomData* DispatchChooseFirstRoomData(ADungeonGenerator* Generator) const;
+	URoomData* DispatchChooseNextRoomData(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const;
+
+	// Same as above, but calling ChooseFirstRoomDataWithContext and ChooseNextRoomDataWithContext
+	// when not implemented in Blueprint. Those are the ones called by the dungeon rules.
+	URoomData* DispatchChooseFirstRoomData(const FDungeonRulesEvaluationContext& Context) const;
+	URoomData* DispatchChooseNextRoomData(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const;
+
+	// True when the rooms can be chosen from any thread, concurrently with other generations.
+	// Always false when a choose function is implemented in Blueprint.
+	FORCEINLINE bool IsThreadSafe() const { return !BlueprintChooseFirstRoomData && !BlueprintChooseNextRoomData && IsNativeThreadSafe(); }
+
+	// Adds the room data this chooser can return, so they can be loaded before the generation.
+	virtual void GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const;
+
+	// Called once the room data from GetRoomDataToLoad are loaded.
+	// The room data may also have been loaded by something else, so any cache of them must be rebuilt each time.
+	// Not called again before a generation while all of them stay loaded.
+	virtual void OnRoomDataLoaded();
+
+	// Called when the dungeon rules release their room data.
+	// Any cache of the room data must be cleared, else it keeps them loaded. OnRoomDataLoaded is called before the next generation.
+	virtual void OnRoomDataReleased();
+
+protected:
+	// C++ implementations of the choose functions using only the read-only context.
+	// By default, call the _Implementation functions with the generator of the context.
+	virtual URoomData* ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const;
+	virtual URoomData* ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const;
+
+	// Override it to return true when the WithContext functions only read the context and this chooser.
+	virtual bool IsNativeThreadSafe() const { return false; }
+
+private:
+	// Blueprint implementations of the choose functions, if any.
+	TSharedPtr<const FDungeonRulesEvent> BlueprintChooseFirstRoomData;
+	TSharedPtr<const FDungeonRulesEvent> BlueprintChooseNextRoomData;
 };
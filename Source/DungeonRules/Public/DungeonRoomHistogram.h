@@ -0,0 +1,85 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/SubclassOf.h"
+
+class URoomData;
+class ADungeonGenerator;
+
+// Groups of room data counted during the generation (e.g. one per room count condition).
+// Built when the dungeon rules are compiled, and immutable afterward.
+struct DUNGEONRULES_API FDungeonRoomCounterLayout
+{
+	struct FBucket
+	{
+		// A room is counted when its data is one of those...
+		TArray<const URoomData*> RoomData;
+		// ...or when its data is a child of one of those classes.
+		TArray<const UClass*> RoomClasses;
+	};
+
+public:
+	void Reset();
+	void Serialize(FArchive& Ar);
+
+	// Registers a bucket for the owner (a condition) counting the rooms using any of the room data.
+	int32 AddRoomDataBucket(const UObject* Owner, const TArray<TObjectPtr<URoomData>>& RoomData);
+
+	// Registers a bucket for the owner (a condition) counting the rooms with a data of any of the classes.
+	int32 AddRoomClassBucket(const UObject* Owner, const TArray<TSubclassOf<URoomData>>& RoomClasses);
+
+	int32 FindBucket(const UObject* Owner) const;
+	FORCEINLINE int32 NumBuckets() const { return Buckets.Num(); }
+	FORCEINLINE uint32 GetSerial() const { return Serial; }
+
+	// Computes the indices of all the buckets counting a room with this data.
+	void GetBucketsOf(const URoomData* RoomData, TArray<int32>& OutBuckets) const;
+
+private:
+	TArray<FBucket> Buckets;
+	TMap<const UObject*, int32> OwnerBuckets;
+
+	// Changed each time the layout is modified, to detect outdated histograms.
+	uint32 Serial {0};
+};
+
+// Number of rooms added in each bucket of a layout during the current generation.
+// Updated each time a room is added, so the room count conditions don't have to iterate all the rooms.
+struct DUNGEONRULES_API FDungeonRoomHistogram
+{
+public:
+	// Sets all counts to zero, keeping the allocated memory.
+	void Reset(const FDungeonRoomCounterLayout& NewLayout);
+
+	void AddRoom(const URoomData* RoomData);
+
+	FORCEINLINE int32 GetTotal() const { return Total; }
+
+	// Returns true if the histogram counts the buckets of this layout.
+	FORCEINLINE bool HasLayout(const FDungeonRoomCounterLayout& InLayout) const { return Layout == &InLayout && LayoutSerial == InLayout.GetSerial(); }
+
+	// Gets the number of rooms in a bucket of the layout.
+	FORCEINLINE int32 GetBucketCount(int32 BucketIndex) const { return Counts[BucketIndex]; }
+
+	// Gets the number of rooms counted by the bucket of the owner.
+	// Returns false if the owner has no bucket in the layout.
+	bool GetCount(const UObject* Owner, int32& OutCount) const;
+
+	// Returns the histogram of the generator if it is a generator with rules, nullptr otherwise.
+	static const FDungeonRoomHistogram* Get(const ADungeonGenerator* Generator);
+
+private:
+	const FDungeonRoomCounterLayout* Layout {nullptr};
+	uint32 LayoutSerial {0};
+	TArray<int32> Counts;
+	int32 Total {0};
+
+	// Cache of the buckets each room data belongs to.
+	// Kept between generations since it only depends on the layout.
+	TMap<const URoomData*, TArray<int32>> RoomDataBuckets;
+};
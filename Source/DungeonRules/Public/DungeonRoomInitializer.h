@@ -0,0 +1,46 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonInitializer.h"
+#include "DungeonRoomInitializer.generated.h"
+
+class URoom;
+
+// Initializer doing the same work on each room of the dungeon, with the rooms initialized concurrently on worker threads.
+// InitializeRoom must only read the rooms and write the result of its own room, e.g. in an array sized in BeginRooms.
+// The results are then applied on the game thread in EndRooms (spawning actors, modifying the rooms, etc.).
+UCLASS(Abstract, NotBlueprintable)
+class DUNGEONRULES_API UDungeonRoomInitializer : public UDungeonInitializer
+{
+	GENERATED_BODY()
+
+public:
+	virtual void InitializeDungeon_Implementation(const ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const override final;
+
+	// Runs BeginRooms, InitializeRoom on each room, then EndRooms.
+	void InitializeRooms(const ADungeonGenerator* Generator, TConstArrayView<URoom*> Rooms) const;
+
+	// True when InitializeRoom can be called concurrently on different rooms.
+	FORCEINLINE bool CanInitializeRoomsConcurrently() const { return IsInitializeRoomThreadSafe(); }
+
+protected:
+	// Called on the game thread before the rooms are initialized, to prepare one slot per room.
+	virtual void BeginRooms(const ADungeonGenerator* Generator, int32 NumRooms) const {}
+
+	// Called for each room, from any thread when the initializer is thread safe.
+	virtual void InitializeRoom(const ADungeonGenerator* Generator, const URoom* Room, int32 RoomIndex) const PURE_VIRTUAL(UDungeonRoomInitializer::InitializeRoom, );
+
+	// Called on the game thread once all the rooms are initialized.
+	virtual void EndRooms(const ADungeonGenerator* Generator, TConstArrayView<URoom*> Rooms) const {}
+
+	// Override it to return false when InitializeRoom has to be called from the game thread.
+	virtual bool IsInitializeRoomThreadSafe() const { return true; }
+
+	// BeginRooms and EndRooms are called from the game thread.
+	virtual bool IsNativeThreadSafe() const override final { return false; }
+};
@@ -7,20 +7,30 @@
 
 #include "CoreMinimal.h"
 #include "Engine/DataAsset.h"
+#include "Engine/StreamableManager.h"
+#include "Tasks/Task.h"
 #include "ProceduralDungeonTypes.h"
 #include "Interfaces/NodeInterfaces.h"
 #include "Interfaces/DungeonInterfaces.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonValidatorOrder.h"
+#include "DungeonInitializerSchedule.h"
+#include "DungeonEventReceiver.h"
 #include "DungeonRules.generated.h"
 
 class UDungeonRoomChooser;
 class URuleTransitionCondition;
 class ADungeonGenerator;
 class URoomData;
+class IReadOnlyRoom;
 class UDungeonGraph;
 class UDungeonRule;
 class UDungeonEventReceiver;
 class UDungeonValidator;
 class UDungeonInitializer;
+struct FDungeonRulesRuntimeState;
+struct FDungeonRulesEvaluationContext;
+struct FDungeonSimulatedLayout;
 
 UCLASS()
 class DUNGEONRULES_API UDungeonRuleTransition : public UObject, public INodeTooltip
@@ -30,6 +40,7 @@ class DUNGEONRULES_API UDungeonRuleTransition : public UObject, public INodeTool
 public:
 	// The priority over other transitions.
 	// The less this number is, the more priority the transition has.
+	// When several transitions have the same priority, the first one added in the graph is checked first.
 	UPROPERTY(EditAnywhere, Category = "Transition")
 	int32 PriorityOrder {0};
 
@@ -40,13 +51,9 @@ public:
 	TScriptInterface<IDungeonRuleProvider> NextRule {nullptr};
 
 public:
-	bool CheckCondition(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const;
-
 	//~ Begin INodeTooltip Interface
 	virtual FText GetNodeTooltip() const override;
 	//~ End INodeTooltip Interface
-
-	static TOptional<const UDungeonRule*> GetNextRuleFromTransitionList(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const TArray<TWeakObjectPtr<const UDungeonRuleTransition>>& Transitions, const UObject* Context = nullptr);
 };
 
 /////////////////////////////////////////
@@ -76,13 +83,6 @@ public:
 	virtual FText GetNodeTooltip() const override;
 	//~ End INodeTooltip Interface
 
-	//~ Begin IDungeonRuleProvider Interface
-	virtual const UDungeonRule* GetRule(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const override { return this; }
-	//~ End IDungeonRuleProvider Interface
-
-public:
-	TOptional<const UDungeonRule*> GetNextRule(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const;
-
 #if WITH_EDITOR
 public:
 	void Clear();
@@ -93,7 +93,7 @@ public:
 /////////////////////////////////////////
 
 UCLASS()
-class DUNGEONRULES_API URuleConduit : public UObject, public IDungeonRuleProvider, public IDungeonConditionProvider
+class DUNGEONRULES_API URuleConduit : public UObject, public IDungeonRuleProvider
 {
 	GENERATED_BODY()
 
@@ -101,14 +101,6 @@ public:
 	UPROPERTY()
 	TArray<TWeakObjectPtr<const UDungeonRuleTransition>> Transitions;
 
-	//~ Begin IDungeonRuleProvider Interface
-	virtual const UDungeonRule* GetRule(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const override;
-	//~ End IDungeonRuleProvider Interface
-
-	//~ Begin IDungeonConditionProvider Interface
-	virtual bool CheckCondition(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const override;
-	//~ End IDungeonConditionProvider Interface
-
 #if WITH_EDITOR
 public:
 	void Clear();
@@ -126,22 +118,136 @@ class DUNGEONRULES_API UDungeonRules : public UDataAsset
 public:
 	UDungeonRules();
 
+	//~ Begin UObject Interface
+	virtual void Serialize(FArchive& Ar) override;
+	virtual void PostLoad() override;
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+#if WITH_EDITOR
+	virtual void PostInitProperties() override;
+	virtual void BeginDestroy() override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+	virtual void PostEditUndo() override;
+#endif
+	//~ End UObject Interface
+
 public:
 	// Functions replacing calls from generator actor.
-	URoomData* GetFirstRoomData(ADungeonGenerator* Generator, const UDungeonRule* CurrentRule) const;
-	URoomData* GetNextRoomData(ADungeonGenerator* Generator, const UDungeonRule* CurrentRule, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const;
-	bool IsDungeonValid(const ADungeonGenerator* Generator);
-	void InitializeDungeon(ADungeonGenerator* Generator, const UDungeonGraph* Rooms);
+	// Rules are referenced by their index in the compiled program.
+	// The asset is not modified by those functions (except OnPreGeneration), so it can be shared by several generators.
+	// Everything specific to a generation is stored in the runtime state of the generator instead.
+	URoomData* GetFirstRoomData(const FDungeonRulesEvaluationContext& Context, int32 CurrentRule) const;
+	URoomData* GetNextRoomData(const FDungeonRulesEvaluationContext& Context, int32 CurrentRule, const FDoorDef& DoorData, int& DoorIndex) const;
+	bool IsDungeonValid(const ADungeonGenerator* Generator, FDungeonRulesRuntimeState& State) const;
+	bool IsLayoutValid(const FDungeonSimulatedLayout& Layout) const;
+
+	// True when at least one validator can reject the layout of a simulated generation.
+	bool SupportsLayoutValidation() const;
+
+	// Returns the first validator for which the dungeon can't be valid anymore after the new room, nullptr if none.
+	const UDungeonValidator* FindFailingValidator(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom) const;
+	void InitializeDungeon(ADungeonGenerator* Generator, const UDungeonGraph* Rooms) const;
+	void OnPostGeneration(ADungeonGenerator* Generator, const FDungeonRulesRuntimeState& State) const;
+	void OnGenerationInit(ADungeonGenerator* Generator) const;
+	void OnGenerationFailed(ADungeonGenerator* Generator) const;
+	void OnRoomAdded(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom, FDungeonRulesRuntimeState& State) const;
+	void OnFailedToAddRoom(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor) const;
+
+	// Prepares the asset for a generation and routes the event to the receivers.
+	// Must be called from the game thread.
 	void OnPreGeneration(ADungeonGenerator* Generator);
-	void OnPostGeneration(ADungeonGenerator* Generator);
-	void OnGenerationInit(ADungeonGenerator* Generator);
-	void OnGenerationFailed(ADungeonGenerator* Generator);
-	void OnRoomAdded(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom);
-	void OnFailedToAddRoom(ADungeonGenerator* Generator, const URoomData* FromRoom, const FDoorDef& FromDoor);
 
-	const UDungeonRule* GetNextRule(ADungeonGenerator* Generator, const UDungeonRule* CurrentRule, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const;
+	// Prepares the asset for a generation (compiles it in editor if it has been edited, and loads the room data if needed).
+	// Must be called from the game thread.
+	void PrepareForGeneration();
+
+	// True when some event receivers get the added rooms only at the end of the generation.
+	FORCEINLINE bool HasBatchedRoomAdded() const { return EventSubscribers[static_cast<uint8>(EDungeonEvent::OnRoomsAdded)].Num() > 0; }
+
+	// Prepares the state for a new generation using these rules.
+	void ResetRuntimeState(FDungeonRulesRuntimeState& State) const;
+
+	// Returns the rule to use after the previous room of the context has been added, using the current rule of the state.
+	int32 GetNextRule(FDungeonRulesRuntimeState& State, const FDungeonRulesEvaluationContext& Context) const;
+	FORCEINLINE int32 GetFirstRuleIndex() const { return Program.FirstRule; }
 	FORCEINLINE const UDungeonRule* GetFirstRule() const { return FirstRule.Get(); }
 
+	// (Re)builds the flat program used during the generation from the rules, conduits and transitions.
+	void Compile();
+	FORCEINLINE const FDungeonRulesProgram& GetProgram() const { return Program; }
+
+	// True when the room choosers, conditions and validators can all be evaluated from any thread.
+	// GetFirstRoomData, GetNextRoomData, GetNextRule and IsDungeonValid can then be called concurrently by several generations,
+	// each one using its own runtime state.
+	FORCEINLINE bool IsThreadSafe() const { return NotThreadSafeObjects.Num() == 0; }
+
+	// The objects preventing the rules from being thread safe, updated each time the rules are compiled.
+	FORCEINLINE const TArray<const UObject*>& GetNotThreadSafeObjects() const { return NotThreadSafeObjects; }
+
+	// Gets the room data the room choosers of the rules reachable from the first rule can return.
+	void GetReachableRoomData(TArray<FSoftObjectPath>& OutRoomData) const;
+
+	// Streams all the reachable room data in a single request, and keeps them loaded while the rules are alive.
+	// The delegate is called once they are all loaded.
+	// Should be called before the generation, else the room data are loaded synchronously in OnPreGeneration.
+	TSharedPtr<FStreamableHandle> PreloadRoomData(FStreamableDelegate OnLoaded = FStreamableDelegate());
+
+	// Loads synchronously the reachable room data not loaded yet.
+	// Does nothing once the room choosers have all their room data, until the rules are compiled again or their room data released.
+	void LoadRoomData();
+
+	// Allows the room data loaded by PreloadRoomData or LoadRoomData to be unloaded.
+	// The room choosers clear their room data too, so no generation must be running.
+	void ReleaseRoomData();
+
+	// Order learned from the stats of all the generators since the asset has been loaded.
+	// Each generator evaluates the validators in the order of its runtime state.
+	FORCEINLINE const FDungeonValidatorOrder& GetValidatorOrder() const { return ValidatorOrder; }
+
+	// Adds the validator stats recorded by a generator to the ones of the asset, and gives the merged order back to its state.
+	// Must be called from the game thread, between two generations of the state.
+	void MergeValidatorOrder(FDungeonRulesRuntimeState& State);
+
+	// Order in which InitializeDungeon runs the initializers.
+	FORCEINLINE const FDungeonInitializerSchedule& GetInitializerSchedule() const { return InitializerSchedule; }
+
+	// Registers a task reading the program, room choosers or validators on worker threads (e.g. a simulation).
+	// The asset waits for the task before compiling or updating its room choosers, so the task never reads them while they change.
+	// Must be called from the game thread.
+	void AddAsyncReader(const UE::Tasks::FTask& Task);
+
+#if WITH_EDITOR
+	// Sorts the validators of the asset in the order learned so far and stops learning,
+	// so the validators are always evaluated in the same order (e.g. in shipping builds).
+	UFUNCTION(CallInEditor, Category = "Dungeon Rules")
+	void FreezeValidatorOrder();
+
+	// Compiles the rules again before the next generation.
+	FORCEINLINE void MarkProgramDirty() { bProgramDirty = true; }
+	FORCEINLINE bool IsProgramDirty() const { return bProgramDirty; }
+#endif
+
+private:
+	// Waits for the tasks registered by AddAsyncReader, before the asset is modified.
+	void WaitForAsyncReaders();
+
+	// Updates the room choosers once the room data they use are loaded.
+	void NotifyRoomDataLoaded();
+
+	void UpdateThreadSafety();
+
+	// Builds the list of receivers of each event.
+	void UpdateEventSubscribers();
+
+#if WITH_EDITOR
+	// Marks the program dirty when one of the room choosers, conditions, validators, etc. of the asset is edited.
+	void OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent);
+
+	// Marks the program dirty when one of its objects is replaced after its Blueprint class has been recompiled.
+	void OnObjectsReinstanced(const TMap<UObject*, UObject*>& ReplacedObjects);
+#endif
+
+	FDungeonRulesProgram::FTransitionRange CompileTransitions(const TArray<TWeakObjectPtr<const UDungeonRuleTransition>>& TransitionList, const TMap<const UObject*, int32>& RuleIndices, const TMap<const UObject*, int32>& ConduitIndices, const UObject* Context);
+
 #if WITH_EDITOR
 public:
 	// Clear FirstRule, Rules and all transitions
@@ -190,7 +296,52 @@ private:
 	UPROPERTY(EditAnywhere, Instanced, Category = "Dungeon Rules", meta = (AllowPrivateAccess = true))
 	TArray<TObjectPtr<UDungeonValidator>> Validators;
 
+	// Measures the time and failure rate of each validator, and evaluates first the ones finding failures the fastest.
+	// When disabled, the validators are evaluated in the order of the array.
+	// Disabled by default, so the validators of existing assets keep being evaluated in the order they were written.
+	UPROPERTY(EditAnywhere, Category = "Dungeon Rules", meta = (AllowPrivateAccess = true))
+	bool bAdaptiveValidatorOrder {false};
+
 	// Holds logic to initialize the dungeon.
 	UPROPERTY(EditAnywhere, Instanced, Category = "Dungeon Rules", meta = (AllowPrivateAccess = true))
 	TArray<TObjectPtr<UDungeonInitializer>> Initializers;
+
+	FDungeonRulesProgram Program;
+
+	// True when the program has been loaded from a cooked asset, so it does not need to be compiled.
+	bool bCookedProgram {false};
+
+#if WITH_EDITOR
+	// True when the asset has been edited since the last compilation.
+	bool bProgramDirty {true};
+	FDelegateHandle ObjectPropertyChangedHandle;
+	FDelegateHandle ObjectsReinstancedHandle;
+#endif
+
+	// Waves of initializers which can run concurrently, updated each time the rules are compiled.
+	FDungeonInitializerSchedule InitializerSchedule;
+
+	// Event receivers implementing each event, updated each time the rules are compiled.
+	TArray<UDungeonEventReceiver*> EventSubscribers[static_cast<uint8>(EDungeonEvent::Count)];
+
+	// Only updated by MergeValidatorOrder, never during a generation.
+	FDungeonValidatorOrder ValidatorOrder;
+
+	// Room choosers, conditions and validators that can only be used from the game thread.
+	TArray<const UObject*> NotThreadSafeObjects;
+
+	// Keeps the reachable room data loaded.
+	TSharedPtr<FStreamableHandle> RoomDataHandle;
+
+	// True when the room choosers have been updated with all the reachable room data loaded.
+	bool bRoomDataLoaded {false};
+
+	// Tasks reading the asset on worker threads, see AddAsyncReader.
+	TArray<UE::Tasks::FTask> AsyncReaders;
+
+#if WITH_DEV_AUTOMATION_TESTS
+public:
+	void SetEventReceivers(const TArray<UDungeonEventReceiver*>& NewReceivers) { EventReceivers = NewReceivers; UpdateEventSubscribers(); }
+	FORCEINLINE int32 GetNumEventSubscribers(EDungeonEvent Event) const { return EventSubscribers[static_cast<uint8>(Event)].Num(); }
+#endif
 };
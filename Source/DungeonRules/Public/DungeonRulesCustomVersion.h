@@ -0,0 +1,34 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/Guid.h"
+
+// Version of the data serialized by the dungeon rules assets (e.g. the compiled program in cooked builds).
+// The version of the editor graph is managed separately (see DungeonRulesVersion in the editor module).
+// When modifying the serialized data, a new version should be added before VersionPlusOne.
+struct DUNGEONRULES_API FDungeonRulesCustomVersion
+{
+	enum Type
+	{
+		// Before any version changes were made.
+		BeforeCustomVersionWasAdded = 0,
+
+		// The compiled program is serialized in cooked assets.
+		CookedProgram,
+
+		// -----<new versions can be added above this line>-------------------------------------------------
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	// The GUID for this custom version number
+	static const FGuid GUID;
+
+private:
+	FDungeonRulesCustomVersion() {}
+};
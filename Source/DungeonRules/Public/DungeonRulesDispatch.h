@@ -0,0 +1,103 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FProperty;
+class UFunction;
+
+// Blueprint implementation of an event, with the layout of its parameters computed once when the event is found.
+struct DUNGEONRULES_API FDungeonRulesEvent
+{
+	struct FParameter
+	{
+		const FProperty* Property {nullptr};
+		int32 Offset {0};
+		int32 Size {0};
+	};
+
+public:
+	explicit FDungeonRulesEvent(UFunction* InFunction);
+
+public:
+	UFunction* Function {nullptr};
+
+	// Parameters in the order of the declaration of the event, without the return value.
+	TArray<FParameter, TInlineAllocator<4>> Parameters;
+
+	// Property is null when the event returns nothing.
+	FParameter ReturnValue;
+
+	// Parameters (return value included) which are not zero initialized, or which must be destroyed after the call.
+	TArray<const FProperty*, TInlineAllocator<2>> PropertiesToInit;
+	TArray<const FProperty*, TInlineAllocator<2>> PropertiesToDestroy;
+
+	int32 ParmsSize {0};
+	int32 MinAlignment {1};
+};
+
+// Calling a BlueprintNativeEvent always goes through ProcessEvent, even when the class is pure C++.
+// Those helpers find whether an event is implemented in Blueprint, so the native implementation can be called directly otherwise.
+struct DUNGEONRULES_API FDungeonRulesDispatch
+{
+	// Returns the Blueprint implementation of the event in the class, or nullptr when it is only implemented in C++.
+	// The result is computed once per class and event, until the classes are reinstanced (e.g. a Blueprint is compiled).
+	static TSharedPtr<const FDungeonRulesEvent> FindBlueprintEvent(const UClass* Class, FName EventName);
+
+	// Forgets the events found so far.
+	static void ClearCache();
+
+	// Clears the cache each time some objects are reinstanced. Called by the module.
+	static void Startup();
+	static void Shutdown();
+
+	// When false (console variable 'DungeonRules.NativeDispatch'), events always go through ProcessEvent.
+	static bool IsNativeDispatchEnabled();
+	static void SetNativeDispatchEnabled(bool bEnabled);
+};
+
+// Parameters of a Blueprint event, built in place from the cached layout of the event.
+// The arguments are given in the order of the declaration of the event.
+class DUNGEONRULES_API FDungeonRulesEventParams : public FNoncopyable
+{
+public:
+	explicit FDungeonRulesEventParams(const FDungeonRulesEvent& InEvent);
+	~FDungeonRulesEventParams();
+
+	template<typename... ArgTypes>
+	void Set(const ArgTypes&... Args)
+	{
+		int32 Index = 0;
+		(SetParameter(Index++, Args), ...);
+	}
+
+	// Value of a parameter after the call (e.g. an output parameter).
+	template<typename T>
+	const T& Get(int32 Index) const { return *static_cast<const T*>(GetParameterPtr(Index, sizeof(T))); }
+
+	template<typename T>
+	const T& GetReturnValue() const { return *static_cast<const T*>(GetReturnValuePtr(sizeof(T))); }
+
+	void Call(const UObject* Object);
+
+private:
+	template<typename T>
+	void SetParameter(int32 Index, const T& Value) { *static_cast<T*>(GetParameterPtr(Index, sizeof(T))) = Value; }
+
+	// Checks the size of the parameter against the one of the C++ type.
+	void* GetParameterPtr(int32 Index, int32 Size) const;
+	void* GetReturnValuePtr(int32 Size) const;
+
+private:
+	// Large enough for the parameters of all the events of the plugin, bigger ones are allocated on the heap.
+	static constexpr int32 InlineSize = 128;
+	static constexpr int32 InlineAlignment = 16;
+
+	const FDungeonRulesEvent& Event;
+	uint8* Memory {nullptr};
+	alignas(InlineAlignment) uint8 InlineMemory[InlineSize];
+};
@@ -0,0 +1,35 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ScriptInterface.h"
+
+class ADungeonGenerator;
+class IReadOnlyRoom;
+struct FDungeonRoomHistogram;
+
+// Read-only view of a generation, given to the conditions and room choosers by the dungeon rules.
+// Nothing of the generation can be modified through it, so thread-safe implementations can use it from any thread.
+struct DUNGEONRULES_API FDungeonRulesEvaluationContext
+{
+	// Generator running the rules, or nullptr when evaluated without generator (e.g. by FDungeonRulesSimulator).
+	// Only needed by the implementations which are not thread safe.
+	const ADungeonGenerator* Generator {nullptr};
+
+	// The last room added to the dungeon, nullptr when evaluated without generator.
+	TScriptInterface<IReadOnlyRoom> PreviousRoom {nullptr};
+
+	// Rooms added during the generation, or nullptr when not counted.
+	const FDungeonRoomHistogram* Histogram {nullptr};
+
+	// Random stream of the generation, never shared between two concurrent generations.
+	const FRandomStream* Random {nullptr};
+
+	// The legacy Blueprint events take a mutable generator.
+	// Only call them from the game thread, with the generator owning this context.
+	FORCEINLINE ADungeonGenerator* GetMutableGenerator() const { return const_cast<ADungeonGenerator*>(Generator); }
+};
@@ -0,0 +1,56 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDungeonRulesTracer;
+struct FDungeonRulesTraceRecord;
+
+// Number of visits and evaluation time of each rule and transition, accumulated from the trace records of many generations.
+// Indices are the ones of the compiled program of the rules asset which recorded the traces.
+struct DUNGEONRULES_API FDungeonRulesHeatmap
+{
+	struct FEntry
+	{
+		// Number of times a rule has been the current rule, or a transition has been checked.
+		int64 Visits {0};
+
+		// Number of times a transition has passed (unused for the rules).
+		int64 Passes {0};
+
+		// Time spent in the transitions of a rule, or in a transition.
+		// A transition leading to a conduit includes the time of the conduit transitions, which are recorded too.
+		double Seconds {0.0};
+	};
+
+public:
+	void Reset();
+
+	// The records must come from a tracer, or from a trace file loaded for the same program.
+	void Add(const FDungeonRulesTraceRecord& Record);
+	void Add(TConstArrayView<FDungeonRulesTraceRecord> Records);
+	void Add(const FDungeonRulesTracer& Tracer);
+
+	// Adds the entries of another heatmap recorded with the same rules asset.
+	void Merge(const FDungeonRulesHeatmap& Other);
+
+	FORCEINLINE bool IsEmpty() const { return NumRecords == 0; }
+	FORCEINLINE int64 GetNumRecords() const { return NumRecords; }
+
+	// Returns nullptr when the rule or transition has never been recorded.
+	FORCEINLINE const FEntry* FindRule(int32 Rule) const { return Rules.IsValidIndex(Rule) ? &Rules[Rule] : nullptr; }
+	FORCEINLINE const FEntry* FindTransition(int32 Transition) const { return Transitions.IsValidIndex(Transition) ? &Transitions[Transition] : nullptr; }
+
+	// Highest values of the entries, to normalize them.
+	FEntry GetMaxRule() const;
+	FEntry GetMaxTransition() const;
+
+private:
+	TArray<FEntry> Rules;
+	TArray<FEntry> Transitions;
+	int64 NumRecords {0};
+};
@@ -0,0 +1,196 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ScriptInterface.h"
+#include "DungeonRoomHistogram.h"
+#include "DungeonConditionBytecode.h"
+#include "DungeonRulesEvaluationContext.h"
+
+class ADungeonGenerator;
+class IReadOnlyRoom;
+class UDungeonRule;
+class UDungeonRoomChooser;
+class URuleTransitionCondition;
+class UDungeonRuleTransition;
+struct FDungeonRulesEvaluationCache;
+struct FDungeonRulesTracer;
+struct FDungeonRulesRuntimeState;
+
+// Type of node a compiled transition leads to.
+enum class EDungeonRulesNodeType : uint8
+{
+	None,		// Stop the generation (e.g. the Stop node).
+	Rule,
+	Conduit,
+};
+
+// Flat representation of a UDungeonRules graph.
+// Rules, conduits and transitions reference each other by their index in the arrays below,
+// so evaluating the graph does not need to resolve any weak pointer or interface.
+// Objects pointed by the program are owned by the UDungeonRules asset, so the program must not outlive it.
+// The program is never modified when evaluated: all the data of a generation are in its runtime state.
+struct DUNGEONRULES_API FDungeonRulesProgram
+{
+	// A contiguous range in the Transitions array.
+	struct FTransitionRange
+	{
+		int32 First {0};
+		int32 Num {0};
+
+		friend FArchive& operator<<(FArchive& Ar, FTransitionRange& Range)
+		{
+			Ar << Range.First;
+			Ar << Range.Num;
+			return Ar;
+		}
+	};
+
+	struct FTransition
+	{
+		int32 Condition {INDEX_NONE}; // Index in the Conditions array, INDEX_NONE when always true.
+		int32 PriorityOrder {0};
+		int32 Target {INDEX_NONE};
+		EDungeonRulesNodeType TargetType {EDungeonRulesNodeType::None};
+
+#if WITH_EDITORONLY_DATA
+		// Transition of the graph compiled into this one (not serialized).
+		const UDungeonRuleTransition* Source {nullptr};
+#endif
+
+		friend FArchive& operator<<(FArchive& Ar, FTransition& Transition)
+		{
+			Ar << Transition.Condition;
+			Ar << Transition.PriorityOrder;
+			Ar << Transition.Target;
+			Ar << Transition.TargetType;
+			return Ar;
+		}
+	};
+
+	struct FRule
+	{
+		const UDungeonRule* Rule {nullptr};
+		const UDungeonRoomChooser* RoomChooser {nullptr};
+		FTransitionRange Transitions;
+	};
+
+	struct FConduit
+	{
+		FTransitionRange Transitions;
+
+		friend FArchive& operator<<(FArchive& Ar, FConduit& Conduit)
+		{
+			Ar << Conduit.Transitions;
+			return Ar;
+		}
+	};
+
+public:
+	void Reset();
+
+	// Writes or reads the whole program, including the object pointers.
+	// The objects must be serialized by the owner of the program too (e.g. as subobjects of the asset).
+	void Serialize(FArchive& Ar);
+
+	// The program is not a UPROPERTY, so its owner must report the objects it points to.
+	void AddReferencedObjects(FReferenceCollector& Collector);
+
+	// Hash of the rules, conduits and transitions, identifying the indices used by the trace records of this program.
+	uint32 GetLayoutHash() const;
+
+	FORCEINLINE bool IsValidRule(int32 RuleIndex) const { return Rules.IsValidIndex(RuleIndex); }
+
+	// Returns the rule to use after the previous room of the context has been added while in the current rule of the state.
+	// Returns INDEX_NONE when the generation must stop.
+	// Each condition and conduit is evaluated at most once per call, the results being stored in the cache of the state.
+	// The decisions are recorded in the tracer of the state when it is enabled.
+	// Can be called from any thread when GetNotThreadSafeObjects finds nothing, each thread using its own state.
+	int32 GetNextRule(FDungeonRulesRuntimeState& State, const FDungeonRulesEvaluationContext& Context) const;
+
+	// Adds the room choosers and conditions of the program that can't be evaluated from any thread.
+	void GetNotThreadSafeObjects(TArray<const UObject*>& OutObjects) const;
+
+	// Marks the rules that can be reached from the first rule through the transitions, conduits and global transitions.
+	// Transition conditions are ignored, so a marked rule may never be used by an actual generation.
+	TBitArray<> GetReachableRules() const;
+
+	// Returns the index of the condition in the Conditions array, adding it if needed.
+	int32 AddCondition(const URuleTransitionCondition* Condition);
+
+	// Compiles the bytecode of all the conditions.
+	// Must be called once all the room counters are registered.
+	void CompileConditions();
+
+	// Sorts the transitions of the range by ascending PriorityOrder.
+	// Transitions with the same priority keep their registration order.
+	void SortTransitions(const FTransitionRange& Range);
+
+private:
+	// Data shared by all the functions evaluating a step.
+	struct FEvaluationContext
+	{
+		// The histogram is null when it does not count the rooms for this program, so the bytecode can't be used.
+		const FDungeonRulesEvaluationContext& Rules;
+		FDungeonRulesEvaluationCache& Cache;
+		FDungeonRulesTracer* Tracer;
+	};
+
+	// Returns the rule reached by the first passing transition in the range.
+	// The range must have been sorted with SortTransitions beforehand.
+	// The returned value is unset when no transition passed, and INDEX_NONE when it leads to no rule.
+	TOptional<int32> EvaluateTransitions(const FTransitionRange& Range, FEvaluationContext& Context) const;
+	TOptional<int32> EvaluateConduit(int32 ConduitIndex, FEvaluationContext& Context) const;
+	bool CheckTransition(int32 TransitionIndex, FEvaluationContext& Context) const;
+	bool CheckCondition(int32 ConditionIndex, FEvaluationContext& Context) const;
+
+public:
+	TArray<FRule> Rules;
+	TArray<FConduit> Conduits;
+
+	// All the transitions of the graph, grouped by their source node and sorted by priority in each group.
+	// A transition shared by several rules (e.g. from an alias node) is duplicated in each range.
+	TArray<FTransition> Transitions;
+
+	// All the distinct conditions used by the transitions.
+	TArray<const URuleTransitionCondition*> Conditions;
+
+	// Instructions evaluating each condition (same indices as the Conditions array).
+	FDungeonConditionBytecode Bytecode;
+	TArray<FDungeonConditionBytecode::FRange> ConditionCode;
+
+	// Rooms counted during the generation by the room count conditions.
+	FDungeonRoomCounterLayout RoomCounters;
+
+	FTransitionRange GlobalTransitions;
+	int32 FirstRule {INDEX_NONE};
+};
+
+// Results of the conditions and conduits already evaluated during a generation step.
+// Starting a new step only increments an epoch counter, the results of older epochs being considered as not cached.
+struct DUNGEONRULES_API FDungeonRulesEvaluationCache
+{
+public:
+	// Sizes the cache for the program and invalidates all cached results.
+	void Reset(const FDungeonRulesProgram& Program);
+
+	// Invalidates all cached results, and resizes the cache if the program has changed.
+	void BeginStep(const FDungeonRulesProgram& Program);
+
+	bool FindCondition(int32 ConditionIndex, bool& OutResult) const;
+	void AddCondition(int32 ConditionIndex, bool Result);
+
+	bool FindConduit(int32 ConduitIndex, TOptional<int32>& OutResult) const;
+	void AddConduit(int32 ConduitIndex, const TOptional<int32>& Result);
+
+private:
+	TArray<uint32> ConditionEpochs;
+	TArray<bool> ConditionResults;
+	TArray<uint32> ConduitEpochs;
+	TArray<TOptional<int32>> ConduitResults;
+	uint32 Epoch {0};
+};
@@ -0,0 +1,58 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonRulesProgram.h"
+#include "DungeonRulesTracer.h"
+#include "DungeonRoomHistogram.h"
+#include "DungeonValidatorOrder.h"
+
+class UDungeonValidator;
+
+// All the data modified while a generation is evaluating the dungeon rules.
+// Owned by the generator, so the rules asset and its program are never modified during a generation
+// and can be shared by any number of generators, each one using its own state.
+// A state can be reused for several generations (and several programs) without reallocating its memory.
+struct DUNGEONRULES_API FDungeonRulesRuntimeState
+{
+public:
+	// Prepares the state for a new generation starting at the first rule of the program.
+	void Reset(const FDungeonRulesProgram& Program);
+
+	// Builds the context given to the conditions and room choosers, with the histogram of this state.
+	FDungeonRulesEvaluationContext MakeContext(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FRandomStream* Random = nullptr) const;
+
+	// Returns the tracer if it is enabled, nullptr otherwise.
+	FORCEINLINE FDungeonRulesTracer* GetTracer() { return Tracer.IsEnabled() ? &Tracer : nullptr; }
+
+public:
+	// Index of the current rule in the compiled program.
+	int32 CurrentRule {INDEX_NONE};
+
+	// Results of the transition conditions evaluated during the current step.
+	FDungeonRulesEvaluationCache Cache;
+
+	// Number of rooms added during the current generation, for each room counter of the program.
+	FDungeonRoomHistogram Histogram;
+
+	// Last decisions taken by the dungeon rules (empty when disabled).
+	FDungeonRulesTracer Tracer;
+
+	// Validator which has aborted the current generation, nullptr while the dungeon can still be valid.
+	const UDungeonValidator* AbortingValidator {nullptr};
+
+	// Order in which the validators are evaluated for this generator, starting from the order of the dungeon rules.
+	// Kept from a generation to the next, so the order keeps learning.
+	FDungeonValidatorOrder ValidatorOrder;
+
+	// Stats recorded since they have been merged in the dungeon rules (see UDungeonRules::MergeValidatorOrder).
+	FDungeonValidatorOrder UnmergedValidatorStats;
+
+	// Rooms added during the current generation, only filled when some event receivers batch them.
+	// Keeps its memory from a generation to the next.
+	TArray<TScriptInterface<IReadOnlyRoom>> AddedRooms;
+};
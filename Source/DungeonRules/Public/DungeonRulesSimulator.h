@@ -0,0 +1,207 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonRulesRuntimeState.h"
+
+class URoomData;
+struct FDoorDef;
+struct FDungeonRulesProgram;
+
+enum class EDungeonSimulationEnd : uint8
+{
+	Stopped,		// The rules stopped the generation.
+	NoMoreDoors,	// All the doors are connected or blocked before the rules stopped.
+	MaxRooms,		// The maximum number of rooms of the simulation has been reached.
+	Failed,			// No first room could be chosen.
+};
+
+// A room placed by the simulator, with only what is needed to connect and overlap the rooms.
+// Everything is in room units, like the doors and bounds of the room data.
+struct FDungeonSimulatedRoom
+{
+	const URoomData* RoomData {nullptr};
+
+	// Rule which has chosen this room.
+	int32 Rule {INDEX_NONE};
+
+	FIntVector Location {0};
+
+	// Number of quarter turns (same values as EDoorDirection).
+	uint8 Rotation {0};
+
+	// Cells occupied by the room, both inclusive.
+	FIntVector BoundsMin {0};
+	FIntVector BoundsMax {0};
+
+	// Index of the room connected to each door of the room data, INDEX_NONE when not connected.
+	TArray<int32> Connections;
+};
+
+// A room chosen by the rules during a simulation, in the order the room choosers have been called.
+// Recorded even when the room could not be placed, so a generator can replay the same choices.
+// Also records the state of the rules when the room chooser has been called, so the replay can be checked step by step.
+struct FDungeonSimulatedChoice
+{
+	// Room and door from which the room has been chosen (nullptr for the first room).
+	const URoomData* ParentRoom {nullptr};
+	int32 ParentDoor {INDEX_NONE};
+
+	// Index of the parent room in the rooms of the layout, INDEX_NONE for the first room.
+	int32 ParentIndex {INDEX_NONE};
+
+	URoomData* RoomData {nullptr};
+
+	// Door of the room placed against the parent door, INDEX_NONE when the room has no compatible door.
+	int32 DoorIndex {INDEX_NONE};
+
+	// Rule whose room chooser has been called, and number of rooms already placed at that time.
+	int32 Rule {INDEX_NONE};
+	int32 NumRooms {0};
+
+	// Random stream of the generation when the room chooser has been called,
+	// and number of values the room chooser has drawn from it (INDEX_NONE when too many to be replayed).
+	int32 RandomBefore {0};
+	int32 NumChooserDraws {0};
+
+	// Rule returned by the transitions once the room has been placed, and number of values their conditions have drawn.
+	int32 NextRule {INDEX_NONE};
+	int32 NumRuleDraws {0};
+
+	bool bPlaced {false};
+};
+
+// Abstract layout of a dungeon: rooms and connections without any actor.
+struct DUNGEONRULES_API FDungeonSimulatedLayout
+{
+public:
+	void Reset();
+
+	// Returns true if the cells of the room overlap any room of the layout.
+	bool Overlaps(const FIntVector& BoundsMin, const FIntVector& BoundsMax) const;
+
+public:
+	TArray<FDungeonSimulatedRoom> Rooms;
+	TArray<FDungeonSimulatedChoice> Choices;
+	int32 NumFailedRooms {0};
+	EDungeonSimulationEnd End {EDungeonSimulationEnd::Failed};
+};
+
+struct FDungeonSimulationSettings
+{
+	int32 FirstSeed {0};
+	int32 NumSeeds {1000};
+
+	// The simulation of a seed ends when this number of rooms is reached, even if the rules didn't stop.
+	int32 MaxRooms {500};
+
+	// Seeds are simulated on worker threads when the program is thread safe.
+	bool bParallel {true};
+};
+
+// Outcome of the simulation of a single seed.
+struct FDungeonSimulationResult
+{
+	int32 Seed {0};
+	int32 NumRooms {0};
+	int32 NumFailedRooms {0};
+	EDungeonSimulationEnd End {EDungeonSimulationEnd::Failed};
+};
+
+// Where a simulation run in several steps is.
+struct FDungeonSimulationCursor
+{
+	// Random stream of the simulated generation, seeded by Begin.
+	// Like the stream of a generator, it is used both by the rules and to place the rooms.
+	FRandomStream Random;
+
+	// Room and door to process next.
+	int32 RoomIndex {0};
+	int32 Door {0};
+
+	bool bFinished {true};
+};
+
+// Aggregated results of the simulation of many seeds.
+struct DUNGEONRULES_API FDungeonSimulationStats
+{
+public:
+	void Add(const FDungeonSimulatedLayout& Layout);
+	void Merge(const FDungeonSimulationStats& Other);
+
+	FORCEINLINE double GetAverageRooms() const { return (NumGenerations > 0) ? static_cast<double>(TotalRooms) / NumGenerations : 0.0; }
+	FORCEINLINE int32 GetNumEnds(EDungeonSimulationEnd End) const { return Ends[static_cast<uint8>(End)]; }
+
+	// Writes the statistics in a human readable form, using the program to get the names of the rules.
+	void Dump(FOutputDevice& Output, const FDungeonRulesProgram* Program = nullptr) const;
+
+public:
+	int32 NumGenerations {0};
+	int32 MinRooms {MAX_int32};
+	int32 MaxRooms {0};
+	int64 TotalRooms {0};
+	int64 TotalFailedRooms {0};
+	int32 Ends[4] {0, 0, 0, 0};
+
+	// Number of rooms chosen by each rule of the program.
+	TArray<int64> RuleRooms;
+
+	// Number of rooms using each room data.
+	TMap<const URoomData*, int64> RoomDataRooms;
+
+	// Wall time of the whole simulation.
+	double Seconds {0.0};
+};
+
+// Runs the dungeon rules against an abstract model of the rooms (room data, doors and bounds), without world nor actor.
+// Rooms are added breadth first from the doors of the previous ones, and are discarded when they overlap another room.
+// It is not a replica of the dungeon generator: it gives the same kind of dungeons, not the same dungeons for a seed.
+// The program must have its room data loaded, and is only simulated from the game thread when it is not thread safe.
+// There is no generator nor room instance: the contexts given to the conditions and room choosers have a null Generator
+// and PreviousRoom, so the Blueprint implementations must handle them (the native ones use the histogram and random stream).
+// The rules and the placement of the rooms draw from a single stream seeded with the seed, as in the generator.
+class DUNGEONRULES_API FDungeonRulesSimulator
+{
+public:
+	explicit FDungeonRulesSimulator(const FDungeonRulesProgram& InProgram);
+
+	// True when several seeds can be simulated concurrently.
+	FORCEINLINE bool IsThreadSafe() const { return bThreadSafe; }
+
+	// Simulates a single generation, reusing the memory of the state and layout.
+	// Returns false when no first room could be chosen.
+	bool Simulate(int32 Seed, int32 MaxRooms, FDungeonRulesRuntimeState& State, FDungeonSimulatedLayout& OutLayout) const;
+
+	// Same as Simulate, but in several steps (e.g. a few per frame): Begin chooses the first room,
+	// then Step processes the doors until the simulation ends or the deadline (in FPlatformTime::Seconds) is passed.
+	// The choices are the same as Simulate for the same seed, whatever the number of steps.
+	// Step returns true once the simulation is finished.
+	bool Begin(int32 Seed, FDungeonRulesRuntimeState& State, FDungeonSimulatedLayout& OutLayout, FDungeonSimulationCursor& OutCursor) const;
+	bool Step(int32 MaxRooms, double Deadline, FDungeonRulesRuntimeState& State, FDungeonSimulatedLayout& Layout, FDungeonSimulationCursor& Cursor) const;
+
+	// Simulates all the seeds of the settings, and optionally keeps the result of each seed (ordered by seed).
+	FDungeonSimulationStats Run(const FDungeonSimulationSettings& Settings, TArray<FDungeonSimulationResult>* OutResults = nullptr) const;
+
+	// Simulates the candidate seeds (concurrently when thread safe) and returns the index of the first one
+	// giving a layout accepted by the function, or INDEX_NONE if none is accepted.
+	// Only the layouts the rules have finished are given to the function.
+	// The function must be thread safe, and later candidates are skipped once a candidate is accepted.
+	int32 FindFirstValidSeed(TConstArrayView<int32> Seeds, int32 MaxRooms, TFunctionRef<bool(const FDungeonSimulatedLayout&)> IsLayoutValid, FDungeonSimulatedLayout& OutLayout) const;
+
+	static const TCHAR* GetEndName(EDungeonSimulationEnd End);
+
+private:
+	void AddRoom(FDungeonSimulatedLayout& Layout, const URoomData* RoomData, int32 Rule, const FIntVector& Location, uint8 Rotation) const;
+
+	// Places the room against the door of the parent room, or returns false if it can't be placed.
+	// A compatible door of the room is chosen randomly when DoorIndex is negative, and DoorIndex is set to the door used.
+	bool TryConnectRoom(FDungeonSimulatedLayout& Layout, int32 ParentIndex, int32 ParentDoor, const URoomData* RoomData, int32 Rule, int32& DoorIndex, const FRandomStream& Random) const;
+
+private:
+	const FDungeonRulesProgram& Program;
+	bool bThreadSafe {false};
+};
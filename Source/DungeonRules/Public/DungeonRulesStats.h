@@ -0,0 +1,40 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Displayed with 'stat DungeonRules'.
+DECLARE_STATS_GROUP(TEXT("DungeonRules"), STATGROUP_DungeonRules, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get First Room Data"), STAT_DungeonRules_GetFirstRoomData, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Next Room Data"), STAT_DungeonRules_GetNextRoomData, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Get Next Rule"), STAT_DungeonRules_GetNextRule, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Is Dungeon Valid"), STAT_DungeonRules_IsDungeonValid, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Can Still Be Valid"), STAT_DungeonRules_CanStillBeValid, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Initialize Dungeon"), STAT_DungeonRules_InitializeDungeon, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Pre Generation"), STAT_DungeonRules_OnPreGeneration, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Post Generation"), STAT_DungeonRules_OnPostGeneration, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Generation Init"), STAT_DungeonRules_OnGenerationInit, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Generation Failed"), STAT_DungeonRules_OnGenerationFailed, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Room Added"), STAT_DungeonRules_OnRoomAdded, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Failed To Add Room"), STAT_DungeonRules_OnFailedToAddRoom, STATGROUP_DungeonRules, DUNGEONRULES_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("On Rooms Added"), STAT_DungeonRules_OnRoomsAdded, STATGROUP_DungeonRules, DUNGEONRULES_API);
+
+// Enabled in Unreal Insights with '-trace=cpu,DungeonRules'.
+UE_TRACE_CHANNEL_EXTERN(DungeonRulesChannel, DUNGEONRULES_API);
+
+// Scope named after the graph node being evaluated (rule, condition, room chooser, etc.) in the DungeonRules trace channel.
+// The name is only built when the channel is enabled.
+#if CPUPROFILERTRACE_ENABLED
+	#define DUNGEONRULES_TRACE_SCOPE(Name) \
+		TRACE_CPUPROFILER_EVENT_SCOPE_TEXT_ON_CHANNEL(*(UE_TRACE_CHANNELEXPR_IS_ENABLED(DungeonRulesChannel) ? FString(Name) : FString()), DungeonRulesChannel)
+#else
+	#define DUNGEONRULES_TRACE_SCOPE(Name)
+#endif
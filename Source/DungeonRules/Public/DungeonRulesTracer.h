@@ -0,0 +1,76 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FDungeonRulesProgram;
+
+enum class EDungeonRulesTraceResult : uint8
+{
+	Failed,		// The transition condition was not fulfilled.
+	Passed,		// The transition condition was fulfilled.
+	NextRule,	// The rule selected at the end of the step (Transition is INDEX_NONE).
+	Start,		// A new generation started from the rule (Transition is INDEX_NONE).
+};
+
+// A decision taken during the evaluation of the dungeon rules.
+// Indices refer to the compiled program of the rules asset.
+struct FDungeonRulesTraceRecord
+{
+	uint32 Step {0};
+	int32 Rule {INDEX_NONE};
+	int32 Transition {INDEX_NONE};
+	EDungeonRulesTraceResult Result {EDungeonRulesTraceResult::Failed};
+
+	// Time spent evaluating the transition (its condition and the conduit it leads to), 0 for the other results.
+	float Seconds {0.0f};
+};
+
+// Fixed-size ring buffer keeping the last decisions taken by the dungeon rules.
+// The buffer is only allocated when enabled, and the oldest records are overwritten once full.
+struct DUNGEONRULES_API FDungeonRulesTracer
+{
+public:
+	// Enables the tracer with the capacity set by the console variable 'DungeonRules.Trace'.
+	// Disables and frees the tracer when it is 0.
+	void Configure();
+
+	// Enables the tracer with a capacity rounded up to a power of two, or disables it when 0.
+	void SetCapacity(int32 NewCapacity);
+	void Clear();
+
+	FORCEINLINE bool IsEnabled() const { return Records.Num() > 0; }
+	FORCEINLINE int32 Num() const { return static_cast<int32>(FMath::Min<uint64>(WriteIndex, Records.Num())); }
+
+	void BeginGeneration(int32 FirstRule);
+	void BeginStep(int32 CurrentRule);
+	void RecordTransition(int32 Transition, bool bPassed, float Seconds = 0.0f);
+	void EndStep(int32 NextRule);
+
+	// Calls the function on each record, from the oldest to the newest.
+	void ForEachRecord(TFunctionRef<void(const FDungeonRulesTraceRecord&)> Func) const;
+
+	// Writes the records in a human readable form, using the program to get the names of the rules.
+	void Dump(FOutputDevice& Output, const FDungeonRulesProgram* Program = nullptr) const;
+
+	// Writes the raw records in a binary file, with the path of the rules asset and the hash of the program which recorded them.
+	bool SaveToFile(const FString& FilePath, const FString& AssetPath, const FDungeonRulesProgram& Program) const;
+
+	// Reads the records of a trace file recorded by the program of the rules asset.
+	// Returns false, leaving OutRecords untouched, when the file is invalid, truncated, recorded by another asset or program,
+	// or when any record doesn't match the program.
+	static bool LoadFromFile(const FString& FilePath, const FString& AssetPath, const FDungeonRulesProgram& Program, TArray<FDungeonRulesTraceRecord>& OutRecords);
+
+private:
+	void Record(int32 Rule, int32 Transition, EDungeonRulesTraceResult Result, float Seconds = 0.0f);
+
+private:
+	TArray<FDungeonRulesTraceRecord> Records;
+	uint64 WriteIndex {0};
+	uint32 Step {0};
+	int32 CurrentRule {INDEX_NONE};
+};
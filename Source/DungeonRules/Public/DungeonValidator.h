@@ -10,6 +10,9 @@
 #include "DungeonValidator.generated.h"
 
 class ADungeonGenerator;
+class IReadOnlyRoom;
+struct FDungeonSimulatedLayout;
+struct FDungeonRulesEvent;
 
 UCLASS(Abstract, BlueprintType, Blueprintable, EditInlineNew)
 class DUNGEONRULES_API UDungeonValidator : public UObject
@@ -17,6 +20,43 @@ class DUNGEONRULES_API UDungeonValidator : public UObject
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	//~ End UObject Interface
+
 	UFUNCTION(BlueprintPure, BlueprintNativeEvent, Category = "Dungeon Rules")
 	bool IsDungeonValid(const ADungeonGenerator* Generator) const;
+
+	// Called each time a room is added, so the generation can be aborted as soon as the dungeon can't be valid anymore.
+	// Return false only when the dungeon will be invalid whatever the next rooms are.
+	// IsDungeonValid is still called once the generation is finished.
+	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Dungeon Rules")
+	bool CanStillBeValid(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom) const;
+
+	// Same as CanStillBeValid, but calls CanStillBeValid_Implementation directly when not implemented in Blueprint.
+	bool DispatchCanStillBeValid(const ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& NewRoom) const;
+
+	// Checks the abstract layout of a simulated generation, before any room is spawned.
+	// Must be thread safe, and return false only when the dungeon would be invalid for sure:
+	// the spawned dungeon is still validated by IsDungeonValid.
+	virtual bool IsLayoutValid(const FDungeonSimulatedLayout& Layout) const { return true; }
+
+	// Override it to return true when IsLayoutValid is overridden.
+	// The speculative generation is skipped when no validator can reject a layout.
+	virtual bool SupportsLayoutValidation() const { return false; }
+
+	// True when the dungeon can be validated from any thread, concurrently with other generations.
+	// Always false when IsDungeonValid is implemented in Blueprint.
+	FORCEINLINE bool IsThreadSafe() const { return !BlueprintIsDungeonValid && IsNativeThreadSafe(); }
+
+protected:
+	// Override it to return true when IsDungeonValid_Implementation only reads the generator and this validator.
+	virtual bool IsNativeThreadSafe() const { return false; }
+
+private:
+	// Blueprint implementation of IsDungeonValid, if any.
+	TSharedPtr<const FDungeonRulesEvent> BlueprintIsDungeonValid;
+
+	// Blueprint implementation of CanStillBeValid, if any.
+	TSharedPtr<const FDungeonRulesEvent> BlueprintCanStillBeValid;
 };
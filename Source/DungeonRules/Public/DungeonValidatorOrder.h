@@ -0,0 +1,51 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UDungeonValidator;
+
+// Order in which the validators are evaluated, learned from their cost and failure rate.
+// Validating stops at the first failure, so the validators with the lowest cost per failure are evaluated first.
+struct DUNGEONRULES_API FDungeonValidatorOrder
+{
+	struct FStats
+	{
+		int32 NumCalls {0};
+		int32 NumFailures {0};
+		double Seconds {0.0};
+
+		FORCEINLINE double GetAverageCost() const { return (NumCalls > 0) ? Seconds / NumCalls : 0.0; }
+
+		// Smoothed, so a validator which never failed yet still has a chance to fail.
+		FORCEINLINE double GetFailureRate() const { return (NumFailures + 1.0) / (NumCalls + 2.0); }
+
+		// Expected time spent for each failure found by the validator.
+		FORCEINLINE double GetPriority() const { return GetAverageCost() / GetFailureRate(); }
+	};
+
+public:
+	// Makes the order contain the validators, keeping the order and stats of the ones already known.
+	// New validators are evaluated first, until their cost is known.
+	void Update(TConstArrayView<TObjectPtr<UDungeonValidator>> Validators);
+	void Reset();
+
+	void Record(const UDungeonValidator* Validator, double Seconds, bool bPassed);
+
+	// Adds the stats of the other order to these ones, then sorts the validators.
+	void Merge(const FDungeonValidatorOrder& Other);
+
+	// Sorts the validators by ascending priority.
+	void Sort();
+
+	FORCEINLINE const TArray<const UDungeonValidator*>& Get() const { return Order; }
+	FORCEINLINE const FStats* FindStats(const UDungeonValidator* Validator) const { return Stats.Find(Validator); }
+
+private:
+	TArray<const UDungeonValidator*> Order;
+	TMap<const UDungeonValidator*, FStats> Stats;
+};
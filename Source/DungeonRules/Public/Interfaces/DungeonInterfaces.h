@@ -7,14 +7,9 @@
 
 #include "CoreMinimal.h"
 #include "UObject/Interface.h"
-#include "UObject/ScriptInterface.h"
 #include "DungeonInterfaces.generated.h"
 
-class ADungeonGenerator;
-class URoomData;
-class UDungeonRule;
-class IReadOnlyRoom;
-
+// Implemented by the nodes a transition can lead to (rules and conduits).
 UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
 class UDungeonRuleProvider : public UInterface
 {
@@ -24,21 +19,4 @@ class UDungeonRuleProvider : public UInterface
 class DUNGEONRULES_API IDungeonRuleProvider
 {
 	GENERATED_BODY()
-public:
-	virtual const UDungeonRule* GetRule(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const = 0;
-};
-
-/////////////////////////////////////////
-
-UINTERFACE(MinimalAPI, meta = (CannotImplementInterfaceInBlueprint))
-class UDungeonConditionProvider : public UInterface
-{
-	GENERATED_BODY()
-};
-
-class DUNGEONRULES_API IDungeonConditionProvider
-{
-	GENERATED_BODY()
-public:
-	virtual bool CheckCondition(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const = 0;
 };
@@ -7,6 +7,7 @@
 
 #include "CoreMinimal.h"
 #include "DungeonRoomChooser.h"
+#include "DungeonRoomCandidates.h"
 #include "DRR_RandomData.generated.h"
 
 UCLASS(meta = (DisplayName = "Random Data (Uniform)"))
@@ -15,13 +16,44 @@ class DUNGEONRULES_API UDRR_RandomData : public UDungeonRoomChooser
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	//~ End UObject Interface
+
 	//~ Begin UDungeonRoomChooser Interface
 	virtual URoomData* ChooseFirstRoomData_Implementation(ADungeonGenerator* Generator) const override;
 	virtual URoomData* ChooseNextRoomData_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const override;
 	virtual FText GetDescription_Implementation() const override;
+	virtual void GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const override;
+	virtual void OnRoomDataLoaded() override;
+	virtual void OnRoomDataReleased() override;
 	//~ End UDungeonRoomChooser Interface
 
+protected:
+	//~ Begin UDungeonRoomChooser Interface
+	virtual URoomData* ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const override;
+	virtual URoomData* ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const override;
+	virtual bool IsNativeThreadSafe() const override { return true; }
+	//~ End UDungeonRoomChooser Interface
+
+public:
+#if WITH_DEV_AUTOMATION_TESTS
+	void SetRoomList(const TArray<URoomData*>& NewList);
+#endif
+
+private:
+	void BuildCandidates();
+
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Room Chooser")
-	TArray<TObjectPtr<URoomData>> RoomList {nullptr};
+	TArray<TSoftObjectPtr<URoomData>> RoomList {nullptr};
+
+private:
+	// Rooms of the list that can be connected to each door type.
+	FDungeonRoomCandidates Candidates;
 };
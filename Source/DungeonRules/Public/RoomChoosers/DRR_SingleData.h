@@ -15,13 +15,40 @@ class DUNGEONRULES_API UDRR_SingleData : public UDungeonRoomChooser
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	//~ End UObject Interface
+
 	//~ Begin UDungeonRoomChooser Interface
 	virtual URoomData* ChooseFirstRoomData_Implementation(ADungeonGenerator* Generator) const override;
 	virtual URoomData* ChooseNextRoomData_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const override;
 	virtual FText GetDescription_Implementation() const override;
+	virtual void GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const override;
+	virtual void OnRoomDataLoaded() override;
+	virtual void OnRoomDataReleased() override;
 	//~ End UDungeonRoomChooser Interface
 
+protected:
+	//~ Begin UDungeonRoomChooser Interface
+	virtual URoomData* ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const override;
+	virtual URoomData* ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const override;
+	virtual bool IsNativeThreadSafe() const override { return true; }
+	//~ End UDungeonRoomChooser Interface
+
+private:
+	void ResolveRoomData();
+
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Room Chooser")
-	TObjectPtr<URoomData> RoomData {nullptr};
+	TSoftObjectPtr<URoomData> RoomData {nullptr};
+
+private:
+	// Resolving the soft pointer may look for the object, which is not safe outside of the game thread.
+	// Reported to the GC like the candidates of the other room choosers, so it keeps the room data loaded.
+	TObjectPtr<URoomData> LoadedRoomData {nullptr};
 };
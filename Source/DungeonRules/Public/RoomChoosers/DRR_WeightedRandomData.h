@@ -7,6 +7,7 @@
 
 #include "CoreMinimal.h"
 #include "DungeonRoomChooser.h"
+#include "DungeonRoomCandidates.h"
 #include "DRR_WeightedRandomData.generated.h"
 
 USTRUCT(BlueprintType)
@@ -16,7 +17,7 @@ struct FRoomWeightPair
 
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Room Chooser")
-	TObjectPtr<URoomData> RoomData {nullptr};
+	TSoftObjectPtr<URoomData> RoomData {nullptr};
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Room Chooser")
 	int Weight {1};
@@ -28,13 +29,47 @@ class DUNGEONRULES_API UDRR_WeightedRandomData : public UDungeonRoomChooser
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	virtual void PostLoad() override;
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+	//~ End UObject Interface
+
 	//~ Begin UDungeonRoomChooser Interface
 	virtual URoomData* ChooseFirstRoomData_Implementation(ADungeonGenerator* Generator) const override;
 	virtual URoomData* ChooseNextRoomData_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom, const FDoorDef& DoorData, int& DoorIndex) const override;
 	virtual FText GetDescription_Implementation() const override;
+	virtual void GetRoomDataToLoad(TArray<FSoftObjectPath>& OutRoomData) const override;
+	virtual void OnRoomDataLoaded() override;
+	virtual void OnRoomDataReleased() override;
+	//~ End UDungeonRoomChooser Interface
+
+	// Picks a room data from the list, using the random stream.
+	URoomData* ChooseRoomData(const FRandomStream& Random) const;
+
+protected:
+	//~ Begin UDungeonRoomChooser Interface
+	virtual URoomData* ChooseFirstRoomDataWithContext(const FDungeonRulesEvaluationContext& Context) const override;
+	virtual URoomData* ChooseNextRoomDataWithContext(const FDungeonRulesEvaluationContext& Context, const FDoorDef& DoorData, int& DoorIndex) const override;
+	virtual bool IsNativeThreadSafe() const override { return true; }
 	//~ End UDungeonRoomChooser Interface
 
+public:
+#if WITH_DEV_AUTOMATION_TESTS
+	void SetWeightedRoomList(const TArray<FRoomWeightPair>& NewList);
+#endif
+
+private:
+	void BuildCandidates();
+
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Room Chooser")
 	TArray<FRoomWeightPair> WeightedRoomList {};
+
+private:
+	// Built from the weighted room list, so choosing a room does not need any allocation.
+	FDungeonRoomCandidates Candidates;
 };
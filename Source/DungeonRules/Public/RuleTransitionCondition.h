@@ -13,6 +13,10 @@
 class URoomData;
 class ADungeonGenerator;
 class IReadOnlyRoom;
+struct FDungeonRulesProgram;
+struct FDungeonConditionExpression;
+struct FDungeonRulesEvaluationContext;
+struct FDungeonRulesEvent;
 
 UCLASS(Abstract, Blueprintable, BlueprintType, EditInlineNew)
 class DUNGEONRULES_API URuleTransitionCondition : public UObject
@@ -20,9 +24,52 @@ class DUNGEONRULES_API URuleTransitionCondition : public UObject
 	GENERATED_BODY()
 
 public:
+	//~ Begin UObject Interface
+	virtual void PostInitProperties() override;
+	//~ End UObject Interface
+
+	// Checked at most once per generation step by the dungeon rules: the result is reused when
+	// several transitions (e.g. through conduits) share this condition during the same step.
+	// Generator and PreviousRoom are null when the rules are simulated without generator.
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Dungeon Rules")
 	bool Check(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const;
 
 	UFUNCTION(BlueprintNativeEvent, BlueprintCallable, Category = "Dungeon Rules")
 	FText GetDescription() const;
+
+	// Called when the dungeon rules using this condition are compiled.
+	// Override it to register data needed during the generation (e.g. room counters) in the program.
+	// Conditions containing other conditions must forward the call to them.
+	virtual void OnCompile(FDungeonRulesProgram& Program) const {}
+
+	// Adds the nodes evaluating this condition in the expression compiled into the program's bytecode, and returns the root one.
+	// By default, a single node calling Check. Override it only when the nodes alone can compute the result.
+	// Not called when Check is implemented in Blueprint.
+	virtual int32 BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const;
+
+	// Same as Check, but calls Check_Implementation directly when Check is not implemented in Blueprint.
+	// Use this one from C++.
+	bool DispatchCheck(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const;
+
+	// Same as DispatchCheck, but calls CheckWithContext when Check is not implemented in Blueprint.
+	// This is the one called by the dungeon rules.
+	bool DispatchCheck(const FDungeonRulesEvaluationContext& Context) const;
+
+	FORCEINLINE bool HasBlueprintCheck() const { return BlueprintCheck != nullptr; }
+
+	// True when the condition can be checked from any thread, concurrently with other generations.
+	// Always false when Check is implemented in Blueprint.
+	FORCEINLINE bool IsThreadSafe() const { return !HasBlueprintCheck() && IsNativeThreadSafe(); }
+
+protected:
+	// C++ implementation of the condition using only the read-only context.
+	// By default, calls Check_Implementation with the generator of the context.
+	virtual bool CheckWithContext(const FDungeonRulesEvaluationContext& Context) const;
+
+	// Override it to return true when CheckWithContext only reads the context and this condition.
+	virtual bool IsNativeThreadSafe() const { return false; }
+
+private:
+	// Blueprint implementation of Check, if any.
+	TSharedPtr<const FDungeonRulesEvent> BlueprintCheck;
 };
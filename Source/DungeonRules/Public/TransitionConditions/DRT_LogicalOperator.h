@@ -25,6 +25,14 @@ public:
 	//~ Begin URuleTransitionCondition Interface
 	virtual bool Check_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const override;
 	virtual FText GetDescription_Implementation() const override;
+	virtual void OnCompile(FDungeonRulesProgram& Program) const override;
+	virtual int32 BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const override;
+	//~ End URuleTransitionCondition Interface
+
+protected:
+	//~ Begin URuleTransitionCondition Interface
+	virtual bool CheckWithContext(const FDungeonRulesEvaluationContext& Context) const override;
+	virtual bool IsNativeThreadSafe() const override;
 	//~ End URuleTransitionCondition Interface
 
 protected:
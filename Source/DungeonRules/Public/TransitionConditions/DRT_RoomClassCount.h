@@ -20,8 +20,21 @@ public:
 	//~ Begin URuleTransitionCondition Interface
 	virtual bool Check_Implementation(ADungeonGenerator* Generator, const TScriptInterface<IReadOnlyRoom>& PreviousRoom) const override;
 	virtual FText GetDescription_Implementation() const override;
+	virtual void OnCompile(FDungeonRulesProgram& Program) const override;
+	virtual int32 BuildExpression(FDungeonConditionExpression& Expression, const FDungeonRulesProgram& Program) const override;
 	//~ End URuleTransitionCondition Interface
 
+protected:
+	//~ Begin URuleTransitionCondition Interface
+	virtual bool CheckWithContext(const FDungeonRulesEvaluationContext& Context) const override;
+	virtual bool IsNativeThreadSafe() const override;
+	//~ End URuleTransitionCondition Interface
+
+private:
+	// Counts the rooms of the generator when the histogram has no counter for this condition.
+	// Always false outside of the game thread, where the rooms of the generator can't be read.
+	bool CheckGeneratorRooms(const FDungeonRulesEvaluationContext& Context) const;
+
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Transition Condition")
 	EComparisonOp Comparison {EComparisonOp::Equal};
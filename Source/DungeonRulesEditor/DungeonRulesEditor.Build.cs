@@ -31,6 +31,7 @@ public class DungeonRulesEditor : ModuleRules
 				//"KismetWidgets", // for SKismetLinearExpression
 				"BlueprintGraph", // UEdGraphSchema_K2
 				"ToolMenus",
+				"DesktopPlatform", // trace files dialog
 			}
 		);
 	}
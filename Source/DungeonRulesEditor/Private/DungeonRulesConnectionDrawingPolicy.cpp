@@ -8,6 +8,7 @@
 #include "Nodes/DungeonRulesNode_Begin.h"
 #include "Nodes/DungeonRulesNode_Transition.h"
 #include "NodeSlates/SGraphNodeDungeonRules_Transition.h"
+#include "DungeonRulesHeatmapOverlay.h"
 
 class FSlateRect;
 class SWidget;
@@ -35,6 +36,14 @@ void FDungeonRulesConnectionDrawingPolicy::DetermineWiringStyle(UEdGraphPin* Out
 		{
 			const bool IsInputPinHovered = HoveredPins.Contains(InputPin);
 			Params.WireColor = SGraphNodeDungeonRules_Transition::StaticGetTransitionColor(TransNode, IsInputPinHovered);
+
+			// The hottest transitions are drawn thicker, so the paths mostly taken are easy to follow.
+			if (const FDungeonRulesHeatmapOverlay* Heatmap = FDungeonRulesHeatmapOverlay::Get(TransNode))
+			{
+				const TOptional<float> Heat = Heatmap->GetHeat(TransNode->GetNodeInstance());
+				if (Heat.IsSet())
+					Params.WireThickness = FMath::Lerp(1.5f, 5.0f, Heat.GetValue());
+			}
 		}
 	}
 
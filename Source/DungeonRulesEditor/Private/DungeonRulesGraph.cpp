@@ -18,6 +18,7 @@
 // When modifying the structure of the graph, a new version should be added.
 // (don't forget to update the Latest value!!!)
 // (also, don't forget to update the UpdateVersion() to upgrade the graph to the latest version!!!)
+// The data serialized by the runtime asset (e.g. the cooked program) is versioned by FDungeonRulesCustomVersion instead.
 namespace DungeonRulesVersion
 {
 	const int32 Initial = 0;
@@ -143,6 +144,20 @@ void UDungeonRulesGraph::UpdateAsset(int32 UpdateFlags)
 			Transition->NextRule = NextRuleNode->GetNodeInstance();
 		}
 	}
+
+	// Rebuild the program used at runtime from the new data.
+	DungeonRulesAsset->Compile();
+
+	// Not an error, the generation only needs the game thread then.
+	if (!DungeonRulesAsset->IsThreadSafe())
+	{
+		FString Names;
+		for (const UObject* Object : DungeonRulesAsset->GetNotThreadSafeObjects())
+		{
+			Names += FString::Printf(TEXT(" '%s'"), *GetNameSafe(Object));
+		}
+		DungeonEd_LogInfo("Dungeon rules '%s' can't be evaluated off the game thread because of:%s", *GetNameSafe(DungeonRulesAsset), *Names);
+	}
 }
 
 void UDungeonRulesGraph::OnCreated()
@@ -218,4 +233,12 @@ void UDungeonRulesGraph::UnlockUpdates()
 	//UpdateAsset();
 }
 
+void UDungeonRulesGraph::SetHeatmapOverlay(TSharedPtr<FDungeonRulesHeatmapOverlay> InOverlay)
+{
+	HeatmapOverlay = InOverlay;
+
+	// Rebuilds the node widgets so they show the new values.
+	NotifyGraphChanged();
+}
+
 #undef LOCTEXT_NAMESPACE
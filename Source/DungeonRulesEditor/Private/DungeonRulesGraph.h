@@ -7,6 +7,7 @@
 
 #include "CoreMinimal.h"
 #include "EdGraph/EdGraph.h"
+#include "DungeonRulesHeatmapOverlay.h"
 #include "DungeonRulesGraph.generated.h"
 
 UCLASS(MinimalAPI)
@@ -42,6 +43,10 @@ public:
 	void LockUpdates();
 	void UnlockUpdates();
 
+	// Heatmap drawn over the nodes by their widgets, null when there is none.
+	FORCEINLINE const FDungeonRulesHeatmapOverlay* GetHeatmapOverlay() const { return HeatmapOverlay.Get(); }
+	void SetHeatmapOverlay(TSharedPtr<FDungeonRulesHeatmapOverlay> InOverlay);
+
 	//~ Begin UObject Interface.
 	virtual void Serialize(FArchive& Ar) override;
 	//~ End UObject Interface.
@@ -56,5 +61,8 @@ protected:
 	virtual void OnNodeInstanceRemoved(UObject* NodeInstance);
 
 	UEdGraphPin* FindGraphNodePin(UEdGraphNode* Node, EEdGraphPinDirection Dir);
+
+private:
+	TSharedPtr<FDungeonRulesHeatmapOverlay> HeatmapOverlay {nullptr};
 };
 
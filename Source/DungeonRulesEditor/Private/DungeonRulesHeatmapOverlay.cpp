@@ -0,0 +1,137 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#include "DungeonRulesHeatmapOverlay.h"
+#include "DungeonRules.h"
+#include "DungeonRulesGraph.h"
+#include "EdGraph/EdGraphNode.h"
+
+#define LOCTEXT_NAMESPACE "DungeonRulesHeatmapOverlay"
+
+namespace
+{
+	void Accumulate(FDungeonRulesHeatmap::FEntry& Total, const FDungeonRulesHeatmap::FEntry* Entry)
+	{
+		if (!Entry)
+			return;
+		Total.Visits += Entry->Visits;
+		Total.Passes += Entry->Passes;
+		Total.Seconds += Entry->Seconds;
+	}
+
+	void UpdateMax(FDungeonRulesHeatmap::FEntry& Max, const FDungeonRulesHeatmap::FEntry& Entry)
+	{
+		Max.Visits = FMath::Max(Max.Visits, Entry.Visits);
+		Max.Passes = FMath::Max(Max.Passes, Entry.Passes);
+		Max.Seconds = FMath::Max(Max.Seconds, Entry.Seconds);
+	}
+}
+
+FDungeonRulesHeatmapOverlay::FDungeonRulesHeatmapOverlay(const UDungeonRules& DungeonRules, const FDungeonRulesHeatmap& Heatmap, EMode InMode)
+	: NumRecords(Heatmap.GetNumRecords())
+	, Mode(InMode)
+{
+	// All the compiled nodes are added, so the ones never reached can be told apart from the ones not in the overlay.
+	const FDungeonRulesProgram& Program = DungeonRules.GetProgram();
+	for (int32 i = 0; i < Program.Rules.Num(); ++i)
+	{
+		if (const UObject* Rule = Program.Rules[i].Rule)
+			Accumulate(Rules.FindOrAdd(Rule), Heatmap.FindRule(i));
+	}
+
+	for (int32 i = 0; i < Program.Transitions.Num(); ++i)
+	{
+		if (const UObject* Transition = Program.Transitions[i].Source)
+			Accumulate(Transitions.FindOrAdd(Transition), Heatmap.FindTransition(i));
+	}
+
+	for (const auto& Pair : Rules)
+	{
+		UpdateMax(MaxRule, Pair.Value);
+	}
+
+	for (const auto& Pair : Transitions)
+	{
+		UpdateMax(MaxTransition, Pair.Value);
+	}
+}
+
+const FDungeonRulesHeatmap::FEntry* FDungeonRulesHeatmapOverlay::Find(const UObject* NodeInstance) const
+{
+	if (const FDungeonRulesHeatmap::FEntry* Entry = Rules.Find(NodeInstance))
+		return Entry;
+	return Transitions.Find(NodeInstance);
+}
+
+TOptional<float> FDungeonRulesHeatmapOverlay::GetHeat(const UObject* NodeInstance) const
+{
+	const FDungeonRulesHeatmap::FEntry* Max = &MaxRule;
+	const FDungeonRulesHeatmap::FEntry* Entry = Rules.Find(NodeInstance);
+	if (!Entry)
+	{
+		Max = &MaxTransition;
+		Entry = Transitions.Find(NodeInstance);
+	}
+
+	if (!Entry || Entry->Visits <= 0)
+		return TOptional<float>();
+
+	const float MaxValue = GetValue(*Max);
+	return (MaxValue > 0.0f) ? FMath::Clamp(GetValue(*Entry) / MaxValue, 0.0f, 1.0f) : 0.0f;
+}
+
+FLinearColor FDungeonRulesHeatmapOverlay::GetColor(const UObject* NodeInstance, const FLinearColor& DefaultColor) const
+{
+	if (!Find(NodeInstance))
+		return DefaultColor;
+
+	// Nodes never reached are faded, so the dead parts of the graph stand out.
+	const TOptional<float> Heat = GetHeat(NodeInstance);
+	return Heat.IsSet() ? GetHeatColor(Heat.GetValue()) : DefaultColor.CopyWithNewOpacity(DefaultColor.A * 0.25f);
+}
+
+FText FDungeonRulesHeatmapOverlay::GetStatsText(const UObject* NodeInstance) const
+{
+	if (const FDungeonRulesHeatmap::FEntry* Entry = Rules.Find(NodeInstance))
+	{
+		return FText::Format(LOCTEXT("RuleStats", "{0} visits, {1} ms"), FText::AsNumber(Entry->Visits), FText::AsNumber(Entry->Seconds * 1000.0));
+	}
+
+	if (const FDungeonRulesHeatmap::FEntry* Entry = Transitions.Find(NodeInstance))
+	{
+		return FText::Format(LOCTEXT("TransitionStats", "Checked {0} times, passed {1} times, {2} ms"), FText::AsNumber(Entry->Visits), FText::AsNumber(Entry->Passes), FText::AsNumber(Entry->Seconds * 1000.0));
+	}
+
+	return FText::GetEmpty();
+}
+
+FLinearColor FDungeonRulesHeatmapOverlay::GetHeatColor(float Heat)
+{
+	const FLinearColor ColdColor(0.0f, 0.2f, 0.8f);
+	const FLinearColor HotColor(0.9f, 0.05f, 0.0f);
+	return FLinearColor::LerpUsingHSV(ColdColor, HotColor, Heat);
+}
+
+const FDungeonRulesHeatmapOverlay* FDungeonRulesHeatmapOverlay::Get(const UEdGraphNode* Node)
+{
+	const UDungeonRulesGraph* Graph = Node ? Cast<UDungeonRulesGraph>(Node->GetGraph()) : nullptr;
+	return Graph ? Graph->GetHeatmapOverlay() : nullptr;
+}
+
+float FDungeonRulesHeatmapOverlay::GetValue(const FDungeonRulesHeatmap::FEntry& Entry) const
+{
+	switch (Mode)
+	{
+	case EMode::Visits:
+		return static_cast<float>(Entry.Visits);
+	case EMode::Time:
+		return static_cast<float>(Entry.Seconds);
+	default:
+		checkNoEntry();
+		return 0.0f;
+	}
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,61 @@
+// Copyright (c) 2024 Benoit Pelletier
+// SPDX-License-Identifier: BSL-1.0
+// Distributed under the Boost Software License, Version 1.0. 
+// (See accompanying file LICENSE or copy at https://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "DungeonRulesHeatmap.h"
+
+class UDungeonRules;
+class UEdGraphNode;
+
+// Heat of the rule and transition nodes of a dungeon rules graph, drawn over the graph by the node widgets.
+// Built from the visits and evaluation time recorded by the rules tracer during many generations.
+// The heatmap indices are resolved through the compiled program, so the graph must not have changed since the recording.
+class FDungeonRulesHeatmapOverlay
+{
+public:
+	enum class EMode : uint8
+	{
+		Visits,	// Number of times a rule has been the current rule, or a transition has been checked.
+		Time,	// Time spent evaluating the transitions.
+	};
+
+public:
+	FDungeonRulesHeatmapOverlay(const UDungeonRules& DungeonRules, const FDungeonRulesHeatmap& Heatmap, EMode InMode);
+
+	FORCEINLINE EMode GetMode() const { return Mode; }
+	FORCEINLINE int64 GetNumRecords() const { return NumRecords; }
+
+	// Returns nullptr when the node instance is not a compiled rule or transition (e.g. a conduit), so it is not part of the overlay.
+	const FDungeonRulesHeatmap::FEntry* Find(const UObject* NodeInstance) const;
+
+	// Heat of the node instance between 0 and 1, relative to the hottest node of the same kind.
+	// Unset when the node is not part of the overlay or has never been reached.
+	TOptional<float> GetHeat(const UObject* NodeInstance) const;
+
+	// Color of the node instance, the default color when it is not part of the overlay, or the faded default color when never reached.
+	FLinearColor GetColor(const UObject* NodeInstance, const FLinearColor& DefaultColor) const;
+
+	// Values recorded for the node instance, empty when it is not part of the overlay.
+	FText GetStatsText(const UObject* NodeInstance) const;
+
+	static FLinearColor GetHeatColor(float Heat);
+
+	// Returns the overlay shown on the graph of the node, if any.
+	static const FDungeonRulesHeatmapOverlay* Get(const UEdGraphNode* Node);
+
+private:
+	float GetValue(const FDungeonRulesHeatmap::FEntry& Entry) const;
+
+private:
+	// Entries of the same object compiled several times (e.g. transitions of an alias node) are summed.
+	TMap<const UObject*, FDungeonRulesHeatmap::FEntry> Rules;
+	TMap<const UObject*, FDungeonRulesHeatmap::FEntry> Transitions;
+	FDungeonRulesHeatmap::FEntry MaxRule;
+	FDungeonRulesHeatmap::FEntry MaxTransition;
+	int64 NumRecords {0};
+	EMode Mode {EMode::Visits};
+};
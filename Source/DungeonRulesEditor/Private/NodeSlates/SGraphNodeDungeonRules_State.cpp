@@ -6,6 +6,7 @@
 #include "SGraphNodeDungeonRules_State.h"
 #include "Nodes/DungeonRulesNode_Conduit.h"
 #include "Nodes/DungeonRulesNode.h"
+#include "DungeonRulesHeatmapOverlay.h"
 #include "IDocumentation.h"
 #include "SGraphPanel.h"
 #include "SGraphPin.h"
@@ -93,6 +94,12 @@ FSlateColor SGraphNodeDungeonRules_State::GetBorderBackgroundColor() const
 
 FSlateColor SGraphNodeDungeonRules_State::GetBorderBackgroundColor_Internal(FLinearColor InactiveStateColor, FLinearColor ActiveStateColorDim, FLinearColor ActiveStateColorBright) const
 {
+	if (const FDungeonRulesHeatmapOverlay* Heatmap = FDungeonRulesHeatmapOverlay::Get(GraphNode))
+	{
+		const UDungeonRulesNode* StateNode = CastChecked<UDungeonRulesNode>(GraphNode);
+		return Heatmap->GetColor(StateNode->GetNodeInstance(), InactiveStateColor);
+	}
+
 	return InactiveStateColor;
 }
 
@@ -222,6 +229,13 @@ void SGraphNodeDungeonRules_State::UpdateGraphNode()
 							[
 								NodeTitle.ToSharedRef()
 							]
+							+SVerticalBox::Slot()
+								.AutoHeight()
+							[
+								SNew(STextBlock)
+								.Text(this, &SGraphNodeDungeonRules_State::GetHeatmapText)
+								.Visibility(this, &SGraphNodeDungeonRules_State::GetHeatmapVisibility)
+							]
 						]
 					]
 				]
@@ -301,4 +315,18 @@ FText SGraphNodeDungeonRules_State::GetNodeName() const
 	return NodeTitle.IsValid() ? NodeTitle->GetHeadTitle() : FText::FromString(TEXT("NULL"));
 }
 
+FText SGraphNodeDungeonRules_State::GetHeatmapText() const
+{
+	const FDungeonRulesHeatmapOverlay* Heatmap = FDungeonRulesHeatmapOverlay::Get(GraphNode);
+	const UDungeonRulesNode* StateNode = CastChecked<UDungeonRulesNode>(GraphNode);
+	return Heatmap ? Heatmap->GetStatsText(StateNode->GetNodeInstance()) : FText::GetEmpty();
+}
+
+EVisibility SGraphNodeDungeonRules_State::GetHeatmapVisibility() const
+{
+	const FDungeonRulesHeatmapOverlay* Heatmap = FDungeonRulesHeatmapOverlay::Get(GraphNode);
+	const UDungeonRulesNode* StateNode = CastChecked<UDungeonRulesNode>(GraphNode);
+	return (Heatmap && Heatmap->Find(StateNode->GetNodeInstance())) ? EVisibility::Visible : EVisibility::Collapsed;
+}
+
 #undef LOCTEXT_NAMESPACE
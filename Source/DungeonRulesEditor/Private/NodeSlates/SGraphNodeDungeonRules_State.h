@@ -46,6 +46,10 @@ protected:
 	virtual const FSlateBrush* GetNameIcon() const;
 	virtual FText GetNodeName() const;
 
+	// Values of the heatmap shown on the graph, if any.
+	FText GetHeatmapText() const;
+	EVisibility GetHeatmapVisibility() const;
+
 private:
 	TSharedPtr<SNodeTitle> NodeTitle {nullptr};
 };
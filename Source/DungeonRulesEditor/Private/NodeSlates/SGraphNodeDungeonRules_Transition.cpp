@@ -8,6 +8,7 @@
 #include "Nodes/DungeonRulesNode.h"
 #include "Nodes/DungeonRulesNode_Transition.h"
 #include "DungeonRules.h"
+#include "DungeonRulesHeatmapOverlay.h"
 #include "ConnectionDrawingPolicy.h"
 #include "Layout/Geometry.h"
 #include "IDocumentation.h"
@@ -111,6 +112,22 @@ TSharedRef<SWidget> SGraphNodeDungeonRules_Transition::GenerateRichTooltip()
 				.Text(TooltipDesc)
 		];
 
+	if (const FDungeonRulesHeatmapOverlay* Heatmap = FDungeonRulesHeatmapOverlay::Get(TransNode))
+	{
+		const FText StatsText = Heatmap->GetStatsText(TransNode->GetNodeInstance());
+		if (!StatsText.IsEmpty())
+		{
+			Widget->AddSlot()
+				.AutoHeight()
+				.Padding(2.0f)
+				[
+					SNew(STextBlock)
+					.TextStyle(FAppStyle::Get(), TEXT("Graph.TransitionNode.TooltipRule"))
+					.Text(StatsText)
+				];
+		}
+	}
+
 	Widget->AddSlot()
 		.AutoHeight()
 		.Padding( 2.0f )
@@ -226,7 +243,13 @@ FLinearColor SGraphNodeDungeonRules_Transition::StaticGetTransitionColor(UDungeo
 	//@TODO: Make configurable by styling
 	const FLinearColor HoverColor(0.724f, 0.256f, 0.0f, 1.0f);
 	FLinearColor BaseColor(0.9f, 0.9f, 0.9f, 1.0f);
-	return bIsHovered ? HoverColor : BaseColor;
+	if (bIsHovered)
+		return HoverColor;
+
+	if (const FDungeonRulesHeatmapOverlay* Heatmap = FDungeonRulesHeatmapOverlay::Get(TransNode))
+		return Heatmap->GetColor(TransNode->GetNodeInstance(), BaseColor);
+
+	return BaseColor;
 }
 
 FSlateColor SGraphNodeDungeonRules_Transition::GetTransitionColor() const
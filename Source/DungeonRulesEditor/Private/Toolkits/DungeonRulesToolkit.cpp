@@ -9,6 +9,8 @@
 #include "DungeonRules.h"
 #include "DungeonRulesGraph.h"
 #include "DungeonRulesSchema.h"
+#include "DungeonRulesTracer.h"
+#include "DungeonGeneratorWithRules.h"
 #include "Nodes/DungeonRulesNode.h"
 #include "HAL/PlatformApplicationMisc.h"
 #include "Framework/Commands/GenericCommands.h"
@@ -16,6 +18,11 @@
 #include "GraphEditorActions.h"
 #include "EdGraphUtilities.h"
 #include "SNodePanel.h" // GetSnapGridSize
+#include "Framework/MultiBox/MultiBoxBuilder.h"
+#include "Editor.h"
+#include "EngineUtils.h"
+#include "DesktopPlatformModule.h"
+#include "IDesktopPlatform.h"
 #include "DetailCustomizations/DungeonRulesDetailsCustomization.h"
 
 #define LOCTEXT_NAMESPACE "DungeonRulesEditor"
@@ -24,6 +31,7 @@ const FName FDungeonRulesToolkit::DetailsTabId(TEXT("DungeonRulesEditorDetailsTa
 const FName FDungeonRulesToolkit::GraphTabId(TEXT("DungeonRulesEditorGraphTabId"));
 
 FDungeonRulesToolkit::FDungeonRulesToolkit()
+	: DungeonRules(nullptr)
 {
 	UEditorEngine* Editor = (UEditorEngine*)GEngine;
 	if (Editor)
@@ -34,6 +42,9 @@ FDungeonRulesToolkit::FDungeonRulesToolkit()
 
 FDungeonRulesToolkit::~FDungeonRulesToolkit()
 {
+	// The overlay is owned by the graph, so it would still be shown the next time the asset is opened.
+	ClearHeatmap();
+
 	UEditorEngine* Editor = (UEditorEngine*)GEngine;
 	if (Editor)
 	{
@@ -252,6 +263,71 @@ void FDungeonRulesToolkit::InitGraphAssetEditor(const EToolkitMode::Type InMode,
 	const bool bCreateDefaultStandaloneMenu = true;
 	const bool bCreateDefaultToolbar = true;
 	FAssetEditorToolkit::InitAssetEditor(InMode, InToolkitHost, TEXT("DungeonRulesEditorApp"), StandaloneDefaultLayout, bCreateDefaultStandaloneMenu, bCreateDefaultToolbar, ObjectToEdit, false);
+
+	ExtendToolbar();
+	RegenerateMenusAndToolbars();
+}
+
+void FDungeonRulesToolkit::ExtendToolbar()
+{
+	TSharedPtr<FExtender> ToolbarExtender = MakeShareable(new FExtender);
+	ToolbarExtender->AddToolBarExtension(
+		"Asset",
+		EExtensionHook::After,
+		GetToolkitCommands(),
+		FToolBarExtensionDelegate::CreateSP(this, &FDungeonRulesToolkit::FillHeatmapToolbar)
+	);
+	AddToolbarExtender(ToolbarExtender);
+}
+
+void FDungeonRulesToolkit::FillHeatmapToolbar(FToolBarBuilder& ToolbarBuilder)
+{
+	ToolbarBuilder.BeginSection("Heatmap");
+	{
+		ToolbarBuilder.AddToolBarButton(
+			FUIAction(
+				FExecuteAction::CreateSP(this, &FDungeonRulesToolkit::LoadHeatmapFromPlayInEditor),
+				FCanExecuteAction::CreateSP(this, &FDungeonRulesToolkit::CanLoadHeatmapFromPlayInEditor)
+			),
+			NAME_None,
+			LOCTEXT("HeatmapFromPIE", "Heatmap From PIE"),
+			LOCTEXT("HeatmapFromPIETooltip", "Colors the nodes with the rules trace of the dungeon generators using this asset in the current play session.\nThe trace must be enabled with the console variable 'DungeonRules.Trace'."),
+			FSlateIcon(STYLESET_NAME(), "PlayWorld.PlayInViewport")
+		);
+
+		ToolbarBuilder.AddToolBarButton(
+			FUIAction(FExecuteAction::CreateSP(this, &FDungeonRulesToolkit::LoadHeatmapFromTraceFiles)),
+			NAME_None,
+			LOCTEXT("HeatmapFromFiles", "Load Heatmap"),
+			LOCTEXT("HeatmapFromFilesTooltip", "Colors the nodes with the rules trace files saved by the console command 'DungeonRules.DumpTrace'.\nOnly the files recorded by this asset, since its last modification, are loaded."),
+			FSlateIcon(STYLESET_NAME(), "Icons.FolderOpen")
+		);
+
+		ToolbarBuilder.AddToolBarButton(
+			FUIAction(
+				FExecuteAction::CreateSP(this, &FDungeonRulesToolkit::ToggleHeatmapMode),
+				FCanExecuteAction(),
+				FIsActionChecked::CreateSP(this, &FDungeonRulesToolkit::IsHeatmapTimeMode)
+			),
+			NAME_None,
+			LOCTEXT("HeatmapTime", "Heatmap Time"),
+			LOCTEXT("HeatmapTimeTooltip", "Colors the nodes by the time spent evaluating their transitions instead of their number of visits."),
+			FSlateIcon(STYLESET_NAME(), "Icons.Recent"),
+			EUserInterfaceActionType::ToggleButton
+		);
+
+		ToolbarBuilder.AddToolBarButton(
+			FUIAction(
+				FExecuteAction::CreateSP(this, &FDungeonRulesToolkit::ClearHeatmap),
+				FCanExecuteAction::CreateSP(this, &FDungeonRulesToolkit::HasHeatmap)
+			),
+			NAME_None,
+			LOCTEXT("ClearHeatmap", "Clear Heatmap"),
+			LOCTEXT("ClearHeatmapTooltip", "Removes the heatmap from the nodes."),
+			FSlateIcon(STYLESET_NAME(), "Icons.Delete")
+		);
+	}
+	ToolbarBuilder.EndSection();
 }
 
 void FDungeonRulesToolkit::CreateInternalWidgets()
@@ -725,4 +801,102 @@ void FDungeonRulesToolkit::OnNodeTitleCommitted(const FText& NewText, ETextCommi
 	}
 }
 
+void FDungeonRulesToolkit::LoadHeatmapFromPlayInEditor()
+{
+	Heatmap.Reset();
+
+	int32 NumGenerators = 0;
+	if (UWorld* PlayWorld = GEditor ? GEditor->PlayWorld : nullptr)
+	{
+		for (TActorIterator<ADungeonGeneratorWithRules> It(PlayWorld); It; ++It)
+		{
+			if (It->GetDungeonRules() != DungeonRules)
+				continue;
+
+			// The heatmap of the generator is already accumulated from its traces, so its records are merged here.
+			Heatmap.Merge(It->GetRulesHeatmap());
+			++NumGenerators;
+		}
+	}
+
+	if (Heatmap.IsEmpty())
+		DungeonEd_LogWarning("No rules trace found in the %d dungeon generators using '%s'. Is the trace enabled with 'DungeonRules.Trace'?", NumGenerators, *GetNameSafe(DungeonRules));
+
+	UpdateHeatmapOverlay();
+}
+
+bool FDungeonRulesToolkit::CanLoadHeatmapFromPlayInEditor() const
+{
+	return GEditor && GEditor->PlayWorld != nullptr;
+}
+
+void FDungeonRulesToolkit::LoadHeatmapFromTraceFiles()
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (!DesktopPlatform)
+		return;
+
+	TArray<FString> FilePaths;
+	const bool bOpened = DesktopPlatform->OpenFileDialog(
+		FSlateApplication::Get().FindBestParentWindowHandleForDialogs(nullptr),
+		LOCTEXT("LoadHeatmapDialogTitle", "Load Dungeon Rules Traces").ToString(),
+		FPaths::ProjectSavedDir(),
+		TEXT(""),
+		TEXT("Dungeon Rules Trace (*.drtrace)|*.drtrace"),
+		EFileDialogFlags::Multiple,
+		FilePaths
+	);
+
+	if (!bOpened || FilePaths.Num() <= 0)
+		return;
+
+	// The files recorded by another asset, or before this one has been modified, are rejected (and logged) by LoadFromFile.
+	Heatmap.Reset();
+	for (const FString& FilePath : FilePaths)
+	{
+		TArray<FDungeonRulesTraceRecord> Records;
+		if (FDungeonRulesTracer::LoadFromFile(FilePath, DungeonRules->GetPathName(), DungeonRules->GetProgram(), Records))
+			Heatmap.Add(Records);
+	}
+
+	if (Heatmap.IsEmpty())
+		DungeonEd_LogWarning("No record loaded from the %d rules trace file(s) for '%s'.", FilePaths.Num(), *GetNameSafe(DungeonRules));
+
+	UpdateHeatmapOverlay();
+}
+
+void FDungeonRulesToolkit::ClearHeatmap()
+{
+	Heatmap.Reset();
+	UpdateHeatmapOverlay();
+}
+
+bool FDungeonRulesToolkit::HasHeatmap() const
+{
+	return !Heatmap.IsEmpty();
+}
+
+void FDungeonRulesToolkit::ToggleHeatmapMode()
+{
+	HeatmapMode = IsHeatmapTimeMode() ? FDungeonRulesHeatmapOverlay::EMode::Visits : FDungeonRulesHeatmapOverlay::EMode::Time;
+	UpdateHeatmapOverlay();
+}
+
+bool FDungeonRulesToolkit::IsHeatmapTimeMode() const
+{
+	return HeatmapMode == FDungeonRulesHeatmapOverlay::EMode::Time;
+}
+
+void FDungeonRulesToolkit::UpdateHeatmapOverlay()
+{
+	UDungeonRulesGraph* EdGraph = DungeonRules ? Cast<UDungeonRulesGraph>(DungeonRules->EdGraph) : nullptr;
+	if (!EdGraph)
+		return;
+
+	TSharedPtr<FDungeonRulesHeatmapOverlay> Overlay {nullptr};
+	if (!Heatmap.IsEmpty())
+		Overlay = MakeShared<FDungeonRulesHeatmapOverlay>(*DungeonRules, Heatmap, HeatmapMode);
+	EdGraph->SetHeatmapOverlay(Overlay);
+}
+
 #undef LOCTEXT_NAMESPACE
@@ -10,8 +10,10 @@
 #include "Misc/NotifyHook.h"
 #include "GraphEditor.h"
 #include "IDetailsView.h"
+#include "DungeonRulesHeatmapOverlay.h"
 
 class UDungeonRules;
+class FToolBarBuilder;
 
 class FDungeonRulesToolkit : public FAssetEditorToolkit, public FEditorUndoClient, public FNotifyHook
 {
@@ -68,6 +70,15 @@ public:
 	bool OnNodeVerifyTitleCommit(const FText& NewText, UEdGraphNode* NodeBeingChanged, FText& OutErrorMessage);
 	void OnNodeTitleCommitted(const FText& NewText, ETextCommit::Type CommitInfo, UEdGraphNode* NodeBeingChanged);
 
+	// Delegates for the heatmap toolbar
+	void LoadHeatmapFromPlayInEditor();
+	bool CanLoadHeatmapFromPlayInEditor() const;
+	void LoadHeatmapFromTraceFiles();
+	void ClearHeatmap();
+	bool HasHeatmap() const;
+	void ToggleHeatmapMode();
+	bool IsHeatmapTimeMode() const;
+
 protected:
 
 	/** Currently focused graph */
@@ -87,6 +98,10 @@ private:
 	TSharedPtr<SGraphEditor> EdGraphEditor;
 	TSharedPtr<IDetailsView> DetailsWidget;
 
+	// Visits and evaluation time recorded during the last generations, drawn over the graph.
+	FDungeonRulesHeatmap Heatmap;
+	FDungeonRulesHeatmapOverlay::EMode HeatmapMode {FDungeonRulesHeatmapOverlay::EMode::Visits};
+
 	TSharedRef<SDockTab> SpawnTab_Properties(const FSpawnTabArgs& Args);
 	TSharedRef<SDockTab> SpawnTab_GraphCanvas(const FSpawnTabArgs& Args);
 
@@ -95,4 +110,10 @@ private:
 
 	/** Create new graph editor widget */
 	TSharedRef<SGraphEditor> CreateGraphEditorWidget();
+
+	void ExtendToolbar();
+	void FillHeatmapToolbar(FToolBarBuilder& ToolbarBuilder);
+
+	// Shows the current heatmap on the graph, or hides it when empty.
+	void UpdateHeatmapOverlay();
 };